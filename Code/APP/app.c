@@ -31,6 +31,7 @@
 #include "buttons.h"
 #include "debug.h"
 #include "indication.h"
+#include "telemetry.h"
 
 #include "cli/cli_app.h"
 #include "display/display.h"
@@ -63,6 +64,8 @@ const osThreadAttr_t app_thread_attr =
 osThreadId_t app_thread_id;
 /** RC mode. See @ref app_rc_mode_t. */
 volatile app_rc_mode_t app_rc_mode = APP_RC_MODE_STANDBY;
+/** System timer cycles spent sleeping in idle thread, wraps around. */
+static volatile uint32_t app_idle_cycles = 0;
 
 /**********************************************************************************************************************
  * Exported variables
@@ -145,15 +148,18 @@ void app_thread(void *arguments)
     DEBUG_INIT("Sensors ..... %s.", ret == false ? "err" : "ok");
     ret = buttons_init();
     DEBUG_INIT("Buttons ..... %s.", ret == false ? "err" : "ok");
+    ret = telemetry_init();
+    DEBUG_INIT("Telemetry ... %s.", ret == false ? "err" : "ok");
 
     DEBUG(" * Running.");
     app_rc_mode_set(APP_RC_MODE_STANDBY);
     osDelay(500);
     display_set_menu(DISPLAY_MENU_ID_MAIN);
 
+    // Button event handlers run here, buttons thread only samples.
     while(1)
     {
-        osDelay(100);
+        buttons_dispatch(100);
         wdt_feed();
     }
 }
@@ -188,6 +194,7 @@ void app_rc_mode_set(app_rc_mode_t mode)
     __disable_irq();
     app_rc_mode = mode;
     __enable_irq();
+    display_refresh();
 
     return;
 }
@@ -203,6 +210,31 @@ void app_error(void)
     }
 }
 
+uint32_t app_get_idle_cycles(void)
+{
+    return app_idle_cycles;
+}
+
+/**
+ * @brief   RTX idle thread. Sleeps until interrupt and counts sleeping time for CPU load.
+ *
+ * @param   argument    Not used.
+ */
+void osRtxIdleThread(void *argument)
+{
+    uint32_t start = 0;
+
+    while(1)
+    {
+        // Interrupts are masked so wakeup time is read before any handler or thread runs, WFI still wakes up.
+        __disable_irq();
+        start = osKernelGetSysTimerCount();
+        __WFI();
+        app_idle_cycles += osKernelGetSysTimerCount() - start;
+        __enable_irq();
+    }
+}
+
 /**********************************************************************************************************************
  * Private functions
  *********************************************************************************************************************/
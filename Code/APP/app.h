@@ -27,6 +27,7 @@ extern "C" {
 /**********************************************************************************************************************
  * Includes
  *********************************************************************************************************************/
+#include <stdint.h>
 
 /**********************************************************************************************************************
  * Exported definitions and macros
@@ -81,6 +82,13 @@ void app_rc_mode_set(app_rc_mode_t mode);
  */
 void app_error(void);
 
+/**
+ * @brief   Get system timer cycles spent sleeping in idle thread since start. Count wraps around, use difference.
+ *
+ * @return  Idle cycles.
+ */
+uint32_t app_get_idle_cycles(void);
+
 #ifdef __cplusplus
 }
 #endif
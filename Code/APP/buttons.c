@@ -26,9 +26,12 @@
 #include "buttons.h"
 
 #include "app.h"
+#include "debug.h"
+#include "debounce.h"
 #include "indication.h"
 
 #include "periph/gpio.h"
+#include "cli/cli.h"
 #include "display/display.h"
 
 #include "cmsis_os2.h"
@@ -38,6 +41,12 @@
  *********************************************************************************************************************/
 #define BUTTONS_PRESS_DURATION          50  //!< Button press duration in milliseconds.
 #define BUTTONS_LONG_PRESS_DURATION     500 //!< Button long press duration in milliseconds.
+#define BUTTONS_DOUBLE_CLICK_DURATION   300 //!< Maximal time between clicks of double click in milliseconds.
+#define BUTTONS_REPEAT_PERIOD           100 //!< Repeat event period after long press in milliseconds.
+#define BUTTONS_EVENT_QUEUE_SIZE        8   //!< Button events queue size.
+#define BUTTONS_SAMPLE_PERIOD           5   //!< Ports sampling period while inputs are debounced in milliseconds.
+
+#define BUTTONS_FLAG_EDGE               0x00000001  //!< Button GPIO edge interrupt flag.
 
 /**********************************************************************************************************************
  * Private typedef
@@ -52,24 +61,32 @@ typedef enum
     BUTTONS_STATE_PRESSED_LONG, //!< Buttons is pressed by long time defined at @ref BUTTONS_PRESS_DURATION.
 } buttons_state_t;
 
-/**
- * @brief   Buttons callback function prototype
- *
- * @note    This callback function will be called when button state changes.
- */
-typedef void (*buttons_callback_t)(buttons_id_t id);
-
 /**
  * @brief   Buttons data structure.
  */
 typedef struct
 {
     gpio_id_t           gpio;       /**< Button GPIO ID. See @ref gpio_id_t. */
+    uint8_t             port;       /**< Button GPIO port. */
+    uint8_t             pin;        /**< Button GPIO pin. */
     buttons_state_t     state;      /**< Current button state. See @ref buttons_state_t. */
-    uint32_t            counter;    /**< Button counter. */
-    buttons_callback_t  callback;   /**< Button function callback. See @ref buttons_callback_t.*/
+    bool                pressed;    /**< Button GPIO is active, press is timed. */
+    bool                chord;      /**< Button is part of chord. */
+    uint8_t             clicks;     /**< Clicks counted for double click. */
+    uint8_t             repeats;    /**< Repeat events sent after long press. */
+    uint32_t            tick;       /**< Kernel tick of press start. */
+    uint32_t            click_tick; /**< Kernel tick of last click. */
 } buttons_data_t;
 
+/**
+ * @brief   Button events subscriber.
+ */
+typedef struct
+{
+    uint8_t             buttons;    /**< Buttons mask. */
+    uint8_t             events;     /**< Event types mask. */
+    buttons_event_cb_t  cb;         /**< Event callback. */
+} buttons_subscriber_t;
 
 /**********************************************************************************************************************
  * Private constants
@@ -87,13 +104,27 @@ const osThreadAttr_t buttons_thread_attr =
  *********************************************************************************************************************/
 /** Buttons thread ID. */
 osThreadId_t buttons_thread_id;
+/** Button events queue ID. */
+osMessageQueueId_t buttons_queue_id;
 /** Buttons data. See @ref buttons_data_t. */
 buttons_data_t buttons_data[BUTTONS_ID_LAST] =
 {
-    {.gpio = GPIO_ID_JOYSTICK_LEFT_SW, .state = BUTTONS_STATE_RELEASED, .counter = 0, .callback = NULL}, // BUTTONS_ID_JOYSTICK_1_SW
-    {.gpio = GPIO_ID_BUTTON_LEFT,      .state = BUTTONS_STATE_RELEASED, .counter = 0, .callback = NULL}, // BUTTONS_ID_VIEW_RIGHT
-    {.gpio = GPIO_ID_BUTTON_RIGHT,     .state = BUTTONS_STATE_RELEASED, .counter = 0, .callback = NULL}, // BUTTONS_ID_VIEW_LEFT
+    {.gpio = GPIO_ID_JOYSTICK_LEFT_SW, .state = BUTTONS_STATE_RELEASED}, // BUTTONS_ID_JOYSTICK_1_SW
+    {.gpio = GPIO_ID_BUTTON_LEFT,      .state = BUTTONS_STATE_RELEASED}, // BUTTONS_ID_VIEW_RIGHT
+    {.gpio = GPIO_ID_BUTTON_RIGHT,     .state = BUTTONS_STATE_RELEASED}, // BUTTONS_ID_VIEW_LEFT
 };
+/** Debounce state of each GPIO port, bit per pin, 1 - button is active. */
+static debounce_t buttons_debounce[GPIO_PORTS] = {{0}};
+/** Button pins of each GPIO port. */
+static uint32_t buttons_port_mask[GPIO_PORTS] = {0};
+/** Buttons mask of last chord. */
+static uint8_t buttons_chord_mask = 0;
+/** Event subscribers. See @ref buttons_subscriber_t. */
+static buttons_subscriber_t buttons_subscribers[BUTTONS_SUBSCRIBERS_MAX] = {{0}};
+/** Events queued of each type. See @ref buttons_event_type_t. */
+static uint32_t buttons_event_count[BUTTONS_EVENT_LAST] = {0};
+/** Events dropped because queue was full. */
+static uint32_t buttons_event_dropped = 0;
 
 /**********************************************************************************************************************
  * Exported variables
@@ -103,34 +134,88 @@ buttons_data_t buttons_data[BUTTONS_ID_LAST] =
  * Prototypes of local functions
  *********************************************************************************************************************/
 /**
- * @brief   Start, stop (@ref BUTTONS_ID_JOYSTICK_1_SW) button callback function.
+ * @brief   Buttons GPIO edge interrupt handler. Wakes up buttons thread.
+ *
+ * @param   id  GPIO ID. See @ref gpio_id_t.
+ */
+static void buttons_gpio_handler(gpio_id_t id);
+
+/**
+ * @brief   Put button event to events queue. Event is dropped if queue is full.
  *
- * @param   id  Button ID. See @ref buttons_id_t.
+ * @param   id      Button ID. See @ref buttons_id_t.
+ * @param   type    Event type. See @ref buttons_event_type_t.
+ * @param   mask    Pressed buttons mask.
+ * @param   tick    Kernel tick of event.
  */
-static void buttons_cb_joystick_left_sw(buttons_id_t id);
+static void buttons_event_put(buttons_id_t id, buttons_event_type_t type, uint8_t mask, uint32_t tick);
 
 /**
- * @brief   Calibrate (@ref BUTTONS_ID_CALIBRATE) button callback function.
+ * @brief   Update button state machine.
  *
- * @param   id  Button ID. See @ref buttons_id_t.
+ * @param   b       Button ID. See @ref buttons_id_t.
+ * @param   tick    Current kernel tick.
+ * @param   mask    Pressed buttons mask.
+ * @param   active  Debounced button input state.
+ *
+ * @return  Ticks till next timed event of this button, osWaitForever if none.
  */
-static void buttons_cb_view_right(buttons_id_t id);
+static uint32_t buttons_update(buttons_id_t b, uint32_t tick, uint8_t mask, bool active);
 
 /**
- * @brief   View (@ref BUTTONS_ID_VIEW) button callback function.
+ * @brief   Start, stop (@ref BUTTONS_ID_JOYSTICK_1_SW) button event handler.
  *
- * @param   id  Button ID. See @ref buttons_id_t.
+ * @param   event   Button event.
  */
-static void buttons_cb_view_left(buttons_id_t id);
+static void buttons_cb_joystick_left_sw(const buttons_event_t *event);
+
+/**
+ * @brief   View right (@ref BUTTONS_ID_VIEW_RIGHT) button event handler.
+ *
+ * @param   event   Button event.
+ */
+static void buttons_cb_view_right(const buttons_event_t *event);
+
+/**
+ * @brief   View left (@ref BUTTONS_ID_VIEW_LEFT) button event handler.
+ *
+ * @param   event   Button event.
+ */
+static void buttons_cb_view_left(const buttons_event_t *event);
+
+/**
+ * @brief   CLI command, shows buttons state, event counters and subscribers.
+ *
+ * @param   data    Reply buffer.
+ * @param   size    Reply buffer size.
+ * @param   cmd     Command line.
+ *
+ * @return  true if reply buffer is filled.
+ */
+static bool buttons_cmd_cb(uint8_t *data, uint32_t size, const uint8_t *cmd);
 
 /**********************************************************************************************************************
  * Exported functions
  *********************************************************************************************************************/
 bool buttons_init(void)
 {
-    buttons_data[BUTTONS_ID_JOYSTICK_1_SW].callback = &buttons_cb_joystick_left_sw;
-    buttons_data[BUTTONS_ID_VIEW_RIGHT].callback = &buttons_cb_view_right;
-    buttons_data[BUTTONS_ID_VIEW_LEFT].callback = &buttons_cb_view_left;
+    buttons_id_t b = (buttons_id_t)0;
+
+    buttons_subscribe(BUTTONS_MASK(BUTTONS_ID_JOYSTICK_1_SW),
+                      BUTTONS_EVENT_MASK(BUTTONS_EVENT_CLICK) | BUTTONS_EVENT_MASK(BUTTONS_EVENT_LONG),
+                      &buttons_cb_joystick_left_sw);
+    buttons_subscribe(BUTTONS_MASK(BUTTONS_ID_VIEW_RIGHT),
+                      BUTTONS_EVENT_MASK(BUTTONS_EVENT_CLICK) | BUTTONS_EVENT_MASK(BUTTONS_EVENT_LONG),
+                      &buttons_cb_view_right);
+    buttons_subscribe(BUTTONS_MASK(BUTTONS_ID_VIEW_LEFT),
+                      BUTTONS_EVENT_MASK(BUTTONS_EVENT_CLICK) | BUTTONS_EVENT_MASK(BUTTONS_EVENT_LONG),
+                      &buttons_cb_view_left);
+
+    // Create events queue.
+    if((buttons_queue_id = osMessageQueueNew(BUTTONS_EVENT_QUEUE_SIZE, sizeof(buttons_event_t), NULL)) == NULL)
+    {
+        return false;
+    }
 
     // Create application thread.
     if((buttons_thread_id = osThreadNew(buttons_thread, NULL, &buttons_thread_attr)) == NULL)
@@ -138,46 +223,161 @@ bool buttons_init(void)
         return false;
     }
 
+    // Thread sleeps until any button GPIO edge.
+    for(b = (buttons_id_t)0; b < BUTTONS_ID_LAST; b++)
+    {
+        if(gpio_get_pin(buttons_data[b].gpio, &buttons_data[b].port, &buttons_data[b].pin) != true ||
+           buttons_data[b].port >= GPIO_PORTS)
+        {
+            return false;
+        }
+        buttons_port_mask[buttons_data[b].port] |= (1UL << buttons_data[b].pin);
+        if(gpio_irq_enable(buttons_data[b].gpio, &buttons_gpio_handler) != true)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool buttons_subscribe(uint8_t buttons, uint8_t events, buttons_event_cb_t cb)
+{
+    uint8_t i = 0;
+
+    if(cb == NULL)
+    {
+        return false;
+    }
+
+    for(i = 0; i < BUTTONS_SUBSCRIBERS_MAX; i++)
+    {
+        if(buttons_subscribers[i].cb == NULL)
+        {
+            buttons_subscribers[i].buttons = buttons;
+            buttons_subscribers[i].events = events;
+            buttons_subscribers[i].cb = cb;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool buttons_dispatch(uint32_t timeout)
+{
+    buttons_event_t event;
+    uint8_t i = 0;
+
+    if(buttons_queue_id == NULL)
+    {
+        osDelay(timeout);
+        return false;
+    }
+    if(osMessageQueueGet(buttons_queue_id, &event, NULL, timeout) != osOK)
+    {
+        return false;
+    }
+
+    for(i = 0; i < BUTTONS_SUBSCRIBERS_MAX; i++)
+    {
+        if(buttons_subscribers[i].cb != NULL &&
+           (buttons_subscribers[i].buttons & BUTTONS_MASK(event.id)) &&
+           (buttons_subscribers[i].events & BUTTONS_EVENT_MASK(event.type)))
+        {
+            buttons_subscribers[i].cb(&event);
+        }
+    }
+
     return true;
 }
 
 void buttons_thread(void *arguments)
 {
     buttons_id_t b = (buttons_id_t)0;
+    buttons_id_t chord = (buttons_id_t)0;
+    uint32_t timeout = 0;
+    uint32_t next = 0;
+    uint32_t tick = 0;
+    uint8_t mask = 0;
+    uint8_t port = 0;
+    bool sampling = false;
 
     while(1)
     {
+        if(sampling == true)
+        {
+            // Edges do not shorten sampling period, debounce time stays the same for bouncing input.
+            osDelay(BUTTONS_SAMPLE_PERIOD);
+            osThreadFlagsClear(BUTTONS_FLAG_EDGE);
+        }
+        else
+        {
+            // Idle thread waits only for edge, timeout is set while any timed event is pending.
+            osThreadFlagsWait(BUTTONS_FLAG_EDGE, osFlagsWaitAny, timeout);
+        }
+        tick = osKernelGetTickCount();
+        timeout = osWaitForever;
+
+        // Single read debounces all buttons of port. Inputs are active low.
+        sampling = false;
+        for(port = 0; port < GPIO_PORTS; port++)
+        {
+            if(buttons_port_mask[port] == 0)
+            {
+                continue;
+            }
+            debounce_update(&buttons_debounce[port], ~gpio_port_get(port) & buttons_port_mask[port]);
+            if(debounce_busy(&buttons_debounce[port]) == true)
+            {
+                sampling = true;
+            }
+        }
+
+        mask = 0;
         for(b = (buttons_id_t)0; b < BUTTONS_ID_LAST; b++)
         {
-            if(gpio_input_get(buttons_data[b].gpio) != true)
+            if(buttons_data[b].state != BUTTONS_STATE_RELEASED)
             {
-                buttons_data[b].counter++;
-                if(buttons_data[b].counter > BUTTONS_LONG_PRESS_DURATION && buttons_data[b].state != BUTTONS_STATE_PRESSED_LONG)
-                {
-                    //DEBUG("Button-%d long pressed.", b);
-                    buttons_data[b].state = BUTTONS_STATE_PRESSED_LONG;
-                    if(buttons_data[b].callback)
-                    {
-                        buttons_data[b].callback(b);
-                    }
-                }
+                mask |= BUTTONS_MASK(b);
+            }
+        }
+
+        for(b = (buttons_id_t)0; b < BUTTONS_ID_LAST; b++)
+        {
+            next = buttons_update(b, tick, mask,
+                                  (buttons_debounce[buttons_data[b].port].state & (1UL << buttons_data[b].pin)) != 0);
+            if(next < timeout)
+            {
+                timeout = next;
+            }
+            if(buttons_data[b].state != BUTTONS_STATE_RELEASED)
+            {
+                mask |= BUTTONS_MASK(b);
             }
             else
             {
-                if(buttons_data[b].counter >= BUTTONS_PRESS_DURATION && buttons_data[b].counter < BUTTONS_LONG_PRESS_DURATION)
+                mask &= ~BUTTONS_MASK(b);
+            }
+        }
+
+        // Chord is reported once when another button joins pressed ones.
+        if((mask & (mask - 1)) != 0 && (mask & ~buttons_chord_mask) != 0)
+        {
+            for(b = (buttons_id_t)0; b < BUTTONS_ID_LAST; b++)
+            {
+                if(mask & BUTTONS_MASK(b))
                 {
-                    buttons_data[b].state = BUTTONS_STATE_PRESSED;
-                    //DEBUG("Button-%d pressed.", b);
-                    if(buttons_data[b].callback)
+                    buttons_data[b].chord = true;
+                    if((buttons_chord_mask & BUTTONS_MASK(b)) == 0)
                     {
-                        buttons_data[b].callback(b);
+                        chord = b;
                     }
                 }
-                buttons_data[b].state = BUTTONS_STATE_RELEASED;
-                buttons_data[b].counter = 0;
             }
+            buttons_event_put(chord, BUTTONS_EVENT_CHORD, mask, tick);
         }
-        osDelay(1);
+        buttons_chord_mask = mask;
     }
 
 }
@@ -185,99 +385,213 @@ void buttons_thread(void *arguments)
 /**********************************************************************************************************************
  * Private functions
  *********************************************************************************************************************/
-static void buttons_cb_joystick_left_sw(buttons_id_t id)
+static void buttons_gpio_handler(gpio_id_t id)
 {
-    buttons_data_t *button = &buttons_data[id];
+    osThreadFlagsSet(buttons_thread_id, BUTTONS_FLAG_EDGE);
 
-    if(display_power_state() == false)
+    return;
+}
+
+static void buttons_event_put(buttons_id_t id, buttons_event_type_t type, uint8_t mask, uint32_t tick)
+{
+    buttons_event_t event;
+
+    event.tick = tick;
+    event.id = id;
+    event.type = type;
+    event.mask = mask;
+    event.count = buttons_data[id].repeats;
+    if(osMessageQueuePut(buttons_queue_id, &event, 0, 0) == osOK)
     {
-        return;
+        buttons_event_count[type]++;
+    }
+    else
+    {
+        buttons_event_dropped++;
     }
 
-    switch(button->state)
+    return;
+}
+
+static uint32_t buttons_update(buttons_id_t b, uint32_t tick, uint8_t mask, bool active)
+{
+    buttons_data_t *button = &buttons_data[b];
+    uint32_t held = 0;
+
+    if(active == true)
     {
-        default:
-        case BUTTONS_STATE_RELEASED:
+        if(button->pressed != true)
         {
-            break;
+            button->pressed = true;
+            button->tick = tick;
         }
-        case BUTTONS_STATE_PRESSED:
-        case BUTTONS_STATE_PRESSED_LONG:
+    }
+    else if(button->pressed != true)
+    {
+        return osWaitForever;
+    }
+    held = tick - button->tick;
+
+    // Debounced press. Released buttons are checked too, timeout may be late.
+    if(button->state == BUTTONS_STATE_RELEASED && held >= BUTTONS_PRESS_DURATION)
+    {
+        button->state = BUTTONS_STATE_PRESSED;
+        button->repeats = 0;
+        buttons_event_put(b, BUTTONS_EVENT_PRESS, mask | BUTTONS_MASK(b), tick);
+    }
+
+    if(active != true)
+    {
+        // Presses shorter than press duration are dropped here.
+        if(button->state != BUTTONS_STATE_RELEASED)
         {
-            switch(app_rc_mode_get())
+            buttons_event_put(b, BUTTONS_EVENT_RELEASE, mask & ~BUTTONS_MASK(b), tick);
+        }
+        if(button->state == BUTTONS_STATE_PRESSED && button->chord != true)
+        {
+            buttons_event_put(b, BUTTONS_EVENT_CLICK, mask & ~BUTTONS_MASK(b), tick);
+            if(button->clicks != 0 && tick - button->click_tick < BUTTONS_DOUBLE_CLICK_DURATION)
             {
-            case APP_RC_MODE_STANDBY:
-                app_rc_mode_set(APP_RC_MODE_IDLE);
-                break;
-            case APP_RC_MODE_IDLE:
-                app_rc_mode_set(APP_RC_MODE_STANDBY);
-                break;
+                button->clicks = 0;
+                buttons_event_put(b, BUTTONS_EVENT_DOUBLE, mask & ~BUTTONS_MASK(b), tick);
+            }
+            else
+            {
+                button->clicks = 1;
+                button->click_tick = tick;
             }
-            break;
         }
+        button->state = BUTTONS_STATE_RELEASED;
+        button->pressed = false;
+        button->chord = false;
+        return osWaitForever;
     }
 
-    return;
-}
-
-static void buttons_cb_view_right(buttons_id_t id)
-{
-    buttons_data_t *button = &buttons_data[id];
-    display_menu_id_t menu = display_get_menu();
-
     switch(button->state)
     {
         default:
         case BUTTONS_STATE_RELEASED:
-        {
-            break;
-        }
+            return BUTTONS_PRESS_DURATION - held;
         case BUTTONS_STATE_PRESSED:
+            if(held <= BUTTONS_LONG_PRESS_DURATION)
+            {
+                return BUTTONS_LONG_PRESS_DURATION + 1 - held;
+            }
+            button->state = BUTTONS_STATE_PRESSED_LONG;
+            if(button->chord != true)
+            {
+                buttons_event_put(b, BUTTONS_EVENT_LONG, mask, tick);
+            }
+            break;
         case BUTTONS_STATE_PRESSED_LONG:
-        {
-            if(display_power_state() == true)
+            if(button->chord == true ||
+               held < BUTTONS_LONG_PRESS_DURATION + 1 + (uint32_t)(button->repeats + 1) * BUTTONS_REPEAT_PERIOD)
             {
-                menu++;
+                break;
             }
-            if(menu >= DISPLAY_MENU_ID_LAST)
+            if(button->repeats < UINT8_MAX)
             {
-                menu = (display_menu_id_t)1;
+                button->repeats++;
             }
-            display_set_menu(menu);
+            buttons_event_put(b, BUTTONS_EVENT_REPEAT, mask, tick);
+            break;
+    }
+
+    if(button->chord == true || button->repeats == UINT8_MAX)
+    {
+        return osWaitForever;
+    }
+
+    return BUTTONS_LONG_PRESS_DURATION + 1 + (uint32_t)(button->repeats + 1) * BUTTONS_REPEAT_PERIOD - held;
+}
+
+static void buttons_cb_joystick_left_sw(const buttons_event_t *event)
+{
+    if(display_power_state() == false)
+    {
+        return;
+    }
+
+    switch(app_rc_mode_get())
+    {
+        case APP_RC_MODE_STANDBY:
+            app_rc_mode_set(APP_RC_MODE_IDLE);
+            break;
+        case APP_RC_MODE_IDLE:
+            app_rc_mode_set(APP_RC_MODE_STANDBY);
             break;
-        }
     }
 
     return;
 }
 
-static void buttons_cb_view_left(buttons_id_t id)
+static void buttons_cb_view_right(const buttons_event_t *event)
 {
-    buttons_data_t *button = &buttons_data[id];
     display_menu_id_t menu = display_get_menu();
 
-    switch(button->state)
+    if(display_power_state() == true)
     {
-        default:
-        case BUTTONS_STATE_RELEASED:
-        {
-            break;
-        }
-        case BUTTONS_STATE_PRESSED:
-        case BUTTONS_STATE_PRESSED_LONG:
+        menu++;
+    }
+    if(menu >= DISPLAY_MENU_ID_LAST)
+    {
+        menu = (display_menu_id_t)1;
+    }
+    display_set_menu(menu);
+
+    return;
+}
+
+static void buttons_cb_view_left(const buttons_event_t *event)
+{
+    display_menu_id_t menu = display_get_menu();
+
+    if(display_power_state() == true)
+    {
+        menu--;
+    }
+    if(menu == (display_menu_id_t)0)
+    {
+        menu = (display_menu_id_t)(DISPLAY_MENU_ID_LAST - 1);
+    }
+    display_set_menu(menu);
+
+    return;
+}
+
+static bool buttons_cmd_cb(uint8_t *data, uint32_t size, const uint8_t *cmd)
+{
+    static const char * const states[] = {"released", "pressed", "long"};
+    static const char * const events[BUTTONS_EVENT_LAST] = {"press", "release", "click", "double", "long", "repeat",
+                                                            "chord"};
+    buttons_data_t *button = NULL;
+    buttons_subscriber_t *subscriber = NULL;
+    uint8_t i = 0;
+
+    DEBUG_CLI("# Buttons (state, pressed, chord, clicks, repeats):");
+    for(i = 0; i < BUTTONS_ID_LAST; i++)
+    {
+        button = &buttons_data[i];
+        DEBUG_CLI("%d: %s, %d, %d, %d, %d", i, states[button->state], button->pressed, button->chord, button->clicks,
+                  button->repeats);
+    }
+    DEBUG_CLI("# Events (queued %d, dropped %d):",
+              buttons_queue_id != NULL ? osMessageQueueGetCount(buttons_queue_id) : 0, buttons_event_dropped);
+    for(i = 0; i < BUTTONS_EVENT_LAST; i++)
+    {
+        DEBUG_CLI("%-8s %d", events[i], buttons_event_count[i]);
+    }
+    DEBUG_CLI("# Subscribers (buttons, events, callback):");
+    for(i = 0; i < BUTTONS_SUBSCRIBERS_MAX; i++)
+    {
+        subscriber = &buttons_subscribers[i];
+        if(subscriber->cb != NULL)
         {
-            if(display_power_state() == true)
-            {
-                menu--;
-            }
-            if(menu == (display_menu_id_t)0)
-            {
-                menu = (display_menu_id_t)(DISPLAY_MENU_ID_LAST - 1);
-            }
-            display_set_menu(menu);
-            break;
+            DEBUG_CLI("%d: 0x%02x, 0x%02x, 0x%08x", i, subscriber->buttons, subscriber->events,
+                      (uint32_t)(uintptr_t)subscriber->cb);
         }
     }
 
-    return;
+    return false;
 }
+CLI_CMD_REGISTER(buttons, "buttons   Button states, event counters and subscribers.", buttons_cmd_cb, 0);
@@ -27,6 +27,7 @@ extern "C" {
 /**********************************************************************************************************************
  * Includes
  *********************************************************************************************************************/
+#include <stdint.h>
 #include <stdbool.h>
 
 /**********************************************************************************************************************
@@ -36,6 +37,9 @@ extern "C" {
 /**********************************************************************************************************************
  * Exported definitions and macros
  *********************************************************************************************************************/
+#define BUTTONS_MASK(id)        (1 << (id))     //!< Button bit of buttons mask.
+#define BUTTONS_EVENT_MASK(t)   (1 << (t))      //!< Event type bit of events mask.
+#define BUTTONS_SUBSCRIBERS_MAX 4               //!< Maximal number of event subscribers.
 
 /**********************************************************************************************************************
  * Exported types
@@ -51,6 +55,40 @@ typedef enum
     BUTTONS_ID_LAST,            //!< Last should stay last.
 } buttons_id_t;
 
+/**
+ * @brief   Button event types.
+ */
+typedef enum
+{
+    BUTTONS_EVENT_PRESS,    //!< Button is pressed longer than debounce time.
+    BUTTONS_EVENT_RELEASE,  //!< Pressed button is released.
+    BUTTONS_EVENT_CLICK,    //!< Button is released before long press time.
+    BUTTONS_EVENT_DOUBLE,   //!< Second click within double click time. Follows click event.
+    BUTTONS_EVENT_LONG,     //!< Button is held longer than long press time.
+    BUTTONS_EVENT_REPEAT,   //!< Button is still held after long press, sent periodically.
+    BUTTONS_EVENT_CHORD,    //!< Two or more buttons are pressed together. No click and long events follow.
+    BUTTONS_EVENT_LAST,     //!< Last should stay last.
+} buttons_event_type_t;
+
+/**
+ * @brief   Button event.
+ */
+typedef struct
+{
+    uint32_t tick;      //!< Kernel tick of event.
+    uint8_t id;         //!< Button ID, see @ref buttons_id_t. Chord - last pressed button.
+    uint8_t type;       //!< Event type, see @ref buttons_event_type_t.
+    uint8_t mask;       //!< Pressed buttons, see @ref BUTTONS_MASK.
+    uint8_t count;      //!< Repeat event number.
+} buttons_event_t;
+
+/**
+ * @brief   Button event subscriber callback. Called from @ref buttons_dispatch.
+ *
+ * @param   event   Button event.
+ */
+typedef void (*buttons_event_cb_t)(const buttons_event_t *event);
+
 /**********************************************************************************************************************
  * Prototypes of exported variables
  *********************************************************************************************************************/
@@ -67,6 +105,26 @@ typedef enum
  */
 bool buttons_init(void);
 
+/**
+ * @brief   Subscribe to button events.
+ *
+ * @param   buttons Buttons mask, see @ref BUTTONS_MASK.
+ * @param   events  Event types mask, see @ref BUTTONS_EVENT_MASK.
+ * @param   cb      Event callback.
+ *
+ * @return  false if subscribers table is full.
+ */
+bool buttons_subscribe(uint8_t buttons, uint8_t events, buttons_event_cb_t cb);
+
+/**
+ * @brief   Wait for button event and pass it to subscribers. Called from application thread.
+ *
+ * @param   timeout Wait timeout in kernel ticks.
+ *
+ * @return  true if event was dispatched.
+ */
+bool buttons_dispatch(uint32_t timeout);
+
 /**
  * @brief   Buttons thread.
  *
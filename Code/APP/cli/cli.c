@@ -21,6 +21,7 @@
  * Includes
  *********************************************************************************************************************/
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 
@@ -37,6 +38,11 @@
 /**********************************************************************************************************************
  * Private definitions and macros
  *********************************************************************************************************************/
+#define CLI_HASH_EMPTY          0xFF    //!< Free lookup table slot.
+
+/** Registered commands, bounds of "cli_cmd" section are defined by linker. */
+#define CLI_CMD_FIRST           ((const cli_cmd_t *)cli_cmd$$Base)
+#define CLI_CMD_COUNT           ((uint32_t)((const cli_cmd_t *)cli_cmd$$Limit - CLI_CMD_FIRST))
 
 /**********************************************************************************************************************
  * Private typedef
@@ -45,11 +51,16 @@
 /**********************************************************************************************************************
  * Private variables
  *********************************************************************************************************************/
+/** Command lookup table, open addressing with linear probing. Slot holds command index or @ref CLI_HASH_EMPTY. */
+static uint8_t cli_hash_table[CLI_HASH_SIZE] = {0};
+/** Count of commands in lookup table. */
+static uint8_t cli_cmd_count = 0;
 
 /**********************************************************************************************************************
  * Exported variables
  *********************************************************************************************************************/
-extern const cli_cmd_t cli_cmd_list[CLI_CMD_COUNT];
+extern const cli_cmd_t cli_cmd$$Base[];
+extern const cli_cmd_t cli_cmd$$Limit[];
 
 /**********************************************************************************************************************
  * Prototypes of local functions
@@ -64,76 +75,85 @@ extern const cli_cmd_t cli_cmd_list[CLI_CMD_COUNT];
  */
 static int8_t cli_get_prm_count(const uint8_t *cmd);
 
+/**
+ * @brief   Hash command name.
+ *
+ * @param   name    Command name, ends with space or zero.
+ * @param   size    Returned name length in bytes.
+ *
+ * @return  Lookup table slot of name.
+ */
+static uint8_t cli_hash(const uint8_t *name, uint8_t *size);
+
+/**
+ * @brief   Find command in lookup table.
+ *
+ * @param   input   Input command string.
+ *
+ * @return  Command, NULL if command is not registered.
+ */
+static const cli_cmd_t *cli_find_cmd(const uint8_t *input);
+
 /**********************************************************************************************************************
  * Exported functions
  *********************************************************************************************************************/
 void cli_init(void)
 {
-    // Place to do some CLI initialization if necessary.
+    const cli_cmd_t *cmd = NULL;
+    uint32_t i = 0;
+    uint8_t slot = 0;
+    uint8_t size = 0;
+
+    memset(cli_hash_table, CLI_HASH_EMPTY, sizeof(cli_hash_table));
+    cli_cmd_count = 0;
+
+    // Commands are collected by linker in object order, index them once so lookup doesn't depend on their count.
+    for(i = 0; i < CLI_CMD_COUNT && i < CLI_HASH_SIZE / 2; i++)
+    {
+        cmd = &CLI_CMD_FIRST[i];
+        if(cli_find_cmd(cmd->cmd) != NULL)
+        {
+            // Duplicated name, first one wins.
+            continue;
+        }
+        slot = cli_hash(cmd->cmd, &size);
+        while(cli_hash_table[slot] != CLI_HASH_EMPTY)
+        {
+            slot = (slot + 1) & (CLI_HASH_SIZE - 1);
+        }
+        cli_hash_table[slot] = (uint8_t)i;
+        cli_cmd_count = (uint8_t)(i + 1);
+    }
 
     return;
 }
 
 bool cli_process_cmd(const uint8_t * const input, uint8_t *buffer, size_t size)
 {
-    uint8_t i = 0;
-    uint8_t res = 0;
+    const cli_cmd_t *cmd = NULL;
     bool ret = true;
-    const uint8_t *reg_cmd_str = NULL;
-    size_t reg_cmd_str_len = 0;
 
     /* Search for the command string in the list of registered commands. */
-    for(i = 0; i < CLI_CMD_COUNT; i++)
-    {
-        reg_cmd_str = cli_cmd_list[i].cmd;
-        reg_cmd_str_len = strlen((char *)reg_cmd_str);
+    cmd = cli_find_cmd(input);
 
-        /* To ensure the string lengths match exactly, so as not to pick up
-         a sub-string of a longer command, check the byte after the expected
-         end of the string is either the end of the string or a space before
-         a parameter. */
-        if((input[reg_cmd_str_len] == ' ') || (input[reg_cmd_str_len] == 0x00))
-        {
-            if(memcmp(input, reg_cmd_str, reg_cmd_str_len) == 0)
-            {
-                res = 1;
-                /* The command has been found.  Check it has the expected
-                 number of parameters.  If cExpectedNumberOfParameters is -1,
-                 then there could be a variable number of parameters and no
-                 check is made. */
-                if(cli_cmd_list[i].prm_count >= 0)
-                {
-                    if(cli_get_prm_count(input) != cli_cmd_list[i].prm_count)
-                    {
-                        res = 2;
-                    }
-                }
-                break;
-            }
-        }
+    if(cmd == NULL)
+    {
+        /* The command was not found. */
+        memcpy(buffer, CLI_MSG_CMD_UNKNOWN " " CLI_MSG_ENTER_HELP, size);
+        ret = true;
     }
-
-
-    if(res == 2)
+    else if(cmd->prm_count >= 0 && cli_get_prm_count(input) != cmd->prm_count)
     {
         /* The command was found, but the number of parameters with the command
-         was incorrect. */
+         was incorrect. If prm_count is -1, then there could be a variable number
+         of parameters and no check is made. */
         memcpy(buffer, CLI_MSG_CMD_INCORRECT " " CLI_MSG_ENTER_HELP, size);
         ret = true;
     }
-    else if(res == 1)
+    else if(cmd->callback != NULL)
     {
         /* Call the callback function that is registered to this command. */
-        if(cli_cmd_list[i].callback != NULL)
-        {
-            ret = cli_cmd_list[i].callback(buffer, size, input);
-        }
-    }
-    else
-    {
-        /* The command was not found. */
-        memcpy(buffer, CLI_MSG_CMD_UNKNOWN " " CLI_MSG_ENTER_HELP, size);
-        ret = true;
+        ret = cmd->callback(buffer, size, input);
     }
 
     return ret;
@@ -194,6 +214,60 @@ const uint8_t *cli_get_parameter(const uint8_t *cmd, uint8_t prm_index, uint8_t
     return ret;
 }
 
+bool cli_get_int(const uint8_t *cmd, uint8_t prm_index, int32_t *value)
+{
+    const uint8_t *prm = NULL;
+    char *end = NULL;
+    uint8_t size = 0;
+
+    if((prm = cli_get_parameter(cmd, prm_index, &size)) == NULL)
+    {
+        return false;
+    }
+
+    *value = (int32_t)strtol((const char *)prm, &end, 0);
+
+    // Whole parameter must be a number.
+    return (end == (const char *)prm + size) ? true : false;
+}
+
+int16_t cli_get_enum(const uint8_t *cmd, uint8_t prm_index, const cli_enum_t *names)
+{
+    const uint8_t *prm = NULL;
+    uint8_t size = 0;
+    uint8_t i = 0;
+
+    if((prm = cli_get_parameter(cmd, prm_index, &size)) == NULL)
+    {
+        return -1;
+    }
+
+    for(i = 0; i < names->count; i++)
+    {
+        if(strlen(names->names[i]) == size && memcmp(prm, names->names[i], size) == 0)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+const cli_cmd_t *cli_get_cmd(uint8_t idx)
+{
+    if(idx >= cli_cmd_count)
+    {
+        return NULL;
+    }
+
+    return &CLI_CMD_FIRST[idx];
+}
+
+uint8_t cli_get_cmd_count(void)
+{
+    return cli_cmd_count;
+}
+
 /**********************************************************************************************************************
  * Private functions
  *********************************************************************************************************************/
@@ -231,3 +305,43 @@ static int8_t cli_get_prm_count(const uint8_t *cmd)
      as the first word should be the command itself. */
     return prm_count;
 }
+
+static uint8_t cli_hash(const uint8_t *name, uint8_t *size)
+{
+    uint32_t hash = 0;
+
+    *size = 0;
+    while(name[*size] != 0x00 && name[*size] != ' ')
+    {
+        hash = hash * 31 + name[*size];
+        (*size)++;
+    }
+
+    return (uint8_t)(hash & (CLI_HASH_SIZE - 1));
+}
+
+static const cli_cmd_t *cli_find_cmd(const uint8_t *input)
+{
+    const cli_cmd_t *cmd = NULL;
+    uint8_t slot = 0;
+    uint8_t size = 0;
+    uint8_t i = 0;
+
+    slot = cli_hash(input, &size);
+
+    // Table is at most half full, probe ends on free slot.
+    for(i = 0; i < CLI_HASH_SIZE && cli_hash_table[slot] != CLI_HASH_EMPTY; i++)
+    {
+        cmd = &CLI_CMD_FIRST[cli_hash_table[slot]];
+        /* To ensure the string lengths match exactly, so as not to pick up
+         a sub-string of a longer command, check the registered name ends
+         with the input word. */
+        if(memcmp(input, cmd->cmd, size) == 0 && cmd->cmd[size] == 0x00)
+        {
+            return cmd;
+        }
+        slot = (slot + 1) & (CLI_HASH_SIZE - 1);
+    }
+
+    return NULL;
+}
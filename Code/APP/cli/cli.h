@@ -37,6 +37,20 @@ extern "C" {
 /**********************************************************************************************************************
  * Exported definitions and macros
  *********************************************************************************************************************/
+#define CLI_HASH_SIZE       64  //!< Size of command lookup table, power of 2. Limits count of commands to half of it.
+
+/**
+ * @brief   Register command from any source file. Command is placed to "cli_cmd" linker section and added to lookup
+ *          table by @ref cli_init.
+ *
+ * @param   N   Command name, identifier without quotes, e.g. help.
+ * @param   H   Help string.
+ * @param   CB  Command callback. See @ref cli_cmd_callback.
+ * @param   P   Count of parameters, -1 - variable.
+ */
+#define CLI_CMD_REGISTER(N, H, CB, P) \
+    static const cli_cmd_t cli_cmd_##N __attribute__((section("cli_cmd"), used, aligned(4))) = \
+    {(const uint8_t *)#N, (const uint8_t *)(H), (CB), (P)}
 
 /**********************************************************************************************************************
  * Exported types
@@ -67,6 +81,15 @@ typedef struct
     int8_t prm_count;                   /**< Commands expect a fixed number of parameters, which may be zero. */
 } cli_cmd_t;
 
+/**
+ * @brief   Parameter names of enumerated parameter. See @ref cli_get_enum.
+ */
+typedef struct
+{
+    const char * const *names;  //!< Names, index of name is parameter value.
+    uint8_t count;              //!< Count of names.
+} cli_enum_t;
+
 /**********************************************************************************************************************
  * Prototypes of exported variables
  *********************************************************************************************************************/
@@ -120,6 +143,44 @@ uint8_t *cli_get_output_buffer(void);
  */
 const uint8_t *cli_get_parameter(const uint8_t *cmd, uint8_t prm_index, uint8_t *size);
 
+/**
+ * @brief   Get integer parameter. Decimal, hexadecimal with "0x" prefix and negative values are accepted.
+ *
+ * @param   cmd         Pointer to command string.
+ * @param   prm_index   Parameter index, 1 - first parameter after command.
+ * @param   value       Parsed value.
+ *
+ * @return  false if parameter is missing or is not a number.
+ */
+bool cli_get_int(const uint8_t *cmd, uint8_t prm_index, int32_t *value);
+
+/**
+ * @brief   Get enumerated parameter.
+ *
+ * @param   cmd         Pointer to command string.
+ * @param   prm_index   Parameter index, 1 - first parameter after command.
+ * @param   names       Parameter names.
+ *
+ * @return  Index of matching name, -1 if parameter is missing or unknown.
+ */
+int16_t cli_get_enum(const uint8_t *cmd, uint8_t prm_index, const cli_enum_t *names);
+
+/**
+ * @brief   Get registered command.
+ *
+ * @param   idx     Command index, 0 ... @ref cli_get_cmd_count - 1.
+ *
+ * @return  Command, NULL if index is invalid.
+ */
+const cli_cmd_t *cli_get_cmd(uint8_t idx);
+
+/**
+ * @brief   Get count of registered commands.
+ *
+ * @return  Count of commands.
+ */
+uint8_t cli_get_cmd_count(void);
+
 /**
  * @brief   The callback function that is executed when "help" is entered.  This is the only default command
  *          that is always present.
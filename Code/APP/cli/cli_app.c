@@ -38,6 +38,7 @@
  *********************************************************************************************************************/
 #define CLI_APP_RX_SIZE     128
 #define CLI_APP_TX_SIZE     128
+#define CLI_APP_CHUNK_SIZE  16      //!< Size of bulk read from UART receive ring buffer.
 
 /** CLI application thread attributes. */
 const osThreadAttr_t cli_app_thread_attr =
@@ -50,6 +51,7 @@ const osThreadAttr_t cli_app_thread_attr =
 /**********************************************************************************************************************
  * Private definitions and macros
  *********************************************************************************************************************/
+#define CLI_APP_FLAG_RX     0x0001  //!< Thread flag: line terminator or bulk data received.
 
 /**********************************************************************************************************************
  * Private typedef
@@ -62,6 +64,16 @@ const osThreadAttr_t cli_app_thread_attr =
 osThreadId_t cli_app_thread_id;
 uint8_t cli_app_rx_data[CLI_APP_RX_SIZE] = {0};
 uint8_t cli_app_tx_data[CLI_APP_RX_SIZE] = {0};
+/** Bytes read from UART but not yet processed. */
+static uint8_t cli_app_chunk[CLI_APP_CHUNK_SIZE] = {0};
+/** Position of next byte to process in @ref cli_app_chunk. */
+static uint32_t cli_app_chunk_pos = 0;
+/** Count of bytes in @ref cli_app_chunk. */
+static uint32_t cli_app_chunk_count = 0;
+/** Length of line being received. */
+static uint32_t cli_app_line_size = 0;
+/** Line being received didn't fit to buffer. */
+static bool cli_app_line_overflow = false;
 
 /**********************************************************************************************************************
  * Exported variables
@@ -70,6 +82,19 @@ uint8_t cli_app_tx_data[CLI_APP_RX_SIZE] = {0};
 /**********************************************************************************************************************
  * Prototypes of local functions
  *********************************************************************************************************************/
+/**
+ * @brief   UART receive callback. Called from interrupt.
+ */
+static void cli_app_rx_cb(void);
+
+/**
+ * @brief   Assemble line from received data. Doesn't block, partial line is kept in data between calls.
+ *
+ * @param   data    Line buffer, line is zero terminated.
+ * @param   size    Size of line buffer in bytes.
+ *
+ * @return  Length of completed line, 0 if there is no complete line in received data.
+ */
 static uint32_t cli_receive_line(uint8_t *data, uint32_t size);
 
 /**********************************************************************************************************************
@@ -84,6 +109,7 @@ bool cli_app_init(void)
     {
         return false;
     }
+    uart_0_set_rx_cb(cli_app_rx_cb);
 
     return true;
 }
@@ -94,52 +120,93 @@ void cli_app_thread(void *arguments)
 
     while(1)
     {
-        osDelay(10);
-        memset(cli_app_rx_data, 0, CLI_APP_TX_SIZE);
-        if((rx_count = cli_receive_line(cli_app_rx_data, CLI_APP_RX_SIZE)) < 3)
+        // Sleep until terminator is received, data received before callback was set is checked on first pass.
+        while((rx_count = cli_receive_line(cli_app_rx_data, CLI_APP_RX_SIZE)) != 0)
         {
-            continue;
-        }
-        cli_app_rx_data[rx_count] = 0x00;
+            if(rx_count < 3)
+            {
+                continue;
+            }
 #if CLI_APP_ECHO
-        DEBUG("%s", cli_app_rx_data);
+            DEBUG_CLI("%s", cli_app_rx_data);
 #endif
-        memset(cli_app_tx_data, 0, CLI_APP_TX_SIZE);
-        if(cli_process_cmd(cli_app_rx_data, cli_app_tx_data, sizeof(cli_app_tx_data)) == true)
-        {
-            DEBUG("%s", cli_app_tx_data);
+            memset(cli_app_tx_data, 0, CLI_APP_TX_SIZE);
+            if(cli_process_cmd(cli_app_rx_data, cli_app_tx_data, sizeof(cli_app_tx_data)) == true)
+            {
+                DEBUG_CLI("%s", cli_app_tx_data);
+            }
         }
+        osThreadFlagsWait(CLI_APP_FLAG_RX, osFlagsWaitAny, osWaitForever);
     }
 }
 
 /**********************************************************************************************************************
  * Private functions
  *********************************************************************************************************************/
+static void cli_app_rx_cb(void)
+{
+    osThreadFlagsSet(cli_app_thread_id, CLI_APP_FLAG_RX);
+
+    return;
+}
+
 static uint32_t cli_receive_line(uint8_t *data, uint32_t size)
 {
-    uint32_t c = 0;
+    uint32_t line_size = 0;
     uint8_t byte = 0;
 
     while(1)
     {
-        if(uart_0_read_rb(&byte, 1) == 1)
+        if(cli_app_chunk_pos >= cli_app_chunk_count)
         {
-            if(byte == '\r')
+            cli_app_chunk_pos = 0;
+            if((cli_app_chunk_count = uart_0_read_rb(cli_app_chunk, CLI_APP_CHUNK_SIZE)) == 0)
             {
-                break;
-            }
-            data[c] = byte;
-            c++;
-            if(c >= size)
-            {
-                break;
+                return 0;
             }
         }
-        else
+        byte = cli_app_chunk[cli_app_chunk_pos++];
+
+        switch(byte)
         {
-            osDelay(1);
+            case '\r':
+            case '\n':
+                line_size = cli_app_line_size;
+                cli_app_line_size = 0;
+                if(cli_app_line_overflow == true)
+                {
+                    cli_app_line_overflow = false;
+                    DEBUG_CLI("Line too long, max %d characters.", size - 1);
+                    break;
+                }
+                if(line_size == 0)
+                {
+                    // Empty line or second byte of "\r\n".
+                    break;
+                }
+                data[line_size] = 0x00;
+                return line_size;
+            case '\b':
+            case 0x7F:
+                if(cli_app_line_size > 0 && cli_app_line_overflow == false)
+                {
+                    cli_app_line_size--;
+                }
+                break;
+            default:
+                if(byte < ' ')
+                {
+                    // Ignore other control characters.
+                }
+                else if(cli_app_line_size < size - 1)
+                {
+                    data[cli_app_line_size++] = byte;
+                }
+                else
+                {
+                    cli_app_line_overflow = true;
+                }
+                break;
         }
     }
-
-    return c;
 }
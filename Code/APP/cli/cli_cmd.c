@@ -33,6 +33,9 @@
 #include "common.h"
 #include "bsp.h"
 
+#include "sensors/filters.h"
+#include "sensors/joystick.h"
+
 #include "cmsis_os2.h"
 
 /**********************************************************************************************************************
@@ -50,28 +53,21 @@
 /**********************************************************************************************************************
  * Private variables
  *********************************************************************************************************************/
-/** The definition of the list of commands. Commands that are registered are added to this list. */
-const cli_cmd_t cli_cmd_list[CLI_CMD_COUNT] =
-{
-    {
-        (const uint8_t *)"help",
-        (const uint8_t *)"help      Lists all the registered commands.",
-        cli_cmd_cb_help,
-        0,
-    },
-    {
-        (const uint8_t *)"info",
-        (const uint8_t *)"info      Shows device information.",
-        cli_cmd_cb_info,
-        0,
-    },
-    {
-        (const uint8_t *)"os_info",
-        (const uint8_t *)"os_info   Get OS  information (thread stack size, etcs).",
-        cli_cmd_cb_os_info,
-        0,
-    }
-};
+/** Commands of this file, other modules register their own commands. */
+CLI_CMD_REGISTER(help, "help      Lists all the registered commands.", cli_cmd_cb_help, 0);
+CLI_CMD_REGISTER(info, "info      Shows device information.", cli_cmd_cb_info, 0);
+CLI_CMD_REGISTER(os_info, "os_info   Get OS  information (thread stack size, etcs).", cli_cmd_cb_os_info, 0);
+CLI_CMD_REGISTER(log, "log       Log levels: log [<module|all> <off|error|warn|info|verbose>].", cli_cmd_cb_log, -1);
+
+#if FILTERS_BENCH || JOYSTICK_BENCH
+/** Bench command parameters. */
+static const char * const cli_cmd_bench_names[] = {"filters", "vector"};
+static const cli_enum_t cli_cmd_bench_enum = {cli_cmd_bench_names, 2};
+
+/** Cycle count benchmarks, built only with benchmark switches. */
+CLI_CMD_REGISTER(bench, "bench     Fixed point vs double cycle count benchmark: bench <filters|vector>.",
+                 cli_cmd_cb_bench, 1);
+#endif
 
 /**********************************************************************************************************************
  * Exported variables
@@ -80,28 +76,48 @@ extern osThreadId_t app_thread_id;
 extern osThreadId_t cli_app_thread_id;
 extern osThreadId_t display_thread_id;
 extern osThreadId_t radio_thread_id;
+extern osThreadId_t debug_thread_id;
+extern osThreadId_t telemetry_thread_id;
 
 /**********************************************************************************************************************
  * Prototypes of local functions
  *********************************************************************************************************************/
 static void cli_cmd_os_info_print(osThreadId_t id);
 
+#if FILTERS_BENCH
+/**
+ * @brief   Run filters benchmark and print cycles per call and maximal deviation of fixed point filters from double
+ *          precision.
+ */
+static void cli_cmd_bench_filters(void);
+#endif
+
+#if JOYSTICK_BENCH
+/**
+ * @brief   Run joystick vector benchmark and print cycles per point and count of results different from double
+ *          precision.
+ */
+static void cli_cmd_bench_vector(void);
+#endif
+
+
 /**********************************************************************************************************************
  * Exported functions
  *********************************************************************************************************************/
 bool cli_cmd_cb_help(uint8_t *data, uint32_t size, const uint8_t *cmd)
 {
+    const cli_cmd_t *reg_cmd = NULL;
     uint8_t i = 0;
 
     UNUSED_VARIABLE(cmd);
 
     /* Return the next command help string, before moving the pointer on to
      the next command in the list. */
-    for(i = 0; i < CLI_CMD_COUNT; i++)
+    for(i = 0; (reg_cmd = cli_get_cmd(i)) != NULL; i++)
     {
-        if(strlen((char *)cli_cmd_list[i].help) > 2)
+        if(strlen((char *)reg_cmd->help) > 2)
         {
-            DEBUG("%s", cli_cmd_list[i].help);
+            DEBUG_CLI("%s", reg_cmd->help);
         }
     }
 
@@ -112,30 +128,152 @@ bool cli_cmd_cb_info(uint8_t *data, uint32_t size, const uint8_t *cmd)
 {
     UNUSED_VARIABLE(cmd);
 
-    DEBUG("Device ...... DS-2 Controller");
-    DEBUG("Build ....... %s %s", __DATE__, __TIME__);
-    DEBUG("Core Clock .. %ld MHz.", bsp_get_system_core_clock());
+    DEBUG_CLI("Device ...... DS-2 Controller");
+    DEBUG_CLI("Build ....... %s %s", __DATE__, __TIME__);
+    DEBUG_CLI("Core Clock .. %ld MHz.", bsp_get_system_core_clock());
+    DEBUG_CLI("Log dropped . %ld", debug_get_dropped());
 
     return false;
 }
 
 bool cli_cmd_cb_os_info(uint8_t *data, uint32_t size, const uint8_t *cmd)
 {
-    DEBUG("# OS info:");
+    DEBUG_CLI("# OS info:");
     cli_cmd_os_info_print(app_thread_id);
     cli_cmd_os_info_print(cli_app_thread_id);
     cli_cmd_os_info_print(display_thread_id);
     cli_cmd_os_info_print(radio_thread_id);
+    cli_cmd_os_info_print(debug_thread_id);
+    cli_cmd_os_info_print(telemetry_thread_id);
 
     return false;
 }
 
+bool cli_cmd_cb_log(uint8_t *data, uint32_t size, const uint8_t *cmd)
+{
+    const uint8_t *prm = NULL;
+    const uint8_t *lvl = NULL;
+    const char *name = NULL;
+    uint8_t prm_size = 0;
+    uint8_t lvl_size = 0;
+    uint8_t module = 0;
+    uint8_t level = 0;
+    bool all = false;
+
+    prm = cli_get_parameter(cmd, 1, &prm_size);
+    lvl = cli_get_parameter(cmd, 2, &lvl_size);
+
+    if(prm_size != 0 && lvl_size != 0)
+    {
+        all = (prm_size == 3 && memcmp(prm, "all", 3) == 0) ? true : false;
+        for(module = 0; module < DEBUG_MODULE_LAST; module++)
+        {
+            name = debug_module_name((debug_module_t)module);
+            if(all == true || (prm_size == strlen(name) && memcmp(prm, name, prm_size) == 0))
+            {
+                break;
+            }
+        }
+        for(level = DEBUG_LEVEL_OFF; level <= DEBUG_LEVEL_VERBOSE; level++)
+        {
+            name = debug_level_name(level);
+            if(lvl_size == strlen(name) && memcmp(lvl, name, lvl_size) == 0)
+            {
+                break;
+            }
+        }
+        if(module >= DEBUG_MODULE_LAST || level > DEBUG_LEVEL_VERBOSE)
+        {
+            DEBUG_CLI("Unknown log module or level.");
+            return false;
+        }
+        for(; module < DEBUG_MODULE_LAST; module++)
+        {
+            debug_set_level((debug_module_t)module, level);
+            if(all == false)
+            {
+                break;
+            }
+        }
+    }
+    else if(prm_size != 0)
+    {
+        DEBUG_CLI("Use: log [<module|all> <off|error|warn|info|verbose>].");
+        return false;
+    }
+
+    DEBUG_CLI("# Log levels (compiled max %s):", debug_level_name(DEBUG_LEVEL_MAX));
+    for(module = 0; module < DEBUG_MODULE_LAST; module++)
+    {
+        DEBUG_CLI("%-8s %s", debug_module_name((debug_module_t)module), debug_level_name(debug_levels[module]));
+    }
+
+    return false;
+}
+
+#if FILTERS_BENCH || JOYSTICK_BENCH
+bool cli_cmd_cb_bench(uint8_t *data, uint32_t size, const uint8_t *cmd)
+{
+    switch(cli_get_enum(cmd, 1, &cli_cmd_bench_enum))
+    {
+#if FILTERS_BENCH
+        case 0:
+            cli_cmd_bench_filters();
+            break;
+#endif
+#if JOYSTICK_BENCH
+        case 1:
+            cli_cmd_bench_vector();
+            break;
+#endif
+        default:
+            snprintf((char *)data, size, "Unknown or not built benchmark. Use: filters or vector.");
+            return true;
+    }
+
+    return false;
+}
+#endif
+
 /**********************************************************************************************************************
  * Private functions
  *********************************************************************************************************************/
+#if FILTERS_BENCH
+static void cli_cmd_bench_filters(void)
+{
+    static const char * const names[FILTERS_BENCH_FILTERS] = {"Low pass", "High pass", "Kalman", "Biquad"};
+    filters_bench_t bench;
+    uint8_t i = 0;
+
+    filters_bench(&bench);
+    DEBUG_CLI("# Filters benchmark, system timer cycles per call, max error in 1/65536:");
+    for(i = 0; i < FILTERS_BENCH_FILTERS; i++)
+    {
+        DEBUG_CLI("%-10s double %5d, q16 %5d, err %d.", names[i], bench.cycles_double[i], bench.cycles_q16[i],
+                  bench.err_max[i]);
+    }
+
+    return;
+}
+#endif
+
+#if JOYSTICK_BENCH
+static void cli_cmd_bench_vector(void)
+{
+    joystick_bench_t bench;
+
+    joystick_bench(&bench);
+    DEBUG_CLI("# Vector benchmark, %d points, system timer cycles per magnitude + direction:", bench.points);
+    DEBUG_CLI("double %d, int %d.", bench.cycles_double, bench.cycles_int);
+    DEBUG_CLI("Magnitude mismatch %d, direction mismatch %d.", bench.magn_mismatch, bench.dir_mismatch);
+
+    return;
+}
+#endif
+
 static void cli_cmd_os_info_print(osThreadId_t id)
 {
-    DEBUG("- %s: prio = %d, stat = %d, sz = %d/%d B.;",
+    DEBUG_CLI("- %s: prio = %d, stat = %d, sz = %d/%d B.;",
           osThreadGetName(id),
           osThreadGetState(id),
           osThreadGetPriority(id),
@@ -33,7 +33,6 @@ extern "C" {
 /**********************************************************************************************************************
  * Exported constants
  *********************************************************************************************************************/
-#define CLI_CMD_COUNT       5  //!< Maximum count of commands in CLI.
 
 /**********************************************************************************************************************
  * Exported definitions and macros
@@ -55,6 +54,8 @@ bool cli_cmd_cb_info(uint8_t *data, uint32_t size, const uint8_t *cmd);
 bool cli_cmd_cb_servo(uint8_t *data, uint32_t size, const uint8_t *cmd);
 bool cli_cmd_cb_pointer(uint8_t *data, uint32_t size, const uint8_t *cmd);
 bool cli_cmd_cb_os_info(uint8_t *data, uint32_t size, const uint8_t *cmd);
+bool cli_cmd_cb_log(uint8_t *data, uint32_t size, const uint8_t *cmd);
+bool cli_cmd_cb_bench(uint8_t *data, uint32_t size, const uint8_t *cmd);
 
 #ifdef __cplusplus
 }
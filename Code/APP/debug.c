@@ -24,6 +24,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdarg.h>
+#include <string.h>
 
 #include "bsp.h"
 #include "cmsis_os2.h"
@@ -35,38 +36,209 @@
  * Private definitions and macros
  *********************************************************************************************************************/
 #define DEBUG_BUFFER_SIZE   256     //!< Debug buffer size in bytes.
-#define DEBUG_LOCK_TIMEOUT  1000    //!< Debug lock semaphore timeout in milliseconds.
+#ifndef DEBUG_RING_SIZE
+#define DEBUG_RING_SIZE     1024    //!< Log records ring size in bytes, power of 2.
+#endif
+#define DEBUG_RECORD_MAX    132     //!< Maximal record payload size in bytes, fits 128 character string argument.
+#define DEBUG_SPEC_MAX      16      //!< Maximal conversion specification length.
+#define DEBUG_TX_RETRY      2       //!< Retry period in milliseconds while UART transmit buffer is full.
+
+#define DEBUG_FLAG_RECORD   0x00000001  //!< New log record flag.
+
+/** Ring space of record rounded up to 4 bytes, so every record header is aligned. */
+#define DEBUG_RECORD_SPACE(size)    (((size) + 3) & ~3UL)
 
 /**********************************************************************************************************************
  * Private typedef
  *********************************************************************************************************************/
+/**
+ * @brief   Log record types.
+ */
+typedef enum
+{
+    DEBUG_RECORD_SKIP,  //!< Padding till ring end.
+    DEBUG_RECORD_TEXT,  //!< Format and captured arguments.
+    DEBUG_RECORD_HEX,   //!< Data bytes printed as hex.
+    DEBUG_RECORD_RAW,   //!< Data bytes sent as is, e.g. telemetry frames.
+} debug_record_type_t;
+
+/**
+ * @brief   Log record states.
+ */
+typedef enum
+{
+    DEBUG_RECORD_WRITING,   //!< Space is reserved, producer fills record.
+    DEBUG_RECORD_READY,     //!< Record can be printed.
+} debug_record_state_t;
+
+/**
+ * @brief   Log record header. Payload follows header.
+ */
+typedef struct
+{
+    uint16_t size;          //!< Record size including header. Ring space is @ref DEBUG_RECORD_SPACE.
+    volatile uint8_t state; //!< Record state, see @ref debug_record_state_t.
+    uint8_t type;           //!< Record type, see @ref debug_record_type_t.
+    const char *fmt;        //!< Format of text record.
+#if DEBUG_TOKENIZED
+    uint32_t tick;          //!< Kernel tick of record.
+#endif
+} debug_record_t;
+
+/**
+ * @brief   Classes of conversion arguments.
+ */
+typedef enum
+{
+    DEBUG_ARG_NONE,     //!< No argument, e.g. "%%".
+    DEBUG_ARG_INT,      //!< 32 bit integer, character or pointer.
+    DEBUG_ARG_LLONG,    //!< 64 bit integer.
+    DEBUG_ARG_DOUBLE,   //!< Floating point.
+    DEBUG_ARG_STRING,   //!< String, copied to record.
+} debug_arg_t;
 
 /**********************************************************************************************************************
  * Private constants
  *********************************************************************************************************************/
+/** Debug thread attributes. */
+const osThreadAttr_t debug_thread_attr =
+{
+    .name = "DEBUG",
+    .stack_size = 768,
+    .priority = osPriorityLow,
+};
+
+/** Module names. See @ref debug_module_t. */
+static const char * const debug_module_names[DEBUG_MODULE_LAST] = {"app", "radio", "display", "sensors"};
+/** Log level names. */
+static const char * const debug_level_names[DEBUG_LEVEL_VERBOSE + 1] = {"off", "error", "warn", "info", "verbose"};
 
 /**********************************************************************************************************************
  * Private variables
  *********************************************************************************************************************/
-/** @brief   Debug lock semaphore id. */
-osSemaphoreId_t debug_lock_id;
-/** Debug buffer, See @ref DEBUG_BUFFER_SIZE. */
+/** Debug thread ID. */
+osThreadId_t debug_thread_id;
+/** Debug buffer, See @ref DEBUG_BUFFER_SIZE. Used by boot output and debug thread. */
 __IO uint8_t debug_buffer[DEBUG_BUFFER_SIZE] = {0};
+/** Log records ring. See @ref DEBUG_RING_SIZE. */
+static uint32_t debug_ring[DEBUG_RING_SIZE / sizeof(uint32_t)];
+/** Ring write position, free running. Changed by producers with interrupts disabled. */
+static volatile uint32_t debug_head = 0;
+/** Ring read position, free running. Changed by debug thread only. */
+static volatile uint32_t debug_tail = 0;
+/** Records dropped because ring was full. */
+static volatile uint32_t debug_dropped = 0;
 
 /**********************************************************************************************************************
  * Exported variables
  *********************************************************************************************************************/
+/** Runtime log level of each module, everything compiled in is enabled by default. */
+volatile uint8_t debug_levels[DEBUG_MODULE_LAST] = {DEBUG_LEVEL_MAX, DEBUG_LEVEL_MAX, DEBUG_LEVEL_MAX, DEBUG_LEVEL_MAX};
 
 /**********************************************************************************************************************
  * Prototypes of local functions
  *********************************************************************************************************************/
+/**
+ * @brief   Reserve record in ring.
+ *
+ * @param   type    Record type. See @ref debug_record_type_t.
+ * @param   payload Payload size in bytes.
+ * @param   wait    Wait while ring is full, thread context only. Otherwise record is dropped.
+ *
+ * @return  Record to fill, NULL if ring is full.
+ */
+static debug_record_t *debug_record_reserve(debug_record_type_t type, uint16_t payload, bool wait);
+
+/**
+ * @brief   Capture text record to ring. See @ref debug_send_os.
+ *
+ * @param   wait    Wait while ring is full.
+ * @param   fmt     Pointer to debug message format.
+ * @param   args    Format arguments.
+ */
+static void debug_vsend_os(bool wait, const char *fmt, va_list args);
+
+/**
+ * @brief   Mark record as ready and wake up debug thread.
+ *
+ * @param   record  Record from @ref debug_record_reserve.
+ */
+static void debug_record_commit(debug_record_t *record);
+
+/**
+ * @brief   Parse printf conversion specification.
+ *
+ * @param   spec    Specification, points after '%'.
+ * @param   arg     Argument class. See @ref debug_arg_t.
+ * @param   stars   Number of '*' width and precision arguments.
+ *
+ * @return  Specification length without '%'.
+ */
+static uint8_t debug_parse_spec(const char *spec, debug_arg_t *arg, uint8_t *stars);
+
+/**
+ * @brief   Capture arguments of format to payload. Strings are copied, so caller buffers can be reused.
+ *
+ * @param   payload Payload buffer.
+ * @param   size    Payload buffer size.
+ * @param   fmt     Format.
+ * @param   args    Format arguments.
+ *
+ * @return  Payload size. Arguments not fit into payload are not printed.
+ */
+static uint16_t debug_capture(uint8_t *payload, uint16_t size, const char *fmt, va_list args);
+
+#if DEBUG_TOKENIZED
+/**
+ * @brief   Encode record to binary frame: sync, length, format ID, tick, captured arguments, checksum.
+ *
+ * @param   record  Text or hex record.
+ * @param   out     Output buffer.
+ * @param   size    Output buffer size.
+ *
+ * @return  Frame size.
+ */
+static uint16_t debug_encode(const debug_record_t *record, uint8_t *out, uint16_t size);
+#else
+/**
+ * @brief   Print text record.
+ *
+ * @param   record  Text record.
+ * @param   out     Output buffer.
+ * @param   size    Output buffer size.
+ *
+ * @return  Printed text size.
+ */
+static uint16_t debug_render(const debug_record_t *record, char *out, uint16_t size);
+
+/**
+ * @brief   Print hex record.
+ *
+ * @param   record  Hex record.
+ * @param   out     Output buffer.
+ * @param   size    Output buffer size.
+ *
+ * @return  Printed text size.
+ */
+static uint16_t debug_render_hex(const debug_record_t *record, char *out, uint16_t size);
+#endif
+
+
+/**
+ * @brief   Put data to UART transmit ring buffer, wait while it is full.
+ *
+ * @param   data    Data to send.
+ * @param   size    Data size in bytes.
+ */
+static void debug_output(uint8_t *data, uint16_t size);
 
 /**********************************************************************************************************************
  * Exported functions
  *********************************************************************************************************************/
 bool debug_init(void)
 {
-    if((debug_lock_id = osSemaphoreNew(1, 1, 0)) == NULL)
+    // Create debug thread.
+    if((debug_thread_id = osThreadNew(&debug_thread, NULL, &debug_thread_attr)) == NULL)
     {
         return false;
     }
@@ -74,6 +246,52 @@ bool debug_init(void)
     return true;
 }
 
+void debug_thread(void *arguments)
+{
+    const debug_record_t *record = NULL;
+    uint16_t size = 0;
+
+    while(1)
+    {
+        osThreadFlagsWait(DEBUG_FLAG_RECORD, osFlagsWaitAny, osWaitForever);
+
+        // Records are printed in reservation order, stop at record which is still being written.
+        while(debug_tail != debug_head)
+        {
+            record = (const debug_record_t *)((uint8_t *)debug_ring + (debug_tail & (DEBUG_RING_SIZE - 1)));
+            if(record->state != DEBUG_RECORD_READY)
+            {
+                break;
+            }
+            switch(record->type)
+            {
+#if DEBUG_TOKENIZED
+                case DEBUG_RECORD_TEXT:
+                case DEBUG_RECORD_HEX:
+                    size = debug_encode(record, (uint8_t *)debug_buffer, DEBUG_BUFFER_SIZE);
+                    debug_output((uint8_t *)debug_buffer, size);
+                    break;
+#else
+                case DEBUG_RECORD_TEXT:
+                    size = debug_render(record, (char *)debug_buffer, DEBUG_BUFFER_SIZE);
+                    debug_output((uint8_t *)debug_buffer, size);
+                    break;
+                case DEBUG_RECORD_HEX:
+                    size = debug_render_hex(record, (char *)debug_buffer, DEBUG_BUFFER_SIZE);
+                    debug_output((uint8_t *)debug_buffer, size);
+                    break;
+#endif
+                case DEBUG_RECORD_RAW:
+                    debug_output((uint8_t *)(record + 1), record->size - sizeof(debug_record_t));
+                    break;
+                default:
+                    break;
+            }
+            debug_tail += DEBUG_RECORD_SPACE(record->size);
+        }
+    }
+}
+
 void debug_send(const char *fmt, ...)
 {
     uint16_t i = 0;
@@ -90,58 +308,523 @@ void debug_send(const char *fmt, ...)
 
 void debug_send_os(const char *fmt, ...)
 {
-    uint16_t i = 0;
     va_list args;
 
-    if (osSemaphoreAcquire(debug_lock_id, DEBUG_LOCK_TIMEOUT) == osOK)
+    va_start(args, fmt);
+    debug_vsend_os(false, fmt, args);
+    va_end(args);
+
+    return;
+}
+
+void debug_send_os_wait(const char *fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    debug_vsend_os(true, fmt, args);
+    va_end(args);
+
+    return;
+}
+
+void debug_send_hex_os(uint8_t *buffer, uint16_t size)
+{
+    debug_record_t *record = NULL;
+
+    if(size > DEBUG_RECORD_MAX)
     {
-        va_start(args, fmt);
-        i = vsnprintf((char*)debug_buffer, DEBUG_BUFFER_SIZE - 1, fmt, args);
-        debug_buffer[i] = 0x00;     // Make sure its zero terminated
-        uart_0_send((uint8_t *)debug_buffer, i);
-        va_end(args);
-        osSemaphoreRelease(debug_lock_id);
+        size = DEBUG_RECORD_MAX;
     }
+    if((record = debug_record_reserve(DEBUG_RECORD_HEX, size, false)) == NULL)
+    {
+        return;
+    }
+    record->fmt = NULL;
+    memcpy(record + 1, buffer, size);
+    debug_record_commit(record);
 
     return;
 }
 
-void debug_send_hex_os(uint8_t *buffer, uint16_t size)
+bool debug_send_raw_os(const uint8_t *data, uint16_t size)
+{
+    debug_record_t *record = NULL;
+
+    if(size > DEBUG_RECORD_MAX || (record = debug_record_reserve(DEBUG_RECORD_RAW, size, false)) == NULL)
+    {
+        return false;
+    }
+    record->fmt = NULL;
+    memcpy(record + 1, data, size);
+    debug_record_commit(record);
+
+    return true;
+}
+
+void debug_send_blocking(uint8_t *data, uint32_t size)
+{
+    uart_0_send(data, size);
+
+    return;
+}
+
+uint32_t debug_get_dropped(void)
+{
+    return debug_dropped;
+}
+
+bool debug_set_level(debug_module_t module, uint8_t level)
+{
+    if(module >= DEBUG_MODULE_LAST || level > DEBUG_LEVEL_VERBOSE)
+    {
+        return false;
+    }
+
+    debug_levels[module] = level;
+
+    return true;
+}
+
+const char *debug_module_name(debug_module_t module)
+{
+    if(module >= DEBUG_MODULE_LAST)
+    {
+        return NULL;
+    }
+
+    return debug_module_names[module];
+}
+
+const char *debug_level_name(uint8_t level)
+{
+    if(level > DEBUG_LEVEL_VERBOSE)
+    {
+        return NULL;
+    }
+
+    return debug_level_names[level];
+}
+
+bool debug_rate_check(debug_rate_t *rate, uint32_t period)
+{
+    uint32_t tick = osKernelGetTickCount();
+
+    // Call site state is not shared between threads, no locking.
+    if(rate->started == true && tick - rate->tick < period)
+    {
+        return false;
+    }
+    rate->started = true;
+    rate->tick = tick;
+
+    return true;
+}
+
+/**********************************************************************************************************************
+ * Private functions
+ *********************************************************************************************************************/
+static debug_record_t *debug_record_reserve(debug_record_type_t type, uint16_t payload, bool wait)
+{
+    debug_record_t *record = NULL;
+    uint32_t size = DEBUG_RECORD_SPACE(sizeof(debug_record_t) + payload);
+    uint32_t offset = 0;
+    uint32_t skip = 0;
+
+    // Cortex-M0+ has no exclusive access, reservation is the only part done with interrupts disabled.
+    while(1)
+    {
+        __disable_irq();
+        offset = debug_head & (DEBUG_RING_SIZE - 1);
+        skip = 0;
+        if(offset + size > DEBUG_RING_SIZE)
+        {
+            // Record is never split, rest of ring is skipped.
+            skip = DEBUG_RING_SIZE - offset;
+        }
+        if(DEBUG_RING_SIZE - (debug_head - debug_tail) >= skip + size)
+        {
+            break;
+        }
+        if(wait != true)
+        {
+            debug_dropped++;
+            __enable_irq();
+            return NULL;
+        }
+        __enable_irq();
+        // Debug thread frees ring at UART rate.
+        osDelay(DEBUG_TX_RETRY);
+    }
+    if(skip != 0)
+    {
+        record = (debug_record_t *)((uint8_t *)debug_ring + offset);
+        record->size = skip;
+        record->type = DEBUG_RECORD_SKIP;
+        record->state = DEBUG_RECORD_READY;
+        offset = 0;
+    }
+    record = (debug_record_t *)((uint8_t *)debug_ring + offset);
+    record->size = sizeof(debug_record_t) + payload;
+    record->type = type;
+    record->state = DEBUG_RECORD_WRITING;
+    debug_head += skip + size;
+    __enable_irq();
+#if DEBUG_TOKENIZED
+    record->tick = osKernelGetTickCount();
+#endif
+
+    return record;
+}
+
+static void debug_vsend_os(bool wait, const char *fmt, va_list args)
+{
+    uint8_t payload[DEBUG_RECORD_MAX];
+    debug_record_t *record = NULL;
+    uint16_t size = 0;
+
+    size = debug_capture(payload, sizeof(payload), fmt, args);
+    if((record = debug_record_reserve(DEBUG_RECORD_TEXT, size, wait)) == NULL)
+    {
+        return;
+    }
+    record->fmt = fmt;
+    memcpy(record + 1, payload, size);
+    debug_record_commit(record);
+
+    return;
+}
+
+static void debug_record_commit(debug_record_t *record)
+{
+    __DMB();
+    record->state = DEBUG_RECORD_READY;
+    if(debug_thread_id != NULL)
+    {
+        osThreadFlagsSet(debug_thread_id, DEBUG_FLAG_RECORD);
+    }
+
+    return;
+}
+
+static uint8_t debug_parse_spec(const char *spec, debug_arg_t *arg, uint8_t *stars)
+{
+    uint8_t i = 0;
+    bool llong = false;
+
+    *arg = DEBUG_ARG_NONE;
+    *stars = 0;
+
+    while(spec[i] == '-' || spec[i] == '+' || spec[i] == ' ' || spec[i] == '#' || spec[i] == '0')
+    {
+        i++;
+    }
+    while(spec[i] == '*' || spec[i] == '.' || (spec[i] >= '0' && spec[i] <= '9'))
+    {
+        if(spec[i] == '*')
+        {
+            (*stars)++;
+        }
+        i++;
+    }
+    while(spec[i] == 'h' || spec[i] == 'l' || spec[i] == 'L' || spec[i] == 'j' || spec[i] == 'z' || spec[i] == 't')
+    {
+        if((spec[i] == 'l' && spec[i + 1] == 'l') || spec[i] == 'j')
+        {
+            llong = true;
+        }
+        i++;
+    }
+
+    switch(spec[i])
+    {
+        case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c': case 'p':
+            *arg = llong ? DEBUG_ARG_LLONG : DEBUG_ARG_INT;
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            *arg = DEBUG_ARG_DOUBLE;
+            break;
+        case 's':
+            *arg = DEBUG_ARG_STRING;
+            break;
+        case '\0':
+            return i;
+        default:
+            break;
+    }
+
+    return i + 1;
+}
+
+static uint16_t debug_capture(uint8_t *payload, uint16_t size, const char *fmt, va_list args)
 {
-    uint16_t i = 0;
     uint16_t c = 0;
+    uint16_t len = 0;
+    uint32_t value = 0;
+    uint64_t llong = 0;
+    double dvalue = 0;
+    const char *str = NULL;
+    debug_arg_t arg = DEBUG_ARG_NONE;
+    uint8_t stars = 0;
 
-    if(osSemaphoreAcquire(debug_lock_id, DEBUG_LOCK_TIMEOUT) == osOK)
+    while(*fmt != '\0')
     {
-        for(i = 0; i < size; i++)
+        if(*fmt++ != '%')
         {
-            if((c + 8) >= DEBUG_BUFFER_SIZE)
-            {
-                break;
-            }
-            if(i > 0)
+            continue;
+        }
+        fmt += debug_parse_spec(fmt, &arg, &stars);
+
+        // Arguments are stored 4 bytes aligned, in format order.
+        for(; stars > 0; stars--)
+        {
+            value = va_arg(args, int);
+            if(c + sizeof(value) <= size)
             {
-                c += snprintf((char*)&debug_buffer[c], (DEBUG_BUFFER_SIZE - c), ",%02X", buffer[i]);
+                memcpy(&payload[c], &value, sizeof(value));
             }
-            else
+            c += sizeof(value);
+        }
+        switch(arg)
+        {
+            case DEBUG_ARG_INT:
+                value = va_arg(args, uint32_t);
+                if(c + sizeof(value) <= size)
+                {
+                    memcpy(&payload[c], &value, sizeof(value));
+                }
+                c += sizeof(value);
+                break;
+            case DEBUG_ARG_LLONG:
+                llong = va_arg(args, uint64_t);
+                if(c + sizeof(llong) <= size)
+                {
+                    memcpy(&payload[c], &llong, sizeof(llong));
+                }
+                c += sizeof(llong);
+                break;
+            case DEBUG_ARG_DOUBLE:
+                dvalue = va_arg(args, double);
+                if(c + sizeof(dvalue) <= size)
+                {
+                    memcpy(&payload[c], &dvalue, sizeof(dvalue));
+                }
+                c += sizeof(dvalue);
+                break;
+            case DEBUG_ARG_STRING:
+                str = va_arg(args, const char *);
+                if(str == NULL)
+                {
+                    str = "(null)";
+                }
+                if(c >= size)
+                {
+                    break;
+                }
+                // Too long string is cut to fit payload.
+                len = strlen(str);
+                if(len > size - c - 1)
+                {
+                    len = size - c - 1;
+                }
+                memcpy(&payload[c], str, len);
+                payload[c + len] = '\0';
+                c = (c + len + 1 + 3) & ~3U;
+                break;
+            default:
+                break;
+        }
+        if(c > size)
+        {
+            return size;
+        }
+    }
+
+    return c;
+}
+
+#if DEBUG_TOKENIZED
+static uint16_t debug_encode(const debug_record_t *record, uint8_t *out, uint16_t size)
+{
+    uint16_t length = record->size - sizeof(debug_record_t);
+    uint16_t id = DEBUG_FRAME_HEX;
+    uint8_t sum = 0;
+    uint16_t i = 0;
+
+    if(record->type == DEBUG_RECORD_TEXT)
+    {
+        id = (uint16_t)((uintptr_t)record->fmt >> 2);
+    }
+    if(length + 9 > size)
+    {
+        length = size - 9;
+    }
+
+    // Multi-byte fields are little endian, checksum makes sum of bytes after sync zero.
+    out[0] = DEBUG_FRAME_SYNC;
+    out[1] = (uint8_t)(length + 6);
+    out[2] = (uint8_t)id;
+    out[3] = (uint8_t)(id >> 8);
+    memcpy(&out[4], &record->tick, sizeof(record->tick));
+    memcpy(&out[8], record + 1, length);
+    for(i = 1; i < length + 8; i++)
+    {
+        sum += out[i];
+    }
+    out[length + 8] = (uint8_t)(0 - sum);
+
+    return length + 9;
+}
+#else
+static uint16_t debug_render(const debug_record_t *record, char *out, uint16_t size)
+{
+    const uint8_t *payload = (const uint8_t *)(record + 1);
+    uint16_t payload_size = record->size - sizeof(debug_record_t);
+    const char *fmt = record->fmt;
+    char spec[DEBUG_SPEC_MAX + 1];
+    char *s = NULL;
+    uint16_t c = 0;
+    uint16_t p = 0;
+    uint8_t len = 0;
+    uint8_t stars = 0;
+    int32_t star = 0;
+    uint32_t value = 0;
+    uint64_t llong = 0;
+    double dvalue = 0;
+    debug_arg_t arg = DEBUG_ARG_NONE;
+    int ret = 0;
+
+    size--;     // Space for terminating zero.
+    while(*fmt != '\0' && c < size)
+    {
+        if(*fmt != '%')
+        {
+            out[c++] = *fmt++;
+            continue;
+        }
+        len = debug_parse_spec(fmt + 1, &arg, &stars) + 1;
+        if(len + stars * 6 > DEBUG_SPEC_MAX || (arg == DEBUG_ARG_NONE && fmt[1] != '%'))
+        {
+            // Unexpected specification, print it as is.
+            out[c++] = *fmt++;
+            continue;
+        }
+        if(payload_size < stars * sizeof(star))
+        {
+            return c;
+        }
+
+        // Stars are replaced by captured values, so single argument is passed to snprintf.
+        s = spec;
+        for(p = 0; p < len; p++)
+        {
+            if(fmt[p] != '*')
             {
-                c += snprintf((char*)&debug_buffer[c], (DEBUG_BUFFER_SIZE - c), "[%02X", buffer[i]);
+                *s++ = fmt[p];
+                continue;
             }
+            memcpy(&star, payload, sizeof(star));
+            payload += sizeof(star);
+            payload_size -= sizeof(star);
+            s += sprintf(s, "%d", (int)(star < -99999 ? -99999 : star > 99999 ? 99999 : star));
+        }
+        *s = '\0';
+        fmt += len;
+
+        ret = 0;
+        switch(arg)
+        {
+            case DEBUG_ARG_NONE:
+                out[c] = '%';
+                ret = 1;
+                break;
+            case DEBUG_ARG_INT:
+                if(payload_size < sizeof(value))
+                {
+                    return c;
+                }
+                memcpy(&value, payload, sizeof(value));
+                payload += sizeof(value);
+                payload_size -= sizeof(value);
+                ret = snprintf(&out[c], size - c + 1, spec, value);
+                break;
+            case DEBUG_ARG_LLONG:
+                if(payload_size < sizeof(llong))
+                {
+                    return c;
+                }
+                memcpy(&llong, payload, sizeof(llong));
+                payload += sizeof(llong);
+                payload_size -= sizeof(llong);
+                ret = snprintf(&out[c], size - c + 1, spec, llong);
+                break;
+            case DEBUG_ARG_DOUBLE:
+                if(payload_size < sizeof(dvalue))
+                {
+                    return c;
+                }
+                memcpy(&dvalue, payload, sizeof(dvalue));
+                payload += sizeof(dvalue);
+                payload_size -= sizeof(dvalue);
+                ret = snprintf(&out[c], size - c + 1, spec, dvalue);
+                break;
+            case DEBUG_ARG_STRING:
+                if(payload_size == 0)
+                {
+                    return c;
+                }
+                ret = snprintf(&out[c], size - c + 1, spec, (const char *)payload);
+                len = (strlen((const char *)payload) + 1 + 3) & ~3U;
+                payload += (len < payload_size) ? len : payload_size;
+                payload_size -= (len < payload_size) ? len : payload_size;
+                break;
+        }
+        if(ret > 0)
+        {
+            c += ((uint16_t)ret < size - c) ? (uint16_t)ret : size - c;
         }
-        c += snprintf((char*)&debug_buffer[c], (DEBUG_BUFFER_SIZE - c), "]\r\n");
-        uart_0_send((uint8_t *)debug_buffer, c);
-        osSemaphoreRelease(debug_lock_id);
     }
+
+    return c;
 }
 
-void debug_send_blocking(uint8_t *data, uint32_t size)
+static uint16_t debug_render_hex(const debug_record_t *record, char *out, uint16_t size)
 {
-    uart_0_send(data, size);
+    const uint8_t *data = (const uint8_t *)(record + 1);
+    uint16_t count = record->size - sizeof(debug_record_t);
+    uint16_t i = 0;
+    uint16_t c = 0;
 
-    return;
+    // Record size is rounded up, printed bytes are limited by record payload.
+    for(i = 0; i < count; i++)
+    {
+        if((c + 8) >= size)
+        {
+            break;
+        }
+        c += snprintf(&out[c], (size - c), i > 0 ? ",%02X" : "[%02X", data[i]);
+    }
+    c += snprintf(&out[c], (size - c), "]\r\n");
+
+    return c;
 }
+#endif
 
-/**********************************************************************************************************************
- * Private functions
- *********************************************************************************************************************/
 
+static void debug_output(uint8_t *data, uint16_t size)
+{
+    uint32_t sent = 0;
+
+    while(size > 0)
+    {
+        sent = uart_0_send_rb(data, size);
+        data += sent;
+        size -= sent;
+        if(size > 0)
+        {
+            osDelay(DEBUG_TX_RETRY);
+        }
+    }
+
+    return;
+}
@@ -33,17 +33,98 @@ extern "C" {
 /**********************************************************************************************************************
  * Exported definitions and macros
  *********************************************************************************************************************/
+#ifndef DEBUG_TOKENIZED
+#define DEBUG_TOKENIZED     0   //!< Log output: 0 - text, 1 - binary frames with format ID, see Tools/debug_decode.py.
+#endif
+
+#define DEBUG_FRAME_SYNC    0xFE    //!< First byte of binary log frame.
+#define DEBUG_FRAME_HEX     0       //!< Format ID of hex dump frame.
+
+#if DEBUG_TOKENIZED
+/**
+ * Format strings are 4 bytes aligned in own section, so format ID is string address / 4 and fits 16 bits for whole
+ * flash. Strings stay in flash, logging call parses them for argument layout. Tokenized mode saves UART bandwidth and
+ * text rendering in debug thread, not flash. Host decoder takes strings from firmware image.
+ */
+#define DEBUG_SEND_OS(F, ...)   do { static const char debug_fmt[] __attribute__((section("debug_fmt"), aligned(4))) = F; \
+                                     debug_send_os(debug_fmt, ##__VA_ARGS__); } while(0)
+#define DEBUG_SEND_OS_WAIT(F, ...)  do { static const char debug_fmt[] __attribute__((section("debug_fmt"), aligned(4))) = F; \
+                                     debug_send_os_wait(debug_fmt, ##__VA_ARGS__); } while(0)
+#else
+#define DEBUG_SEND_OS(F, ...)   debug_send_os(F, ##__VA_ARGS__)
+#define DEBUG_SEND_OS_WAIT(F, ...)  debug_send_os_wait(F, ##__VA_ARGS__)
+#endif
+
+/** Log levels. */
+#define DEBUG_LEVEL_OFF         0   //!< Nothing is logged.
+#define DEBUG_LEVEL_ERROR       1   //!< Failures.
+#define DEBUG_LEVEL_WARNING     2   //!< Recoverable problems.
+#define DEBUG_LEVEL_INFO        3   //!< State changes and command output.
+#define DEBUG_LEVEL_VERBOSE     4   //!< Per packet or per sample diagnostics.
+
+#ifndef DEBUG_LEVEL_MAX
+#define DEBUG_LEVEL_MAX         DEBUG_LEVEL_INFO    //!< Logs above this level are removed with their arguments at compile time.
+#endif
+
+/** Log line prefix of each module. */
+#define DEBUG_PREFIX_APP        ""
+#define DEBUG_PREFIX_RADIO      "[RADIO] "
+#define DEBUG_PREFIX_DISPLAY    "[DISPLAY] "
+#define DEBUG_PREFIX_SENSORS    "[SENSORS] "
+
+/**
+ * Log if level is compiled in and enabled for module at runtime, e.g. DEBUG_LOG(RADIO, VERBOSE, "...").
+ * Arguments are not evaluated when log is filtered out.
+ */
+#define DEBUG_LOG(M, L, F, ...) do { if(DEBUG_LEVEL_##L <= DEBUG_LEVEL_MAX && debug_levels[DEBUG_MODULE_##M] >= DEBUG_LEVEL_##L) \
+                                     { DEBUG_SEND_OS(DEBUG_PREFIX_##M F "\r", ##__VA_ARGS__); } } while(0)
+
+/** Same as @ref DEBUG_LOG, but waits while log ring is full instead of dropping. For bulk output of threads. */
+#define DEBUG_LOG_WAIT(M, L, F, ...) \
+                                do { if(DEBUG_LEVEL_##L <= DEBUG_LEVEL_MAX && debug_levels[DEBUG_MODULE_##M] >= DEBUG_LEVEL_##L) \
+                                     { DEBUG_SEND_OS_WAIT(DEBUG_PREFIX_##M F "\r", ##__VA_ARGS__); } } while(0)
+
+/** Same as @ref DEBUG_LOG, but call site logs at most once per P milliseconds. */
+#define DEBUG_LOG_RATE(M, L, P, F, ...) \
+                                do { static debug_rate_t debug_rate = {0}; \
+                                     if(DEBUG_LEVEL_##L <= DEBUG_LEVEL_MAX && debug_levels[DEBUG_MODULE_##M] >= DEBUG_LEVEL_##L && \
+                                        debug_rate_check(&debug_rate, (P))) \
+                                     { DEBUG_SEND_OS(DEBUG_PREFIX_##M F "\r", ##__VA_ARGS__); } } while(0)
+
 /** Debug macros: */
 #define DEBUG_BOOT(F, ...)      debug_send(F "\r", ##__VA_ARGS__)
-#define DEBUG_INIT(F, ...)      debug_send_os(F "\r", ##__VA_ARGS__)
-#define DEBUG(F, ...)           debug_send_os(F "\r", ##__VA_ARGS__)
-#define DEBUG_RADIO(F, ...)     debug_send_os("[RADIO] " F "\r", ##__VA_ARGS__)
-#define DEBUG_DISPLAY(F, ...)   debug_send_os("[DISPLAY] " F "\r", ##__VA_ARGS__)
-#define DEBUG_SENSORS(F, ...)   debug_send_os("[SENSORS] " F "\r", ##__VA_ARGS__)
+#define DEBUG_INIT(F, ...)      DEBUG_LOG(APP, INFO, F, ##__VA_ARGS__)
+#define DEBUG(F, ...)           DEBUG_LOG(APP, INFO, F, ##__VA_ARGS__)
+#define DEBUG_RADIO(F, ...)     DEBUG_LOG(RADIO, INFO, F, ##__VA_ARGS__)
+#define DEBUG_DISPLAY(F, ...)   DEBUG_LOG(DISPLAY, INFO, F, ##__VA_ARGS__)
+#define DEBUG_SENSORS(F, ...)   DEBUG_LOG(SENSORS, INFO, F, ##__VA_ARGS__)
+
+/** CLI reply. Printed regardless of log levels, waits while log ring is full, CLI thread only. */
+#define DEBUG_CLI(F, ...)       DEBUG_SEND_OS_WAIT(F "\r", ##__VA_ARGS__)
 
 /**********************************************************************************************************************
  * Exported types
  *********************************************************************************************************************/
+/**
+ * @brief   Log modules.
+ */
+typedef enum
+{
+    DEBUG_MODULE_APP,       //!< Application, CLI and other logs without module.
+    DEBUG_MODULE_RADIO,     //!< Radio.
+    DEBUG_MODULE_DISPLAY,   //!< Display.
+    DEBUG_MODULE_SENSORS,   //!< Sensors.
+    DEBUG_MODULE_LAST,      //!< Last should stay last.
+} debug_module_t;
+
+/**
+ * @brief   Rate limit state of log call site.
+ */
+typedef struct
+{
+    uint32_t tick;  //!< Kernel tick of last log.
+    bool started;   //!< Call site has logged.
+} debug_rate_t;
 
 /**********************************************************************************************************************
  * Prototypes of exported constants
@@ -52,6 +133,8 @@ extern "C" {
 /**********************************************************************************************************************
  * Prototypes of exported variables
  *********************************************************************************************************************/
+/** Runtime log level of each module. See @ref debug_module_t. */
+extern volatile uint8_t debug_levels[DEBUG_MODULE_LAST];
 
 /**********************************************************************************************************************
  * Prototypes of exported functions
@@ -65,6 +148,13 @@ extern "C" {
  */
 bool debug_init(void);
 
+/**
+ * @brief   Debug thread. Prints log records and sends them through UART transmit ring buffer.
+ *
+ * @param   arguments   Pointer to thread arguments.
+ */
+void debug_thread(void *arguments);
+
 /**
  * @brief   Send debug using std args (printf format).
  *
@@ -75,22 +165,44 @@ bool debug_init(void);
 void debug_send(const char *fmt, ...);
 
 /**
- * @brief   Send debug using std args (printf format).
+ * @brief   Send debug using std args (printf format). Arguments are captured to log record, text is printed later by
+ *          debug thread. Never blocks, record is dropped if log ring is full.
  *
- * @note    Should be used when OS running.
+ * @note    Should be used when OS running. Format must stay valid, e.g. string literal.
  *
  * @param   fmt     Pointer to debug message format.
  */
 void debug_send_os(const char *fmt, ...);
 
 /**
- * @brief   Send data buffer as hex.
+ * @brief   Same as @ref debug_send_os, but waits while log ring is full, so burst output is not dropped.
+ *
+ * @note    Thread context only, not from debug thread.
+ *
+ * @param   fmt     Pointer to debug message format.
+ */
+void debug_send_os_wait(const char *fmt, ...);
+
+/**
+ * @brief   Send data buffer as hex. Data is copied to log record, never blocks.
  *
  * @param   buffer  Pointer to data buffer.
  * @param   size    Size of data buffer in byets.
  */
 void debug_send_hex_os(uint8_t *buffer, uint16_t size);
 
+/**
+ * @brief   Send data bytes as is, in order with log output. Data is copied to log record, never blocks.
+ *
+ * @note    Can be called from interrupt.
+ *
+ * @param   data    Pointer to data.
+ * @param   size    Size of data in bytes, not more than 132.
+ *
+ * @return  false if data was dropped.
+ */
+bool debug_send_raw_os(const uint8_t *data, uint16_t size);
+
 /**
  * @brief   Send debug in simple blocking way.
  *
@@ -101,6 +213,51 @@ void debug_send_hex_os(uint8_t *buffer, uint16_t size);
  */
 void debug_send_blocking(uint8_t *data, uint32_t size);
 
+/**
+ * @brief   Get number of log records dropped because log ring was full.
+ *
+ * @return  Dropped records count.
+ */
+uint32_t debug_get_dropped(void);
+
+/**
+ * @brief   Set runtime log level of module.
+ *
+ * @param   module  Module. See @ref debug_module_t.
+ * @param   level   Log level, DEBUG_LEVEL_OFF ... DEBUG_LEVEL_VERBOSE.
+ *
+ * @return  false if module or level is invalid.
+ */
+bool debug_set_level(debug_module_t module, uint8_t level);
+
+/**
+ * @brief   Get module name.
+ *
+ * @param   module  Module. See @ref debug_module_t.
+ *
+ * @return  Module name, NULL if module is invalid.
+ */
+const char *debug_module_name(debug_module_t module);
+
+/**
+ * @brief   Get log level name.
+ *
+ * @param   level   Log level.
+ *
+ * @return  Level name, NULL if level is invalid.
+ */
+const char *debug_level_name(uint8_t level);
+
+/**
+ * @brief   Check rate limit of log call site. Used by @ref DEBUG_LOG_RATE.
+ *
+ * @param   rate    Call site rate limit state.
+ * @param   period  Minimal period between logs in milliseconds.
+ *
+ * @return  true if call site can log now.
+ */
+bool debug_rate_check(debug_rate_t *rate, uint32_t period);
+
 #ifdef __cplusplus
 }
 #endif
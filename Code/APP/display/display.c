@@ -30,6 +30,7 @@
 #include "display/display_menu.h"
 #include "display/display_popup.h"
 
+#include "cli/cli.h"
 #include "debug.h"
 
 #include "cmsis_os2.h"
@@ -39,9 +40,18 @@
  * Private definitions and macros
  *********************************************************************************************************************/
 #define DISPLAY_TIMEOUT         10000   //!< Display ON timeout in milliseconds.
-#define DISPLAY_DIM_ON_DELAY    1       //!< Dim ON step delay in milliseconds.
-#define DISPLAY_DIM_OFF_DELAY   1       //!< Dim OFF step delay in milliseconds.
+#define DISPLAY_FADE_STEPS      16      //!< Contrast fade steps count.
+#define DISPLAY_FADE_ON_TIME    160     //!< Contrast fade in (dim ON) duration in milliseconds.
+#define DISPLAY_FADE_OFF_TIME   480     //!< Contrast fade out (dim OFF) duration in milliseconds.
 #define DISPLAY_FIRST_MENU      1       //!< If 1 after wakeup displays first menu, else - last viewed.
+#define DISPLAY_REFRESH_MIN     50      //!< Minimum period between data change triggered redraws in milliseconds.
+
+#define DISPLAY_FLAG_MENU       0x0001  //!< Thread flag: menu changed.
+#define DISPLAY_FLAG_POPUP      0x0002  //!< Thread flag: pop-up was set.
+#define DISPLAY_FLAG_POWER      0x0004  //!< Thread flag: power control changed.
+#define DISPLAY_FLAG_DATA       0x0008  //!< Thread flag: displayed data changed.
+#define DISPLAY_FLAG_FADE       0x0010  //!< Thread flag: contrast fade step.
+#define DISPLAY_FLAG_ALL        (DISPLAY_FLAG_MENU | DISPLAY_FLAG_POPUP | DISPLAY_FLAG_POWER | DISPLAY_FLAG_DATA)
 
 /**********************************************************************************************************************
  * Private typedef
@@ -50,6 +60,14 @@
 /**********************************************************************************************************************
  * Private constants
  *********************************************************************************************************************/
+/** CLI command parameters. */
+static const char * const display_cmd_names[] = {"stats", "reset", "dump"};
+static const cli_enum_t display_cmd_enum = {display_cmd_names, 3};
+/** Perceptual (gamma 2.2) contrast curve used for fading. See @ref DISPLAY_FADE_STEPS. */
+const uint8_t display_fade_curve[DISPLAY_FADE_STEPS + 1] =
+{
+    0, 1, 3, 6, 12, 20, 29, 41, 55, 72, 91, 112, 135, 161, 190, 221, 255,
+};
 
 /**********************************************************************************************************************
  * Private variables
@@ -70,6 +88,13 @@ const osTimerAttr_t display_timer_attr =
 {
     .name = "DISPLAY_TIMER",
 };
+/** Display contrast fade timer ID. */
+osTimerId_t display_fade_timer_id;
+/** Display contrast fade timer attributes. */
+const osTimerAttr_t display_fade_timer_attr =
+{
+    .name = "DISPLAY_FADE",
+};
 /** Display power control flag. */
 volatile bool display_power_cntrl = true;
 /** Display power state flag. */
@@ -80,8 +105,14 @@ volatile display_menu_id_t display_curr_menu_id = (display_menu_id_t)0;
 volatile display_menu_id_t display_last_menu_id = (display_menu_id_t)0;
 /** Display popup data. */
 volatile display_popup_t display_popup_data = {0};
-/** Display contrast. */
-uint8_t display_contrast = 0;
+/** Current contrast fade level, index in @ref display_fade_curve. */
+volatile uint8_t display_fade_level = 0;
+/** Contrast fade target level, index in @ref display_fade_curve. */
+volatile uint8_t display_fade_target = 0;
+/** Contrast fade level last written to display. */
+uint8_t display_fade_applied = 0;
+/** CLI frame dump line buffer. */
+static char display_cmd_line[SSD1306_WIDTH + 1] = {0};
 
 /**********************************************************************************************************************
  * Exported variables
@@ -130,30 +161,74 @@ static bool display_wakeup(void);
 static bool display_sleep(bool dim);
 
 /**
- * @brief   Dim on display.
+ * @brief   Dim on display. Starts contrast fade in and returns immediately.
  */
 static void display_dim_on(void);
 
 /**
- * @brief   Dim off display.
+ * @brief   Dim off display. Starts contrast fade out and returns immediately.
  */
 static void display_dim_off(void);
 
 /**
- * @brief   Display delay function.
+ * @brief   Wait for contrast fade out to finish.
+ *
+ * @return  State of fade out.
+ * @retval  0   aborted, display power ON was requested.
+ * @retval  1   display faded out.
+ */
+static bool display_dim_off_wait(void);
+
+/**
+ * @brief   Start contrast fade.
+ *
+ * @param   target      Target level, index in @ref display_fade_curve.
+ * @param   duration    Full range fade duration in milliseconds.
+ */
+static void display_fade(uint8_t target, uint32_t duration);
+
+/**
+ * @brief   Write current contrast fade level to display.
+ */
+static void display_fade_apply(void);
+
+/**
+ * @brief   Display delay function. Sleeps until menu refresh deadline or until display event.
  *
  * @param   id  Menu ID. See @ref display_menu_id_t.
  */
 static void display_delay(display_menu_id_t id);
 
+/**
+ * @brief   Signal display thread.
+ *
+ * @param   flags   Thread flags to set. See DISPLAY_FLAG_*.
+ */
+static void display_signal(uint32_t flags);
+
+/**
+ * @brief   Wait for display thread flags.
+ *
+ * @param   flags   Thread flags to wait for. See DISPLAY_FLAG_*.
+ * @param   timeout Timeout in milliseconds or osWaitForever.
+ *
+ * @return  Received flags. 0 if timeout.
+ */
+static uint32_t display_wait(uint32_t flags, uint32_t timeout);
+
+/**
+ * @brief   CLI command "display" callback. See @ref cli_cmd_callback.
+ */
+static bool display_cmd_cb(uint8_t *data, uint32_t size, const uint8_t *cmd);
+
 /**********************************************************************************************************************
  * Exported functions
  *********************************************************************************************************************/
 bool display_init(void)
 {
     display_menu_init(DISPLAY_MENU_ID_WELCOME, 0, display_menu_cb_welcome);
-    display_menu_init(DISPLAY_MENU_ID_MAIN, 100, display_menu_cb_main);
-    display_menu_init(DISPLAY_MENU_ID_RADIO, 100, display_menu_cb_radio);
+    display_menu_init(DISPLAY_MENU_ID_MAIN, 1000, display_menu_cb_main);
+    display_menu_init(DISPLAY_MENU_ID_RADIO, 1000, display_menu_cb_radio);
     display_menu_init(DISPLAY_MENU_ID_INFO, 1000, display_menu_cb_info);
 
     display_set_menu(DISPLAY_MENU_ID_WELCOME);
@@ -164,6 +239,12 @@ bool display_init(void)
         return false;
     }
 
+    // Create display contrast fade timer.
+    if((display_fade_timer_id = osTimerNew(&display_fade_handle, osTimerPeriodic, NULL, &display_fade_timer_attr)) == NULL)
+    {
+        return false;
+    }
+
     // Create display thread.
     if((display_thread_id = osThreadNew(&display_thread, NULL, &display_thread_attr)) == NULL)
     {
@@ -179,6 +260,7 @@ void display_turn_off(void)
     __disable_irq();
     display_power_cntrl = false;
     __enable_irq();
+    display_signal(DISPLAY_FLAG_POWER);
 
     return;
 }
@@ -188,6 +270,7 @@ void display_turn_on(void)
     __disable_irq();
     display_power_cntrl = true;
     __enable_irq();
+    display_signal(DISPLAY_FLAG_POWER);
 
     return;
 }
@@ -225,6 +308,7 @@ void display_set_menu(display_menu_id_t id)
         __disable_irq();
         display_power_cntrl = true;
         __enable_irq();
+        display_signal(DISPLAY_FLAG_POWER);
         return;
     }
 
@@ -234,6 +318,7 @@ void display_set_menu(display_menu_id_t id)
     display_menu_list[id].init = false;
     display_power_cntrl = true;
     __enable_irq();
+    display_signal(DISPLAY_FLAG_MENU);
 
     return;
 }
@@ -251,6 +336,7 @@ void display_set_popup(uint8_t *text, uint32_t timeout)
     display_popup_data.active = true;
     display_power_cntrl = true;
     __enable_irq();
+    display_signal(DISPLAY_FLAG_POPUP);
 
     return;
 }
@@ -261,6 +347,14 @@ void display_clear_popup(void)
     display_popup_data.timeout = 0;
     display_popup_data.active = false;
     __enable_irq();
+    display_signal(DISPLAY_FLAG_POPUP);
+
+    return;
+}
+
+void display_refresh(void)
+{
+    display_signal(DISPLAY_FLAG_DATA);
 
     return;
 }
@@ -269,13 +363,13 @@ void display_thread(void *arguments)
 {
     display_menu_id_t menu_id = DISPLAY_MENU_ID_WELCOME;
     display_popup_t popup_data = {0};
+    uint32_t start = 0;
+    uint32_t elapsed = 0;
 
-    osDelay(10);
-
-    // Delay while need to power ON.
+    // Wait while need to power ON.
     while(!display_power_cntrl)
     {
-        osDelay(100);
+        display_wait(DISPLAY_FLAG_POWER | DISPLAY_FLAG_MENU | DISPLAY_FLAG_POPUP, osWaitForever);
     }
     // Power ON.
     display_power_on();
@@ -283,15 +377,6 @@ void display_thread(void *arguments)
 
     while(1)
     {
-#if 0
-        // Delay while need to power ON.
-        while(!display_power_cntrl)
-        {
-            osDelay(100);
-        }
-        // Power ON.
-        display_power_on();
-#endif
         // While is power ON.
         while(display_power_cntrl)
         {
@@ -302,24 +387,23 @@ void display_thread(void *arguments)
                 memcpy(&popup_data, (display_popup_t *)&display_popup_data, sizeof(display_popup_t));
                 display_popup_data.active = false;
                 display_popup_view(&popup_data);
-                while(!display_popup_data.active)
+                // Sleep until pop-up timeout, new pop-up or pop-up clear.
+                start = osKernelGetTickCount();
+                while(!display_popup_data.active && display_popup_data.timeout != 0)
                 {
-                    osDelay(1);
-                    if(popup_data.timeout > 0)
+                    elapsed = osKernelGetTickCount() - start;
+                    if(popup_data.timeout != osWaitForever && elapsed >= popup_data.timeout)
                     {
-                        popup_data.timeout--;
+                        break;
                     }
-                    else
+                    if(display_wait(DISPLAY_FLAG_POPUP,
+                                    popup_data.timeout == osWaitForever ? osWaitForever : popup_data.timeout - elapsed) == 0)
                     {
-                        popup_data.timeout = 0;
                         break;
                     }
                 }
                 osTimerStart(display_timer_id, DISPLAY_TIMEOUT);
-                ssd1306_fill(SSD1306_COLOR_BLACK);
-                display_menu_list[menu_id].init = false;
-                display_menu_list[menu_id].cb(menu_id);
-                display_menu_list[menu_id].init = true;
+                display_popup_hide();
             }
             // Draw menu: header, content.
             menu_id = display_curr_menu_id;
@@ -334,38 +418,23 @@ void display_thread(void *arguments)
                 {
                     display_menu_list[menu_id].cb(menu_id);
                 }
-                if(display_menu_list[menu_id].period)
-                {
-                    display_delay(menu_id);
-                }
-                else
+                if(display_menu_list[menu_id].period == 0)
                 {
                     display_menu_list[menu_id].enable = false;
                 }
                 display_menu_list[menu_id].init = true;
             }
-            else
-            {
-                display_delay(menu_id);
-            }
-        }
-#if 0
-        // Power OFF.
-        if(display_power_off(true))
-        {
-            display_menu_list[menu_id].init = false;
+            display_delay(menu_id);
         }
-#else
         // Sleep.
         if(display_sleep(true))
         {
             display_menu_list[menu_id].init = false;
         }
-#endif
-        // Delay while need to power ON.
+        // Wait while need to power ON.
         while(!display_power_cntrl)
         {
-            osDelay(100);
+            display_wait(DISPLAY_FLAG_POWER | DISPLAY_FLAG_MENU | DISPLAY_FLAG_POPUP, osWaitForever);
         }
         // Power ON.
         display_wakeup();
@@ -377,6 +446,26 @@ void display_timeout_handle(void *arguments)
     __disable_irq();
     display_power_cntrl = false;
     __enable_irq();
+    display_signal(DISPLAY_FLAG_POWER);
+
+    return;
+}
+
+void display_fade_handle(void *arguments)
+{
+    if(display_fade_level < display_fade_target)
+    {
+        display_fade_level++;
+    }
+    else if(display_fade_level > display_fade_target)
+    {
+        display_fade_level--;
+    }
+    if(display_fade_level == display_fade_target)
+    {
+        osTimerStop(display_fade_timer_id);
+    }
+    display_signal(DISPLAY_FLAG_FADE);
 
     return;
 }
@@ -406,8 +495,9 @@ static bool display_power_on(void)
         return false;
     }
     osTimerStart(display_timer_id, DISPLAY_TIMEOUT);
-    display_contrast = 0;
-    ssd1306_set_contrast(display_contrast);
+    display_fade_level = 0;
+    display_fade_applied = 0;
+    ssd1306_set_contrast(display_fade_curve[0]);
 
     display_menu_list[display_last_menu_id].cb(display_last_menu_id);
     display_menu_list[display_last_menu_id].init = true;
@@ -424,6 +514,7 @@ static bool display_power_off(bool dim)
     if(dim)
     {
         display_dim_off();
+        display_dim_off_wait();
     }
     if(display_power_cntrl)
     {
@@ -452,8 +543,10 @@ static bool display_wakeup(void)
         return true;
     }
     ssd1306_on();
-    ssd1306_set_contrast(0);
-    display_contrast = 0;
+    osTimerStop(display_fade_timer_id);
+    display_fade_level = 0;
+    display_fade_applied = 0;
+    ssd1306_set_contrast(display_fade_curve[0]);
 
     osTimerStart(display_timer_id, DISPLAY_TIMEOUT);
 #if DISPLAY_FIRST_MENU
@@ -481,6 +574,7 @@ static bool display_sleep(bool dim)
     if(dim)
     {
         display_dim_off();
+        display_dim_off_wait();
     }
     if(display_power_cntrl)
     {
@@ -498,55 +592,164 @@ static bool display_sleep(bool dim)
 
 static void display_dim_on(void)
 {
-    uint8_t c = display_contrast;
-
-    while(c++ < 0xFF)
-    {
-        ssd1306_set_contrast(c);
-        osDelay(DISPLAY_DIM_ON_DELAY);
-    }
-    display_contrast = 0xFF;
+    display_fade(DISPLAY_FADE_STEPS, DISPLAY_FADE_ON_TIME);
 
     return;
 }
 
 static void display_dim_off(void)
 {
-    uint8_t c = display_contrast;
+    display_fade(0, DISPLAY_FADE_OFF_TIME);
+
+    return;
+}
 
-    while(c--)
+static bool display_dim_off_wait(void)
+{
+    while(display_fade_level != 0 || display_fade_applied != 0)
     {
-        ssd1306_set_contrast(c);
-        osDelay(DISPLAY_DIM_OFF_DELAY);
-        if(display_power_cntrl == true)
+        if(display_power_cntrl)
         {
-            display_contrast = c;
-            return;
+            return false;
         }
+        display_wait(DISPLAY_FLAG_FADE | DISPLAY_FLAG_POWER | DISPLAY_FLAG_MENU | DISPLAY_FLAG_POPUP, osWaitForever);
+    }
+
+    return true;
+}
+
+static void display_fade(uint8_t target, uint32_t duration)
+{
+    display_fade_target = target;
+    osTimerStart(display_fade_timer_id, duration / DISPLAY_FADE_STEPS ? duration / DISPLAY_FADE_STEPS : 1);
+
+    return;
+}
+
+static void display_fade_apply(void)
+{
+    uint8_t level = display_fade_level;
+
+    if(level != display_fade_applied)
+    {
+        ssd1306_set_contrast(display_fade_curve[level]);
+        display_fade_applied = level;
     }
-    display_contrast = 0;
 
     return;
 }
 
 static void display_delay(display_menu_id_t menu)
 {
-    static uint32_t c = 0;
-    uint32_t delay = display_menu_list[menu].period == 0 ? 10 : display_menu_list[menu].period;
+    uint32_t deadline = display_menu_list[menu].period == 0 ? osWaitForever : display_menu_list[menu].period;
+    uint32_t start = osKernelGetTickCount();
+    uint32_t elapsed = 0;
+    uint32_t flags = 0;
 
-    while(delay--)
+    while(elapsed < deadline)
     {
-        osDelay(1);
-        c++;
-        if(c > 100)
+        flags = display_wait(DISPLAY_FLAG_ALL, deadline == osWaitForever ? osWaitForever : deadline - elapsed);
+        if(flags == 0 || (flags & (DISPLAY_FLAG_MENU | DISPLAY_FLAG_POPUP | DISPLAY_FLAG_POWER)))
         {
-            c = 0;
+            break;
         }
-        if(menu != display_curr_menu_id || display_popup_data.active)
+        elapsed = osKernelGetTickCount() - start;
+        // Data changed: redraw, but not more often than DISPLAY_REFRESH_MIN.
+        if(display_menu_list[menu].period != 0 && deadline > DISPLAY_REFRESH_MIN)
         {
-            break;
+            deadline = DISPLAY_REFRESH_MIN;
         }
     }
 
     return;
 }
+
+static void display_signal(uint32_t flags)
+{
+    if(display_thread_id != NULL)
+    {
+        osThreadFlagsSet(display_thread_id, flags);
+    }
+
+    return;
+}
+
+static uint32_t display_wait(uint32_t flags, uint32_t timeout)
+{
+    uint32_t start = osKernelGetTickCount();
+    uint32_t elapsed = 0;
+    uint32_t ret = 0;
+
+    while(1)
+    {
+        ret = osThreadFlagsWait(flags | DISPLAY_FLAG_FADE, osFlagsWaitAny,
+                                timeout == osWaitForever ? osWaitForever : timeout - elapsed);
+        if(ret & osFlagsError)
+        {
+            return 0;
+        }
+        // Contrast fade steps are applied from display thread to keep SPI access in one place.
+        if(ret & DISPLAY_FLAG_FADE)
+        {
+            display_fade_apply();
+        }
+        if(ret & flags)
+        {
+            return ret & flags;
+        }
+        elapsed = osKernelGetTickCount() - start;
+        if(timeout != osWaitForever && elapsed >= timeout)
+        {
+            return 0;
+        }
+    }
+}
+
+static bool display_cmd_cb(uint8_t *data, uint32_t size, const uint8_t *cmd)
+{
+    ssd1306_stats_t stats = {0};
+    uint32_t time_us = 0;
+    uint16_t x = 0;
+    uint16_t y = 0;
+
+    switch(cli_get_enum(cmd, 1, &display_cmd_enum))
+    {
+        case 0:
+            ssd1306_get_stats(&stats);
+            time_us = (uint32_t)(((uint64_t)stats.update_time * 1000000) / osKernelGetSysTimerFreq());
+            DEBUG_CLI("# Display stats:");
+            DEBUG_CLI("Updates ....... %d", stats.updates);
+            DEBUG_CLI("Pages ......... %d", stats.pages);
+            DEBUG_CLI("Pixels ........ %d", stats.pixels);
+            DEBUG_CLI("Data bytes .... %d", stats.data_bytes);
+            DEBUG_CLI("Cmd bytes ..... %d", stats.cmd_bytes);
+            DEBUG_CLI("Transactions .. %d", stats.transactions);
+            DEBUG_CLI("Update time ... %d us (%d us/update).", time_us, stats.updates ? time_us / stats.updates : 0);
+            break;
+        case 1:
+            ssd1306_reset_stats();
+            DEBUG_CLI("Display stats reset.");
+            break;
+        case 2:
+            // Plain PBM (P1), lit pixel is 1.
+            DEBUG_CLI("P1");
+            DEBUG_CLI("%d %d", SSD1306_WIDTH, SSD1306_HEIGHT);
+            for(y = 0; y < SSD1306_HEIGHT; y++)
+            {
+                for(x = 0; x < SSD1306_WIDTH; x++)
+                {
+                    display_cmd_line[x] = ssd1306_get_pixel(x, y) == SSD1306_COLOR_WHITE ? '1' : '0';
+                }
+                display_cmd_line[SSD1306_WIDTH] = 0x00;
+                DEBUG_CLI("%s", display_cmd_line);
+            }
+            break;
+        default:
+            snprintf((char *)data, size, "Unknown parameter. Use: stats, reset or dump.");
+            return true;
+    }
+
+    return false;
+}
+CLI_CMD_REGISTER(display, "display   Display render statistics and frame dump: display <stats|reset|dump>.",
+                 display_cmd_cb, 1);
@@ -118,6 +118,12 @@ void display_set_popup(uint8_t *text, uint32_t timeout);
  */
 void display_clear_popup(void);
 
+/**
+ * @brief   Notify display that data shown in menus has changed.
+ *          Current menu will be redrawn without waiting for its refresh period.
+ */
+void display_refresh(void);
+
 /**
  * @brief   Display thread.
  *
@@ -132,6 +138,13 @@ void display_thread(void *arguments);
  */
 void display_timeout_handle(void *arguments);
 
+/**
+ * @brief   Display contrast fade timer handler.
+ *
+ * @param   arguments   Pointer to timer arguments.
+ */
+void display_fade_handle(void *arguments);
+
 #ifdef __cplusplus
 }
 #endif
@@ -66,7 +66,6 @@ volatile display_menu_t display_menu_list[DISPLAY_MENU_ID_LAST] = {0};
 /**********************************************************************************************************************
  * Exported variables
  *********************************************************************************************************************/
-extern radio_data_t radio_data;
 
 /**********************************************************************************************************************
  * Prototypes of local functions
@@ -137,6 +136,11 @@ void display_menu_cb_welcome(display_menu_id_t id)
 void display_menu_cb_main(display_menu_id_t id)
 {
     uint8_t tmp[DISPLAY_MENU_LINE_LENGTH] = {0};
+    sensors_data_t sensors;
+    radio_data_t radio;
+
+    sensors_get_data(&sensors);
+    radio_get_data(&radio);
 
     display_menu_header(id, (uint8_t *)"Main");
 
@@ -153,14 +157,14 @@ void display_menu_cb_main(display_menu_id_t id)
     ssd1306_puts(tmp, &fonts_7x10, SSD1306_COLOR_WHITE);
 
     snprintf((char *)tmp, DISPLAY_MENU_LINE_LENGTH, "VEC: %d %d     ",
-            sensors_data.joystick_1.magnitude,
-            sensors_data.joystick_1.direction);
+            sensors.joystick_1.magnitude,
+            sensors.joystick_1.direction);
     ssd1306_goto_xy(DISPLAY_MENU_LINE_X, DISPLAY_MENU_LINE_Y_2);
     ssd1306_puts(tmp, &fonts_7x10, SSD1306_COLOR_WHITE);
 
 
     snprintf((char *)tmp, DISPLAY_MENU_LINE_LENGTH, "COM: %d %%      ",
-            radio_data.quality);
+            radio.quality);
     ssd1306_goto_xy(DISPLAY_MENU_LINE_X, DISPLAY_MENU_LINE_Y_3);
     ssd1306_puts(tmp, &fonts_7x10, SSD1306_COLOR_WHITE);
 
@@ -170,22 +174,25 @@ void display_menu_cb_main(display_menu_id_t id)
 void display_menu_cb_radio(display_menu_id_t id)
 {
     uint8_t tmp[DISPLAY_MENU_LINE_LENGTH] = {0};
+    radio_data_t radio;
+
+    radio_get_data(&radio);
 
     display_menu_header(id, (uint8_t *)"Radio");
 
-    snprintf((char *)tmp, DISPLAY_MENU_LINE_LENGTH, "TxD: %d / %d   ", radio_data.tx_counter, radio_data.tx_lost_counter);
+    snprintf((char *)tmp, DISPLAY_MENU_LINE_LENGTH, "TxD: %d / %d   ", radio.tx_counter, radio.tx_lost_counter);
     ssd1306_goto_xy(DISPLAY_MENU_LINE_X, DISPLAY_MENU_LINE_Y_1);
     ssd1306_puts(tmp, &fonts_7x10, SSD1306_COLOR_WHITE);
 
-    snprintf((char *)tmp, DISPLAY_MENU_LINE_LENGTH, "RxD: %d    ", radio_data.rx_counter);
+    snprintf((char *)tmp, DISPLAY_MENU_LINE_LENGTH, "RxD: %d    ", radio.rx_counter);
     ssd1306_goto_xy(DISPLAY_MENU_LINE_X, DISPLAY_MENU_LINE_Y_2);
     ssd1306_puts(tmp, &fonts_7x10, SSD1306_COLOR_WHITE);
 
-    snprintf((char *)tmp, DISPLAY_MENU_LINE_LENGTH, "RTR: %d / %d   ", radio_data.rtr_current, radio_data.rtr);
+    snprintf((char *)tmp, DISPLAY_MENU_LINE_LENGTH, "RTR: %d / %d   ", radio.rtr_current, radio.rtr);
     ssd1306_goto_xy(DISPLAY_MENU_LINE_X, DISPLAY_MENU_LINE_Y_3);
     ssd1306_puts(tmp, &fonts_7x10, SSD1306_COLOR_WHITE);
 
-    snprintf((char *)tmp, DISPLAY_MENU_LINE_LENGTH, "QLT: %d %%  ", radio_data.quality);
+    snprintf((char *)tmp, DISPLAY_MENU_LINE_LENGTH, "QLT: %d %%  ", radio.quality);
     ssd1306_goto_xy(DISPLAY_MENU_LINE_X, DISPLAY_MENU_LINE_Y_4);
     ssd1306_puts(tmp, &fonts_7x10, SSD1306_COLOR_WHITE);
 
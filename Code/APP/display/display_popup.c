@@ -103,7 +103,15 @@ void display_popup_view(display_popup_t *data)
     uint8_t txt_len = 0;
 
     txt_len = snprintf((char *)txt, sizeof(txt), "%s", data->text);
-    
+
+    // Draw pop-up to overlay layer, so menu content under it stays intact.
+    ssd1306_set_layer(SSD1306_LAYER_OVERLAY);
+    ssd1306_overlay_show(
+        ((SSD1306_WIDTH - (DISPLAY_POPUP_BORDER_AX + (fonts_7x10.width * txt_len))) / 2),
+        ((SSD1306_HEIGHT - (DISPLAY_POPUP_BORDER_AY + fonts_7x10.height)) / 2),
+        (DISPLAY_POPUP_BORDER_AX + (fonts_7x10.width  * txt_len)) + 1,
+        (DISPLAY_POPUP_BORDER_AY + fonts_7x10.height) + 1);
+
     ssd1306_draw_filled_rectangle(
         ((SSD1306_WIDTH - (DISPLAY_POPUP_BORDER_AX + (fonts_7x10.width * txt_len))) / 2),
         ((SSD1306_HEIGHT - (DISPLAY_POPUP_BORDER_AY + fonts_7x10.height)) / 2),
@@ -141,7 +149,16 @@ void display_popup_view(display_popup_t *data)
         ((SSD1306_WIDTH - (fonts_7x10.width * txt_len)) / 2),
         ((SSD1306_HEIGHT - fonts_7x10.height) / 2) + 1);
     ssd1306_puts(txt, &fonts_7x10, SSD1306_COLOR_BLACK);
+    ssd1306_set_layer(SSD1306_LAYER_BASE);
+
+    ssd1306_update_screen();
 
+    return;
+}
+
+void display_popup_hide(void)
+{
+    ssd1306_overlay_hide();
     ssd1306_update_screen();
 
     return;
@@ -57,6 +57,11 @@ typedef struct
  *********************************************************************************************************************/
 void display_popup_view(display_popup_t *data);
 
+/**
+ * @brief   Hide pop-up and restore menu content under it.
+ */
+void display_popup_hide(void);
+
 #ifdef __cplusplus
 }
 #endif
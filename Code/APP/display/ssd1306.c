@@ -23,6 +23,7 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "common.h"
 #include "ssd1306.h"
 
 #if SSD1306_DRV_MODE
@@ -30,6 +31,7 @@
 #else
 #include "periph/ssp.h"
 #include "periph/gpio.h"
+#include "chip.h"
 #endif
 
 #include "cmsis_os2.h"
@@ -39,6 +41,26 @@
  *********************************************************************************************************************/
 /** Absolute value. */
 #define ABS(x)   ((x) > 0 ? (x) : -(x))
+/** Pages count. */
+#define SSD1306_PAGES   (SSD1306_HEIGHT / 8)
+
+#if SSD1306_ADDR_MODE
+#if (SSD1306_COLUMN_OFFSET + SSD1306_WIDTH) > 128
+#error "Horizontal addressing mode requires visible area inside of 128 column display RAM."
+#endif
+/** Merge buffer size: whole frame is composed for single data burst. */
+#define SSD1306_MERGE_SIZE  (SSD1306_WIDTH * SSD1306_PAGES)
+#else
+/** Merge buffer size: single page. */
+#define SSD1306_MERGE_SIZE  SSD1306_WIDTH
+#endif
+
+#if SSD1306_STATS
+/** Add value to render statistics field. */
+#define SSD1306_STATS_ADD(FIELD, VALUE)     do { ssd1306_stats.FIELD += (VALUE); } while(0)
+#else
+#define SSD1306_STATS_ADD(FIELD, VALUE)     do { } while(0)
+#endif
 
 /**********************************************************************************************************************
  * Private typedef
@@ -51,8 +73,18 @@
 /**********************************************************************************************************************
  * Private variables
  *********************************************************************************************************************/
-/** SSD1306 data buffer */
+/** SSD1306 data buffer (base layer). */
 static uint8_t ssd1306_buffer[SSD1306_WIDTH * SSD1306_HEIGHT / 8 + 1];
+/** SSD1306 overlay layer buffer. */
+static uint8_t ssd1306_overlay_buffer[SSD1306_WIDTH * SSD1306_HEIGHT / 8];
+/** Merged data buffer used while transmitting pages covered by overlay. */
+static uint8_t ssd1306_merge_buffer[SSD1306_MERGE_SIZE];
+/** Active layer buffer. */
+static uint8_t *ssd1306_layer = ssd1306_buffer;
+/** First changed column of each page. */
+static uint8_t ssd1306_dirty_x0[SSD1306_PAGES];
+/** Last changed column of each page. Page is clean when it is lower than first changed column. */
+static uint8_t ssd1306_dirty_x1[SSD1306_PAGES];
 
 typedef struct {
     uint16_t current_x;
@@ -61,10 +93,18 @@ typedef struct {
     bool initialized;
     bool orientation_h;
     bool orientation_v;
+    bool overlay;           // Overlay window visible.
+    uint16_t overlay_x;     // Overlay window X.
+    uint16_t overlay_y;     // Overlay window Y.
+    uint16_t overlay_w;     // Overlay window width.
+    uint16_t overlay_h;     // Overlay window height.
 } ssd1306_t;
 
 static ssd1306_t ssd1306_data = {0};
 
+/** Render statistics. See @ref ssd1306_stats_t. */
+static ssd1306_stats_t ssd1306_stats = {0};
+
 /**********************************************************************************************************************
  * Exported variables
  *********************************************************************************************************************/
@@ -95,15 +135,54 @@ static void ssd1306_write_cmds(uint8_t *commands, uint8_t count);
  */
 static void ssd1306_write_data(uint8_t *data, uint16_t size);
 
+/**
+ * @brief   Mark area as changed, so it will be transmitted on next update.
+ *
+ * @param   x   Top left X point.
+ * @param   y   Top left Y point.
+ * @param   w   Width in units of pixels.
+ * @param   h   Height in units of pixels.
+ */
+static void ssd1306_mark_dirty(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+
+/**
+ * @brief   Get overlay window rows mask for page.
+ *
+ * @param   page    Page number.
+ *
+ * @return  Bit mask of page rows covered by overlay window.
+ */
+static uint8_t ssd1306_overlay_page_mask(uint8_t page);
+
+/**
+ * @brief   Get page data to transmit. Overlay is merged into output buffer if it covers requested columns.
+ *
+ * @param   page    Page number.
+ * @param   x0      First column.
+ * @param   x1      Last column.
+ * @param   out     Output buffer for merged data, at least (x1 - x0 + 1) bytes.
+ *
+ * @return  Pointer to data of columns x0 ... x1: either base layer buffer or output buffer.
+ */
+static uint8_t *ssd1306_page_data(uint8_t page, uint16_t x0, uint16_t x1, uint8_t *out);
+
 /**********************************************************************************************************************
  * Exported functions
  *********************************************************************************************************************/
 bool ssd1306_init(void)
 {
+    /* Draw to base layer, overlay hidden */
+    ssd1306_layer = ssd1306_buffer;
+    ssd1306_data.overlay = false;
+
     /* Init LCD */
     ssd1306_write_cmd(0xAE); //display off
     ssd1306_write_cmd(0x20); //Set Memory Addressing Mode
+#if SSD1306_ADDR_MODE
+    ssd1306_write_cmd(0x00); //00,Horizontal Addressing Mode;01,Vertical Addressing Mode;10,Page Addressing Mode (RESET);11,Invalid
+#else
     ssd1306_write_cmd(0x10); //00,Horizontal Addressing Mode;01,Vertical Addressing Mode;10,Page Addressing Mode (RESET);11,Invalid
+#endif
     ssd1306_write_cmd(0xB0); //Set Page Start Address for Page Addressing Mode,0-7
     ssd1306_write_cmd(0xC8); //Set COM Output Scan Direction
     ssd1306_write_cmd(0x00); //---set low column address
@@ -191,6 +270,7 @@ void ssd1306_invert_toggle(void)
     {
         ssd1306_buffer[i] = ~ssd1306_buffer[i];
     }
+    ssd1306_mark_dirty(0, 0, SSD1306_WIDTH, SSD1306_HEIGHT);
 #else
     if(!ssd1306_data.inverted)
     {
@@ -223,7 +303,7 @@ void ss1306_orientation_flip_v(void)
 
 void ssd1306_set_contrast(uint8_t contrast)
 {
-    ssd1306_write_cmds((uint8_t[]){0x81, contrast}, 3);
+    ssd1306_write_cmds((uint8_t[]){0x81, contrast}, 2);
 
     return;
 }
@@ -231,11 +311,147 @@ void ssd1306_set_contrast(uint8_t contrast)
 void ssd1306_update_screen(void)
 {
     uint8_t y = 0;
+    uint16_t x0 = 0;
+    uint16_t x1 = 0;
+    uint8_t *data = NULL;
+#if SSD1306_ADDR_MODE
+    uint8_t y0 = SSD1306_PAGES;
+    uint8_t y1 = 0;
+    uint16_t len = 0;
+    uint16_t size = 0;
+    bool merge = false;
+#else
+    uint16_t col = 0;
+#endif
+#if SSD1306_STATS
+    uint32_t start = osKernelGetSysTimerCount();
+#endif
 
-    for(y = 0; y < SSD1306_HEIGHT / 8; y++)
+#if SSD1306_ADDR_MODE
+    /* Find changed window */
+    x0 = SSD1306_WIDTH - 1;
+    x1 = 0;
+    for(y = 0; y < SSD1306_PAGES; y++)
     {
-        ssd1306_write_cmds((uint8_t[]){0xB0 + y, 0x02, 0x10}, 3);
-        ssd1306_write_data(&ssd1306_buffer[SSD1306_WIDTH * y], SSD1306_WIDTH);
+        if(ssd1306_dirty_x1[y] < ssd1306_dirty_x0[y])
+        {
+            continue;
+        }
+        y0 = MIN(y0, y);
+        y1 = MAX(y1, y);
+        x0 = MIN(x0, ssd1306_dirty_x0[y]);
+        x1 = MAX(x1, ssd1306_dirty_x1[y]);
+        if(ssd1306_overlay_page_mask(y))
+        {
+            merge = true;
+        }
+    }
+
+    if(y0 < SSD1306_PAGES)
+    {
+        len = x1 - x0 + 1;
+        if(len == SSD1306_WIDTH && !merge)
+        {
+            /* Full width pages are continuous in base layer buffer */
+            data = &ssd1306_buffer[SSD1306_WIDTH * y0];
+            size = len * (y1 - y0 + 1);
+        }
+        else
+        {
+            /* Compose window into merge buffer */
+            data = ssd1306_merge_buffer;
+            for(y = y0; y <= y1; y++)
+            {
+                if(ssd1306_page_data(y, x0, x1, &ssd1306_merge_buffer[size]) != &ssd1306_merge_buffer[size])
+                {
+                    memcpy(&ssd1306_merge_buffer[size], &ssd1306_buffer[SSD1306_WIDTH * y + x0], len);
+                }
+                size += len;
+            }
+        }
+
+        ssd1306_write_cmds((uint8_t[]){0x21, x0 + SSD1306_COLUMN_OFFSET, x1 + SSD1306_COLUMN_OFFSET, 0x22, y0, y1}, 6);
+        ssd1306_write_data(data, size);
+
+        /* Pages are clean */
+        for(y = y0; y <= y1; y++)
+        {
+            ssd1306_dirty_x0[y] = SSD1306_WIDTH - 1;
+            ssd1306_dirty_x1[y] = 0;
+        }
+        SSD1306_STATS_ADD(pages, y1 - y0 + 1);
+    }
+#else
+    for(y = 0; y < SSD1306_PAGES; y++)
+    {
+        /* Skip unchanged pages */
+        if(ssd1306_dirty_x1[y] < ssd1306_dirty_x0[y])
+        {
+            continue;
+        }
+        x0 = ssd1306_dirty_x0[y];
+        x1 = ssd1306_dirty_x1[y];
+        data = ssd1306_page_data(y, x0, x1, ssd1306_merge_buffer);
+
+        col = x0 + SSD1306_COLUMN_OFFSET;
+        ssd1306_write_cmds((uint8_t[]){0xB0 + y, col & 0x0F, 0x10 | ((col >> 4) & 0x0F)}, 3);
+        ssd1306_write_data(data, x1 - x0 + 1);
+
+        /* Page is clean */
+        ssd1306_dirty_x0[y] = SSD1306_WIDTH - 1;
+        ssd1306_dirty_x1[y] = 0;
+        SSD1306_STATS_ADD(pages, 1);
+    }
+#endif
+
+    SSD1306_STATS_ADD(updates, 1);
+    SSD1306_STATS_ADD(update_time, osKernelGetSysTimerCount() - start);
+
+    return;
+}
+
+void ssd1306_set_layer(ssd1306_layer_t layer)
+{
+    ssd1306_layer = layer == SSD1306_LAYER_OVERLAY ? ssd1306_overlay_buffer : ssd1306_buffer;
+
+    return;
+}
+
+void ssd1306_overlay_show(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+    /* Restore area under previous window */
+    ssd1306_overlay_hide();
+
+    if(x >= SSD1306_WIDTH || y >= SSD1306_HEIGHT || w == 0 || h == 0)
+    {
+        return;
+    }
+    if((x + w) > SSD1306_WIDTH)
+    {
+        w = SSD1306_WIDTH - x;
+    }
+    if((y + h) > SSD1306_HEIGHT)
+    {
+        h = SSD1306_HEIGHT - y;
+    }
+
+    ssd1306_data.overlay_x = x;
+    ssd1306_data.overlay_y = y;
+    ssd1306_data.overlay_w = w;
+    ssd1306_data.overlay_h = h;
+    ssd1306_data.overlay = true;
+    ssd1306_mark_dirty(x, y, w, h);
+
+    return;
+}
+
+void ssd1306_overlay_hide(void)
+{
+    if(ssd1306_data.overlay)
+    {
+        ssd1306_data.overlay = false;
+        ssd1306_mark_dirty(ssd1306_data.overlay_x, ssd1306_data.overlay_y,
+                           ssd1306_data.overlay_w, ssd1306_data.overlay_h);
     }
 
     return;
@@ -244,13 +460,16 @@ void ssd1306_update_screen(void)
 void ssd1306_fill(ssd1306_color_t color)
 {
     /* Set memory */
-    memset(ssd1306_buffer, (color == SSD1306_COLOR_BLACK) ? 0x00 : 0xFF, sizeof(ssd1306_buffer));
+    memset(ssd1306_layer, (color == SSD1306_COLOR_BLACK) ? 0x00 : 0xFF, SSD1306_WIDTH * SSD1306_HEIGHT / 8);
+    ssd1306_mark_dirty(0, 0, SSD1306_WIDTH, SSD1306_HEIGHT);
 
     return;
 }
 
 void ssd1306_draw_pixel(uint16_t x, uint16_t y, ssd1306_color_t c)
 {
+    uint8_t b = 0;
+
     if(x >= SSD1306_WIDTH || y >= SSD1306_HEIGHT)
     {
         /* Error */
@@ -272,14 +491,60 @@ void ssd1306_draw_pixel(uint16_t x, uint16_t y, ssd1306_color_t c)
         y = SSD1306_HEIGHT - y - 1;
     }
     /* Set color */
+    b = ssd1306_layer[x + (y / 8) * SSD1306_WIDTH];
     if(c == SSD1306_COLOR_WHITE)
     {
-        ssd1306_buffer[x + (y / 8) * SSD1306_WIDTH] |= 1 << (y % 8);
+        b |= 1 << (y % 8);
     }
     else
     {
-        ssd1306_buffer[x + (y / 8) * SSD1306_WIDTH] &= ~(1 << (y % 8));
+        b &= ~(1 << (y % 8));
     }
+    if(b != ssd1306_layer[x + (y / 8) * SSD1306_WIDTH])
+    {
+        ssd1306_layer[x + (y / 8) * SSD1306_WIDTH] = b;
+        ssd1306_mark_dirty(x, y, 1, 1);
+    }
+    SSD1306_STATS_ADD(pixels, 1);
+
+    return;
+}
+
+ssd1306_color_t ssd1306_get_pixel(uint16_t x, uint16_t y)
+{
+    ssd1306_color_t c = SSD1306_COLOR_BLACK;
+
+    if(x >= SSD1306_WIDTH || y >= SSD1306_HEIGHT)
+    {
+        return SSD1306_COLOR_BLACK;
+    }
+
+    if(ssd1306_data.orientation_v)
+    {
+        x = SSD1306_WIDTH - x - 1;
+    }
+    if(ssd1306_data.orientation_h)
+    {
+        y = SSD1306_HEIGHT - y - 1;
+    }
+    if(ssd1306_layer[x + (y / 8) * SSD1306_WIDTH] & (1 << (y % 8)))
+    {
+        c = SSD1306_COLOR_WHITE;
+    }
+
+    return c;
+}
+
+void ssd1306_get_stats(ssd1306_stats_t *stats)
+{
+    memcpy(stats, &ssd1306_stats, sizeof(ssd1306_stats_t));
+
+    return;
+}
+
+void ssd1306_reset_stats(void)
+{
+    memset(&ssd1306_stats, 0, sizeof(ssd1306_stats_t));
 
     return;
 }
@@ -693,12 +958,14 @@ static void ssd1306_write_cmd(uint8_t command)
 #if SSD1306_DRV_MODE
     i2c_write_reg((SSD1306_I2C_ADDR >> 1), 0x00, command);
 #else
-    gpio_output_high(GPIO_ID_DISPLAY_SELECT);
-    gpio_output_low(GPIO_ID_DISPLAY_DC);
-    gpio_output_low(GPIO_ID_DISPLAY_SELECT);
+    GPIO_OUTPUT_HIGH(GPIO_ID_DISPLAY_SELECT);
+    GPIO_OUTPUT_LOW(GPIO_ID_DISPLAY_DC);
+    GPIO_OUTPUT_LOW(GPIO_ID_DISPLAY_SELECT);
     ssp_0_write_buffer(&command, 1);
-    gpio_output_high(GPIO_ID_DISPLAY_SELECT);
+    GPIO_OUTPUT_HIGH(GPIO_ID_DISPLAY_SELECT);
 #endif
+    SSD1306_STATS_ADD(cmd_bytes, 1);
+    SSD1306_STATS_ADD(transactions, 1);
 
     return;
 }
@@ -708,12 +975,14 @@ static void ssd1306_write_cmds(uint8_t *commands, uint8_t count)
 #if SSD1306_DRV_MODE
     i2c_write_reg_multi((SSD1306_I2C_ADDR >> 1), 0x00, commands, count);
 #else
-    gpio_output_high(GPIO_ID_DISPLAY_SELECT);
-    gpio_output_low(GPIO_ID_DISPLAY_DC);
-    gpio_output_low(GPIO_ID_DISPLAY_SELECT);
+    GPIO_OUTPUT_HIGH(GPIO_ID_DISPLAY_SELECT);
+    GPIO_OUTPUT_LOW(GPIO_ID_DISPLAY_DC);
+    GPIO_OUTPUT_LOW(GPIO_ID_DISPLAY_SELECT);
     ssp_0_write_buffer(commands, count);
-    gpio_output_high(GPIO_ID_DISPLAY_SELECT);
+    GPIO_OUTPUT_HIGH(GPIO_ID_DISPLAY_SELECT);
 #endif
+    SSD1306_STATS_ADD(cmd_bytes, count);
+    SSD1306_STATS_ADD(transactions, 1);
 
     return;
 }
@@ -723,12 +992,93 @@ static void ssd1306_write_data(uint8_t *data, uint16_t size)
 #if SSD1306_DRV_MODE
     i2c_write_reg_multi((SSD1306_I2C_ADDR >> 1), 0x40, data, size);
 #else
-    gpio_output_high(GPIO_ID_DISPLAY_SELECT);
-    gpio_output_high(GPIO_ID_DISPLAY_DC);
-    gpio_output_low(GPIO_ID_DISPLAY_SELECT);
+    GPIO_OUTPUT_HIGH(GPIO_ID_DISPLAY_SELECT);
+    GPIO_OUTPUT_HIGH(GPIO_ID_DISPLAY_DC);
+    GPIO_OUTPUT_LOW(GPIO_ID_DISPLAY_SELECT);
     ssp_0_write_buffer(data, size);
-    gpio_output_high(GPIO_ID_DISPLAY_SELECT);
+    GPIO_OUTPUT_HIGH(GPIO_ID_DISPLAY_SELECT);
 #endif
+    SSD1306_STATS_ADD(data_bytes, size);
+    SSD1306_STATS_ADD(transactions, 1);
+
+    return;
+}
+
+static void ssd1306_mark_dirty(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+    uint8_t page = 0;
+
+    if(x >= SSD1306_WIDTH || y >= SSD1306_HEIGHT || w == 0 || h == 0)
+    {
+        return;
+    }
+    if((x + w) > SSD1306_WIDTH)
+    {
+        w = SSD1306_WIDTH - x;
+    }
+    if((y + h) > SSD1306_HEIGHT)
+    {
+        h = SSD1306_HEIGHT - y;
+    }
+
+    for(page = y / 8; page <= (y + h - 1) / 8; page++)
+    {
+        if(ssd1306_dirty_x1[page] < ssd1306_dirty_x0[page])
+        {
+            ssd1306_dirty_x0[page] = x;
+            ssd1306_dirty_x1[page] = x + w - 1;
+        }
+        else
+        {
+            ssd1306_dirty_x0[page] = MIN(ssd1306_dirty_x0[page], x);
+            ssd1306_dirty_x1[page] = MAX(ssd1306_dirty_x1[page], x + w - 1);
+        }
+    }
 
     return;
 }
+
+static uint8_t ssd1306_overlay_page_mask(uint8_t page)
+{
+    uint16_t top = page * 8;
+    uint16_t bottom = top + 7;
+
+    if(!ssd1306_data.overlay)
+    {
+        return 0;
+    }
+    if(ssd1306_data.overlay_y > bottom || (ssd1306_data.overlay_y + ssd1306_data.overlay_h - 1) < top)
+    {
+        return 0;
+    }
+    top = MAX(top, ssd1306_data.overlay_y) - page * 8;
+    bottom = MIN(bottom, ssd1306_data.overlay_y + ssd1306_data.overlay_h - 1) - page * 8;
+
+    return (uint8_t)((0xFF << top) & (0xFF >> (7 - bottom)));
+}
+
+static uint8_t *ssd1306_page_data(uint8_t page, uint16_t x0, uint16_t x1, uint8_t *out)
+{
+    uint16_t x = 0;
+    uint8_t mask = ssd1306_overlay_page_mask(page);
+    uint8_t *base = &ssd1306_buffer[SSD1306_WIDTH * page];
+    uint8_t *overlay = &ssd1306_overlay_buffer[SSD1306_WIDTH * page];
+
+    /* Overlay does not cover requested columns */
+    if(!mask || x1 < ssd1306_data.overlay_x || x0 >= (ssd1306_data.overlay_x + ssd1306_data.overlay_w))
+    {
+        return &base[x0];
+    }
+
+    /* Merge overlay into page */
+    for(x = x0; x <= x1; x++)
+    {
+        out[x - x0] = base[x];
+        if(x >= ssd1306_data.overlay_x && x < (ssd1306_data.overlay_x + ssd1306_data.overlay_w))
+        {
+            out[x - x0] = (base[x] & ~mask) | (overlay[x] & mask);
+        }
+    }
+
+    return out;
+}
@@ -49,8 +49,26 @@ extern "C" {
 #define SSD1306_HEIGHT          64
 #endif
 
+/** Memory addressing mode: 0 - page addressing (SH1106 compatible), 1 - horizontal addressing (SSD1306 only). */
+#ifndef SSD1306_ADDR_MODE
+#define SSD1306_ADDR_MODE       0
+#endif
+
+/** Column offset of visible area in display RAM (2 for SH1106 compatible 132 column controllers). */
+#ifndef SSD1306_COLUMN_OFFSET
+#if SSD1306_ADDR_MODE
+#define SSD1306_COLUMN_OFFSET   0
+#else
+#define SSD1306_COLUMN_OFFSET   2
+#endif
+#endif
+
 #define SSD1306_DRV_MODE        0 //!< Driver mode: 0 - SPI, 1 - I2C
 
+#ifndef SSD1306_STATS
+#define SSD1306_STATS           1 //!< Render statistics: 0 - disabled, 1 - enabled.
+#endif
+
 /**********************************************************************************************************************
  * Exported types
  *********************************************************************************************************************/
@@ -63,6 +81,29 @@ typedef enum
     SSD1306_COLOR_WHITE = 0x00, /*!< Pixel is set. Color depends on display */
 } ssd1306_color_t;
 
+/**
+ * @brief  SSD1306 drawing layer enumeration.
+ */
+typedef enum
+{
+    SSD1306_LAYER_BASE = 0,     /*!< Base layer, menus are drawn here. */
+    SSD1306_LAYER_OVERLAY,      /*!< Overlay layer, shown on top of base layer inside overlay window. */
+} ssd1306_layer_t;
+
+/**
+ * @brief   SSD1306 render statistics.
+ */
+typedef struct
+{
+    uint32_t pixels;        //!< Pixels drawn to internal RAM.
+    uint32_t updates;       //!< Screen updates count.
+    uint32_t pages;         //!< Pages transmitted to display.
+    uint32_t data_bytes;    //!< Data bytes sent to display.
+    uint32_t cmd_bytes;     //!< Command bytes sent to display.
+    uint32_t transactions;  //!< Bus transactions (chip select frames) count.
+    uint32_t update_time;   //!< Total time spent in screen updates in system timer ticks.
+} ssd1306_stats_t;
+
 /**********************************************************************************************************************
  * Prototypes of exported constants
  *********************************************************************************************************************/
@@ -127,14 +168,42 @@ void ss1306_orientation_flip_v(void);
 void ssd1306_set_contrast(uint8_t contrast);
 
 /**
- * @brief   Updates buffer from internal RAM to display.
+ * @brief   Updates buffer from internal RAM to display. Base and overlay layers are merged and only changed areas
+ *          of pages are transmitted. In horizontal addressing mode changed area is sent as single window with one
+ *          command preamble and one data burst.
  *
  * @note    This function must be called each time you do some changes to display, to update buffer from RAM to display.
  */
 void ssd1306_update_screen(void);
 
 /**
- * @brief   Fills entire LCD with desired color
+ * @brief   Select layer used by drawing functions.
+ *
+ * @param   layer   Layer to draw to. See @ref ssd1306_layer_t.
+ */
+void ssd1306_set_layer(ssd1306_layer_t layer);
+
+/**
+ * @brief   Show overlay layer inside window. Base layer is hidden under window.
+ *
+ * @note    @ref ssd1306_update_screen() must be called after that in order to see updated display.
+ *
+ * @param   x   Window top left X point.
+ * @param   y   Window top left Y point.
+ * @param   w   Window width in units of pixels.
+ * @param   h   Window height in units of pixels.
+ */
+void ssd1306_overlay_show(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+
+/**
+ * @brief   Hide overlay layer. Only area under overlay window is restored from base layer.
+ *
+ * @note    @ref ssd1306_update_screen() must be called after that in order to see updated display.
+ */
+void ssd1306_overlay_hide(void);
+
+/**
+ * @brief   Fills entire active layer with desired color
  *
  * @note    @ref ssd1306_update_screen() must be called after that in order to see updated display.
  *
@@ -153,6 +222,30 @@ void ssd1306_fill(ssd1306_color_t color);
  */
 void ssd1306_draw_pixel(uint16_t x, uint16_t y, ssd1306_color_t c);
 
+/**
+ * @brief   Get pixel color from internal RAM.
+ *
+ * @param   x   X location. This parameter can be a value between 0 and SSD1306_WIDTH - 1.
+ * @param   y   Y location. This parameter can be a value between 0 and SSD1306_HEIGHT - 1.
+ *
+ * @return  Pixel color. See @ref ssd1306_color_t. Out of range pixels are black.
+ */
+ssd1306_color_t ssd1306_get_pixel(uint16_t x, uint16_t y);
+
+/**
+ * @brief   Get render statistics.
+ *
+ * @note    All zeros if @ref SSD1306_STATS is disabled.
+ *
+ * @param   stats   Pointer where to store statistics. See @ref ssd1306_stats_t.
+ */
+void ssd1306_get_stats(ssd1306_stats_t *stats);
+
+/**
+ * @brief   Reset render statistics.
+ */
+void ssd1306_reset_stats(void);
+
 /**
  * @brief   Sets cursor pointer to desired location for strings.
  *
@@ -26,6 +26,8 @@
 #include "periph/ssp.h"
 #include "periph/gpio.h"
 
+#include "chip.h"
+
 
 /**********************************************************************************************************************
  * Private definitions and macros
@@ -146,10 +148,10 @@
 #define NRF24L01_NOP_MASK                   0xFF
 
 /** Pins configuration */
-#define NRF24L01_CE_LOW                         gpio_output_low(GPIO_ID_NRF24L01_CE)
-#define NRF24L01_CE_HIGH                        gpio_output_high(GPIO_ID_NRF24L01_CE)
-#define NRF24L01_CSN_LOW                        gpio_output_low(GPIO_ID_NRF24L01_CSN)
-#define NRF24L01_CSN_HIGH                       gpio_output_high(GPIO_ID_NRF24L01_CSN)
+#define NRF24L01_CE_LOW                         GPIO_OUTPUT_LOW(GPIO_ID_NRF24L01_CE)
+#define NRF24L01_CE_HIGH                        GPIO_OUTPUT_HIGH(GPIO_ID_NRF24L01_CE)
+#define NRF24L01_CSN_LOW                        GPIO_OUTPUT_LOW(GPIO_ID_NRF24L01_CSN)
+#define NRF24L01_CSN_HIGH                       GPIO_OUTPUT_HIGH(GPIO_ID_NRF24L01_CSN)
 /** SPI configuration */
 #define NRF24L01_SPI_SEND_BYTE(BYTE)            ssp_1_send_byte(BYTE)
 #define NRF24L01_SPI_SEND_BUFFER(BUFFER, SIZE)  ssp_1_send_buffer(BUFFER, SIZE)
@@ -162,6 +164,13 @@
 /** Gets interrupt status from device */
 #define NRF24L01_GET_INTERRUPTS     nrf24l01_get_status()
 
+#if NRF24L01_BENCH
+#define NRF24L01_BENCH_RUNS         16  //!< Runs of each benchmarked access, minimum is reported.
+
+/** SysTick cycles elapsed from start value. SysTick counts down from LOAD. */
+#define NRF24L01_BENCH_CYCLES(start)    (((start) - SysTick->VAL) % (SysTick->LOAD + 1))
+#endif
+
 /** Flush TX FIFO. */
 #define NRF24L01_FLUSH_TX           do { NRF24L01_CSN_LOW; NRF24L01_SPI_SEND_BYTE(NRF24L01_FLUSH_TX_MASK); NRF24L01_CSN_HIGH; } while (0)
 /** Flush RX FIFO. */
@@ -453,6 +462,62 @@ uint8_t nrf24l01_get_status(void)
     return status;
 }
 
+#if NRF24L01_BENCH
+void nrf24l01_bench(nrf24l01_bench_t *result)
+{
+    uint32_t cycles[4] = {0};
+    uint32_t start = 0;
+    uint32_t value = 0;
+    uint8_t run = 0;
+    uint8_t i = 0;
+
+    for(i = 0; i < 4; i++)
+    {
+        cycles[i] = UINT32_MAX;
+    }
+    // Both SysTick reads are the same code in each run, their cost is included equally.
+    for(run = 0; run < NRF24L01_BENCH_RUNS; run++)
+    {
+        __disable_irq();
+        start = SysTick->VAL;
+        gpio_output_low(GPIO_ID_NRF24L01_CSN);
+        gpio_output_high(GPIO_ID_NRF24L01_CSN);
+        value = NRF24L01_BENCH_CYCLES(start);
+        cycles[0] = value < cycles[0] ? value : cycles[0];
+
+        start = SysTick->VAL;
+        NRF24L01_CSN_LOW;
+        NRF24L01_CSN_HIGH;
+        value = NRF24L01_BENCH_CYCLES(start);
+        cycles[1] = value < cycles[1] ? value : cycles[1];
+
+        start = SysTick->VAL;
+        gpio_output_low(GPIO_ID_NRF24L01_CSN);
+        NRF24L01_SPI_SEND_BYTE(NRF24L01_READ_REGISTER_MASK(NRF24L01_REG_STATUS));
+        NRF24L01_SPI_RECV_BYTE();
+        gpio_output_high(GPIO_ID_NRF24L01_CSN);
+        value = NRF24L01_BENCH_CYCLES(start);
+        cycles[2] = value < cycles[2] ? value : cycles[2];
+
+        start = SysTick->VAL;
+        NRF24L01_CSN_LOW;
+        NRF24L01_SPI_SEND_BYTE(NRF24L01_READ_REGISTER_MASK(NRF24L01_REG_STATUS));
+        NRF24L01_SPI_RECV_BYTE();
+        NRF24L01_CSN_HIGH;
+        value = NRF24L01_BENCH_CYCLES(start);
+        cycles[3] = value < cycles[3] ? value : cycles[3];
+        __enable_irq();
+    }
+
+    result->csn_call = cycles[0];
+    result->csn_direct = cycles[1];
+    result->read_call = cycles[2];
+    result->read_direct = cycles[3];
+
+    return;
+}
+#endif
+
 /**********************************************************************************************************************
  * Private functions
  *********************************************************************************************************************/
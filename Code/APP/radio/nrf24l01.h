@@ -52,6 +52,10 @@ extern "C" {
 #define NRF24L01_MAX_PAYLOAD    32      //!< Maximum payload in bytes.
 #define NRF24L01_MAX_RTR        15      //!< Maximum retransmissions count.
 
+#ifndef NRF24L01_BENCH
+#define NRF24L01_BENCH          0       //!< 1 - build register access cycle count benchmark, see @ref nrf24l01_bench.
+#endif
+
 /**********************************************************************************************************************
  * Exported types
  *********************************************************************************************************************/
@@ -97,6 +101,19 @@ typedef struct
     nrf24l01_data_rate_t data_rate; //!< Data rate, see @ref nrf24l01_data_rate_t.
 } nrf24l01_cfg_t;
 
+#if NRF24L01_BENCH
+/**
+ * @brief   Register access benchmark result, SysTick cycles, minimum of all runs.
+ */
+typedef struct
+{
+    uint32_t csn_call;      //!< CSN low and high through GPIO table functions.
+    uint32_t csn_direct;    //!< CSN low and high through compile time SET/CLR stores.
+    uint32_t read_call;     //!< STATUS register read framed through GPIO table functions.
+    uint32_t read_direct;   //!< STATUS register read framed through compile time SET/CLR stores.
+} nrf24l01_bench_t;
+#endif
+
 /**********************************************************************************************************************
  * Prototypes of exported constants
  *********************************************************************************************************************/
@@ -231,6 +248,17 @@ void nrf24l01_set_rf(nrf24l01_data_rate_t data_rate, nrf24l01_tx_power_t tx_powe
  */
 uint8_t nrf24l01_get_status(void);
 
+#if NRF24L01_BENCH
+/**
+ * @brief   Measure CSN framed register access in SysTick cycles, framing through GPIO table functions (before pins
+ *          were bound at compile time) and through SET/CLR stores. Interrupts are disabled during each run, SysTick
+ *          must be running. SPI is used, call from radio thread only.
+ *
+ * @param   result  Pointer where to store result.
+ */
+void nrf24l01_bench(nrf24l01_bench_t *result);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -28,10 +28,14 @@
 #include "radio/radio.h"
 #include "radio/nrf24l01.h"
 
+#include "cli/cli.h"
 #include "cmsis_os2.h"
 #include "debug.h"
+#include "seqlock.h"
 
 #include "app.h"
+#include "telemetry.h"
+#include "display/display.h"
 #include "sensors/sensors.h"
 
 /**********************************************************************************************************************
@@ -43,6 +47,7 @@
 #define RADIO_RECEIVE_TMO_MS        50      //!< Radio data receive timeout in milliseconds.
 #define RADIO_COMM_PERIOD_MS        1000    //!< Radio communication period in milliseconds.
 #define RADIO_CONNECT_COUNT         4       //!< Connect/Disconnect count limit.
+#define RADIO_LOG_PERIOD_MS         5000    //!< Minimal period between repeated radio failure logs in milliseconds.
 
 #define RADIO_MODE_1_WAY            0                   //!< One way (without response) communication.
 #define RADIO_MODE_2_WAY            1                   //!< Two way (with response) communication.
@@ -72,7 +77,8 @@ typedef struct __attribute__((packed))
     uint8_t mode;
     int16_t magnitude;
     int16_t direction;
-    uint8_t reserved[25];
+    int16_t channels[MIXER_OUTPUT_LAST];
+    uint8_t reserved[25 - MIXER_OUTPUT_LAST * sizeof(int16_t)];
 } radio_packet_control_t;
 
 
@@ -116,8 +122,10 @@ const uint8_t radio_peer_address[NRF24L01_ADDRESS_SIZE] = {0xDE, 0xAD, 0xBE, 0xA
  *********************************************************************************************************************/
 /** Radio thread ID. */
 osThreadId_t radio_thread_id;
-/** Radio data structure. */
-volatile radio_data_t radio_data = {0};
+/** Radio data structure, owned by radio thread. */
+static radio_data_t radio_data = {0};
+/** Radio data, published to readers. */
+static SEQLOCK_OBJECT(radio_data_t) radio_data_pub;
 /** Radio data buffer. */
 static uint8_t radio_data_buffer[RADIO_PAYLAOD_SIZE] = {0};
 /** Radio sequence. */
@@ -188,6 +196,11 @@ static void radio_quality_check(void);
  */
 static void radio_connect_control(bool packet_state);
 
+/**
+ * @brief   CLI command "radio" callback. See @ref cli_cmd_callback.
+ */
+static bool radio_cmd_cb(uint8_t *data, uint32_t size, const uint8_t *cmd);
+
 /**********************************************************************************************************************
  * Exported functions
  *********************************************************************************************************************/
@@ -217,10 +230,18 @@ bool radio_init(void)
 void radio_thread(void *arguments)
 {
     bool ret = false;
+#if NRF24L01_BENCH
+    nrf24l01_bench_t bench;
+#endif
 
     nrf24l01_init(&radio_config);
     nrf24l01_set_my_address((uint8_t *)radio_my_address);
     nrf24l01_set_tx_address((uint8_t *)radio_peer_address);
+#if NRF24L01_BENCH
+    nrf24l01_bench(&bench);
+    DEBUG_RADIO("CSN cycles: call %d, direct %d. Register read cycles: call %d, direct %d.",
+                bench.csn_call, bench.csn_direct, bench.read_call, bench.read_direct);
+#endif
 
     while(1)
     {
@@ -233,10 +254,17 @@ void radio_thread(void *arguments)
         ret = radio_transmit_handler();
 #endif
         radio_connect_control(ret);
+        SEQLOCK_PUBLISH(radio_data_pub, &radio_data);
+        display_refresh();
         osDelay(RADIO_COMM_PERIOD_MS);
     }
 }
 
+uint32_t radio_get_data(radio_data_t *data)
+{
+    return SEQLOCK_SNAPSHOT(radio_data_pub, data);
+}
+
 /**********************************************************************************************************************
  * Private functions
  *********************************************************************************************************************/
@@ -267,23 +295,23 @@ static bool radio_transmit_handler(void)
     switch(status)
     {
         case NRF24L01_TX_STATUS_OK:
-            DEBUG_RADIO("Transmit: OK (%d ms., %d/%d, %d %%).", (RADIO_TRANSMIT_TMO_MS - c),
-                        radio_data.rtr_current, radio_data.rtr, radio_data.quality);
+            DEBUG_LOG(RADIO, VERBOSE, "Transmit: OK (%d ms., %d/%d, %d %%).", (RADIO_TRANSMIT_TMO_MS - c),
+                      radio_data.rtr_current, radio_data.rtr, radio_data.quality);
             break;
         case NRF24L01_TX_STATUS_LOST:
-            DEBUG_RADIO("Transmit: LOST (%d/%d, %d %%).",
-                        radio_data.rtr_current, radio_data.rtr, radio_data.quality);
+            DEBUG_LOG_RATE(RADIO, WARNING, RADIO_LOG_PERIOD_MS, "Transmit: LOST (%d/%d, %d %%).",
+                           radio_data.rtr_current, radio_data.rtr, radio_data.quality);
             radio_data.tx_lost_counter++;
             break;
         case NRF24L01_TX_STATUS_SENDING:
-            DEBUG_RADIO("Transmit: SENDING (%d/%d, %d %%).",
-                        radio_data.rtr_current, radio_data.rtr, radio_data.quality);
+            DEBUG_LOG_RATE(RADIO, WARNING, RADIO_LOG_PERIOD_MS, "Transmit: SENDING (%d/%d, %d %%).",
+                           radio_data.rtr_current, radio_data.rtr, radio_data.quality);
             radio_data.tx_lost_counter++;
             break;
         default:
-            DEBUG_RADIO("Transmit: ERROR 0x%02X (%d/%d, %d %%).",
-                        status,
-                        radio_data.rtr_current, radio_data.rtr, radio_data.quality);
+            DEBUG_LOG_RATE(RADIO, ERROR, RADIO_LOG_PERIOD_MS, "Transmit: ERROR 0x%02X (%d/%d, %d %%).",
+                           status,
+                           radio_data.rtr_current, radio_data.rtr, radio_data.quality);
             radio_data.tx_lost_counter++;
             break;
     }
@@ -294,20 +322,25 @@ static bool radio_transmit_handler(void)
 static bool radio_transmit_packet_builder(uint8_t *packet, uint8_t size)
 {
     radio_packet_control_t *cntrl = (radio_packet_control_t *)packet;
+    sensors_data_t sensors;
+    uint8_t i = 0;
 
     if(cntrl == NULL || packet == NULL || size ==0)
     {
         return false;
     }
 
-    __disable_irq();
+    sensors_get_data(&sensors);
     radio_sequence++;
     cntrl->preamble = RADIO_PACKET_PREAMBLE;
     cntrl->sequence = radio_sequence;
     cntrl->mode = app_rc_mode_get();
-    cntrl->magnitude = (int16_t)sensors_data.joystick_1.magnitude;
-    cntrl->direction = (int16_t)sensors_data.joystick_1.direction;
-    __enable_irq();
+    cntrl->magnitude = (int16_t)sensors.joystick_1.magnitude;
+    cntrl->direction = (int16_t)sensors.joystick_1.direction;
+    for(i = 0; i < MIXER_OUTPUT_LAST; i++)
+    {
+        cntrl->channels[i] = sensors.channels[i];
+    }
 
     return true;
 }
@@ -324,8 +357,13 @@ static bool radio_receive_handler(void)
         if(nrf24l01_data_ready())
         {
             nrf24l01_get_data(radio_data_buffer);
-            DEBUG_RADIO("Received data (%d ms.):", (RADIO_RECEIVE_TMO_MS - c));
-            debug_send_hex_os(radio_data_buffer, RADIO_PAYLAOD_SIZE);
+            DEBUG_LOG(RADIO, VERBOSE, "Received data (%d ms.):", (RADIO_RECEIVE_TMO_MS - c));
+#if DEBUG_LEVEL_MAX >= DEBUG_LEVEL_VERBOSE
+            if(debug_levels[DEBUG_MODULE_RADIO] >= DEBUG_LEVEL_VERBOSE)
+            {
+                debug_send_hex_os(radio_data_buffer, RADIO_PAYLAOD_SIZE);
+            }
+#endif
             if(radio_receive_packet_parser(radio_data_buffer, RADIO_PAYLAOD_SIZE) == true)
             {
                 radio_data.rx_counter++;
@@ -333,7 +371,7 @@ static bool radio_receive_handler(void)
             }
         }
     }
-    DEBUG_RADIO("No response.");
+    DEBUG_LOG_RATE(RADIO, WARNING, RADIO_LOG_PERIOD_MS, "No response.");
 
     return false;
 }
@@ -402,6 +440,7 @@ static void radio_connect_control(bool packet_state)
             {
                 counter_success = 0;
                 radio_connect_state = true;
+                telemetry_event(TELEMETRY_EVENT_LINK, 1);
             }
         }
     }
@@ -412,6 +451,10 @@ static void radio_connect_control(bool packet_state)
         if(counter_failed > RADIO_CONNECT_COUNT)
         {
             counter_failed = 0;
+            if(radio_connect_state == true)
+            {
+                telemetry_event(TELEMETRY_EVENT_LINK, 0);
+            }
             radio_connect_state = false;
         }
     }
@@ -419,3 +462,18 @@ static void radio_connect_control(bool packet_state)
     return;
 }
 
+static bool radio_cmd_cb(uint8_t *data, uint32_t size, const uint8_t *cmd)
+{
+    radio_data_t stats = {0};
+
+    radio_get_data(&stats);
+    DEBUG_CLI("# Radio stats:");
+    DEBUG_CLI("Connected ..... %s", radio_connect_state ? "yes" : "no");
+    DEBUG_CLI("Transmitted ... %d", stats.tx_counter);
+    DEBUG_CLI("Lost .......... %d", stats.tx_lost_counter);
+    DEBUG_CLI("Received ...... %d", stats.rx_counter);
+    DEBUG_CLI("Retransmits ... %d/%d (%d %%).", stats.rtr_current, stats.rtr, stats.quality);
+
+    return false;
+}
+CLI_CMD_REGISTER(radio, "radio     Radio link statistics.", radio_cmd_cb, 0);
@@ -78,6 +78,15 @@ bool radio_init(void);
  */
 void radio_thread(void *arguments);
 
+/**
+ * @brief   Get consistent snapshot of radio statistics. Does not block and does not mask interrupts.
+ *
+ * @param   data    Pointer where to store radio data.
+ *
+ * @return  Publication sequence number, 0 - no data yet.
+ */
+uint32_t radio_get_data(radio_data_t *data);
+
 #ifdef __cplusplus
 }
 #endif
@@ -24,13 +24,37 @@
 
 #include "filters.h"
 
+#if FILTERS_BENCH
+#include "chip.h"
+#include "cmsis_os2.h"
+#endif
+
 /**********************************************************************************************************************
  * Private definitions and macros
  *********************************************************************************************************************/
+#if FILTERS_BENCH
+#define FILTERS_BENCH_SAMPLES   256     //!< Samples processed by each benchmarked filter.
+#endif
 
 /**********************************************************************************************************************
  * Private typedef
  *********************************************************************************************************************/
+#if FILTERS_BENCH
+/**
+ * @brief   Double precision filters state, implementation used before fixed point. Benchmark reference only.
+ */
+typedef struct
+{
+    double lp;              //!< Low pass output.
+    double hp;              //!< High pass output.
+    double kalman;          //!< Kalman value.
+    double kalman_error;    //!< Kalman estimation error covariance.
+    double b[3];            //!< Biquad feed forward coefficients.
+    double a[2];            //!< Biquad feedback coefficients.
+    double x[2];            //!< Biquad delayed inputs.
+    double y[2];            //!< Biquad delayed outputs.
+} filters_bench_double_t;
+#endif
 
 /**********************************************************************************************************************
  * Private constants
@@ -47,6 +71,37 @@
 /**********************************************************************************************************************
  * Prototypes of local functions
  *********************************************************************************************************************/
+/**
+ * @brief   Saturate 64 bit intermediate result to Q16.16 range.
+ *
+ * @param   value   Value to saturate.
+ *
+ * @return  Saturated value.
+ */
+static filters_q16_t filters_q16_sat(int64_t value);
+
+/**
+ * @brief   Multiply two Q16.16 values with saturation.
+ *
+ * @param   a   First value.
+ * @param   b   Second value.
+ *
+ * @return  Saturated product.
+ */
+static filters_q16_t filters_q16_mul(filters_q16_t a, filters_q16_t b);
+
+#if FILTERS_BENCH
+/**
+ * @brief   Run one double precision filter, as implemented before fixed point.
+ *
+ * @param   data    Filters state.
+ * @param   type    Filter, order of @ref FILTERS_BENCH_FILTERS.
+ * @param   input   Input value.
+ *
+ * @return  Filter output.
+ */
+static double filters_bench_double(filters_bench_double_t *data, uint8_t type, double input);
+#endif
 
 /**********************************************************************************************************************
  * Exported functions
@@ -55,9 +110,10 @@
 /**********************************************************************************************************************
  * Private functions
  *********************************************************************************************************************/
-filters_kalman_t filters_kalman_init(double proc_noise_cov, double meas_noise_cov, double est_error, double value)
+filters_kalman_q16_t filters_kalman_q16_init(filters_q16_t proc_noise_cov, filters_q16_t meas_noise_cov,
+                                             filters_q16_t est_error, filters_q16_t value)
 {
-    filters_kalman_t result = {0};
+    filters_kalman_q16_t result = {0};
 
     result.process_noise_cov        = proc_noise_cov;
     result.measurement_noise_cov    = meas_noise_cov;
@@ -67,33 +123,183 @@ filters_kalman_t filters_kalman_init(double proc_noise_cov, double meas_noise_co
     return result;
 }
 
-double filters_kalman_update(filters_kalman_t *data, double input)
+filters_q16_t filters_kalman_q16_update(filters_kalman_q16_t *data, filters_q16_t input)
 {
+    int64_t sum = 0;
+
     // Prediction update. Omit x = x.
-    data->estimation_error = data->estimation_error + data->process_noise_cov;
+    data->estimation_error = filters_q16_sat((int64_t)data->estimation_error + data->process_noise_cov);
 
-    // Measurement update
-    data->gain = data->estimation_error / (data->estimation_error + data->measurement_noise_cov);
-    data->value = data->value + data->gain * (input - data->value);
-    data->estimation_error = (1 - data->gain) * data->estimation_error;
+    // Measurement update. Gain is in range 0 ... 1.0.
+    sum = (int64_t)data->estimation_error + data->measurement_noise_cov;
+    data->gain = sum > 0 ? filters_q16_sat(((int64_t)data->estimation_error << FILTERS_Q16_SHIFT) / sum) : 0;
+    data->value = filters_q16_sat((int64_t)data->value +
+                                  filters_q16_mul(data->gain, filters_q16_sat((int64_t)input - data->value)));
+    data->estimation_error = filters_q16_mul(FILTERS_Q16_ONE - data->gain, data->estimation_error);
 
     return data->value;
 }
 
-double filters_low_pass(filters_low_pass_t *data, double input, double cut_off)
+filters_q16_t filters_low_pass_q16(filters_low_pass_q16_t *data, filters_q16_t input, filters_q16_t cut_off)
 {
     data->input = input;
     data->cut_off = cut_off;
-    data->output = data->output + (data->cut_off * (data->input - data->output));
+    data->output = filters_q16_sat((int64_t)data->output +
+                                   filters_q16_mul(data->cut_off, filters_q16_sat((int64_t)data->input - data->output)));
 
     return data->output;
 }
 
-double filters_high_pass(filters_high_pass_t *data, double input, double cut_off)
+filters_q16_t filters_high_pass_q16(filters_high_pass_q16_t *data, filters_q16_t input, filters_q16_t cut_off)
 {
     data->input = input;
     data->cut_off = cut_off;
-    data->output = data->input - (data->output + data->cut_off * (data->input - data->output));
+    data->output = filters_q16_sat((int64_t)data->input - data->output -
+                                   filters_q16_mul(data->cut_off, filters_q16_sat((int64_t)data->input - data->output)));
 
     return data->output;
 }
+
+filters_q16_t filters_biquad_q16(filters_biquad_q16_t *data, filters_q16_t input)
+{
+    int64_t acc = 0;
+    filters_q16_t output = 0;
+
+    acc = (int64_t)data->b0 * input + (int64_t)data->b1 * data->x1 + (int64_t)data->b2 * data->x2 -
+          (int64_t)data->a1 * data->y1 - (int64_t)data->a2 * data->y2;
+    output = filters_q16_sat(acc >> FILTERS_Q16_SHIFT);
+
+    data->x2 = data->x1;
+    data->x1 = input;
+    data->y2 = data->y1;
+    data->y1 = output;
+
+    return output;
+}
+
+static filters_q16_t filters_q16_sat(int64_t value)
+{
+    if(value > INT32_MAX)
+    {
+        return INT32_MAX;
+    }
+    if(value < INT32_MIN)
+    {
+        return INT32_MIN;
+    }
+
+    return (filters_q16_t)value;
+}
+
+#if FILTERS_BENCH
+void filters_bench(filters_bench_t *result)
+{
+    filters_bench_double_t ref = {0};
+    filters_low_pass_q16_t lp = {0};
+    filters_high_pass_q16_t hp = {0};
+    filters_kalman_q16_t kalman = {0};
+    filters_biquad_q16_t biquad = {0};
+    volatile double out_double = 0;
+    volatile filters_q16_t out_q16 = 0;
+    uint32_t overhead = 0;
+    uint32_t start = 0;
+    uint32_t seed = 0;
+    uint32_t err = 0;
+    uint32_t i = 0;
+    int32_t input = 0;
+    uint8_t type = 0;
+
+    // Timer read overhead.
+    __disable_irq();
+    start = osKernelGetSysTimerCount();
+    overhead = osKernelGetSysTimerCount() - start;
+    __enable_irq();
+
+    for(type = 0; type < FILTERS_BENCH_FILTERS; type++)
+    {
+        // Same coefficients for both implementations: 2nd order low pass biquad, fc = fs / 10.
+        kalman = filters_kalman_q16_init(FILTERS_Q16(0.01), FILTERS_Q16(1.0), FILTERS_Q16(1.0), 0);
+        biquad = (filters_biquad_q16_t){.b0 = FILTERS_Q16(0.0675), .b1 = FILTERS_Q16(0.1349),
+                                        .b2 = FILTERS_Q16(0.0675), .a1 = FILTERS_Q16(-1.1430),
+                                        .a2 = FILTERS_Q16(0.4128)};
+        ref = (filters_bench_double_t){.kalman_error = 1.0,
+                                       .b = {(double)biquad.b0 / FILTERS_Q16_ONE, (double)biquad.b1 / FILTERS_Q16_ONE,
+                                             (double)biquad.b2 / FILTERS_Q16_ONE},
+                                       .a = {(double)biquad.a1 / FILTERS_Q16_ONE, (double)biquad.a2 / FILTERS_Q16_ONE}};
+        lp = (filters_low_pass_q16_t){0};
+        hp = (filters_high_pass_q16_t){0};
+        result->cycles_double[type] = 0;
+        result->cycles_q16[type] = 0;
+        result->err_max[type] = 0;
+        seed = 1;
+
+        for(i = 0; i < FILTERS_BENCH_SAMPLES; i++)
+        {
+            seed = (seed * 1103515245UL) + 12345UL;
+            input = (int32_t)((seed >> 16) & 0x0FFF);
+
+            __disable_irq();
+            start = osKernelGetSysTimerCount();
+            out_double = filters_bench_double(&ref, type, input);
+            result->cycles_double[type] += osKernelGetSysTimerCount() - start - overhead;
+
+            start = osKernelGetSysTimerCount();
+            switch(type)
+            {
+                case 0:  out_q16 = filters_low_pass_q16(&lp, FILTERS_Q16_FROM_INT(input), FILTERS_Q16(0.5));   break;
+                case 1:  out_q16 = filters_high_pass_q16(&hp, FILTERS_Q16_FROM_INT(input), FILTERS_Q16(0.25)); break;
+                case 2:  out_q16 = filters_kalman_q16_update(&kalman, FILTERS_Q16_FROM_INT(input));            break;
+                default: out_q16 = filters_biquad_q16(&biquad, FILTERS_Q16_FROM_INT(input));                   break;
+            }
+            result->cycles_q16[type] += osKernelGetSysTimerCount() - start - overhead;
+            __enable_irq();
+
+            err = (int32_t)(out_double * FILTERS_Q16_ONE) > out_q16 ?
+                  (uint32_t)((int32_t)(out_double * FILTERS_Q16_ONE) - out_q16) :
+                  (uint32_t)(out_q16 - (int32_t)(out_double * FILTERS_Q16_ONE));
+            result->err_max[type] = err > result->err_max[type] ? err : result->err_max[type];
+        }
+        result->cycles_double[type] /= FILTERS_BENCH_SAMPLES;
+        result->cycles_q16[type] /= FILTERS_BENCH_SAMPLES;
+    }
+
+    return;
+}
+#endif
+
+static filters_q16_t filters_q16_mul(filters_q16_t a, filters_q16_t b)
+{
+    return filters_q16_sat(((int64_t)a * b) >> FILTERS_Q16_SHIFT);
+}
+
+#if FILTERS_BENCH
+static double filters_bench_double(filters_bench_double_t *data, uint8_t type, double input)
+{
+    double output = 0;
+
+    switch(type)
+    {
+        case 0:
+            data->lp = data->lp + 0.5 * (input - data->lp);
+            return data->lp;
+        case 1:
+            data->hp = input - (data->hp + 0.25 * (input - data->hp));
+            return data->hp;
+        case 2:
+            // Prediction update, then measurement update.
+            data->kalman_error = data->kalman_error + 0.01;
+            output = data->kalman_error / (data->kalman_error + 1.0);
+            data->kalman = data->kalman + output * (input - data->kalman);
+            data->kalman_error = (1 - output) * data->kalman_error;
+            return data->kalman;
+        default:
+            output = data->b[0] * input + data->b[1] * data->x[0] + data->b[2] * data->x[1] -
+                     data->a[0] * data->y[0] - data->a[1] * data->y[1];
+            data->x[1] = data->x[0];
+            data->x[0] = input;
+            data->y[1] = data->y[0];
+            data->y[0] = output;
+            return output;
+    }
+}
+#endif
@@ -27,45 +27,93 @@ extern "C" {
 /**********************************************************************************************************************
  * Includes
  *********************************************************************************************************************/
+#include <stdint.h>
 
 /**********************************************************************************************************************
  * Exported definitions and macros
  *********************************************************************************************************************/
+#define FILTERS_Q16_SHIFT   16                          //!< Q16.16 fraction bits.
+#define FILTERS_Q16_ONE     (1L << FILTERS_Q16_SHIFT)   //!< Q16.16 value of 1.0.
+
+/** Convert constant to Q16.16. Use only with compile time constants. */
+#define FILTERS_Q16(x)      ((filters_q16_t)((x) * FILTERS_Q16_ONE + ((x) >= 0 ? 0.5 : -0.5)))
+/** Convert integer to Q16.16. */
+#define FILTERS_Q16_FROM_INT(x)     ((filters_q16_t)((int32_t)(x) * FILTERS_Q16_ONE))
+/** Convert Q16.16 to integer, fraction is truncated toward minus infinity. */
+#define FILTERS_Q16_TO_INT(x)       ((int32_t)((x) >> FILTERS_Q16_SHIFT))
+
+#ifndef FILTERS_BENCH
+#define FILTERS_BENCH       0       //!< 1 - build fixed point vs double cycle count benchmark, see @ref filters_bench.
+#endif
+#define FILTERS_BENCH_FILTERS   4   //!< Benchmarked filters: low pass, high pass, Kalman, biquad.
 
 /**********************************************************************************************************************
  * Exported types
  *********************************************************************************************************************/
 /**
- * @brief   Kalman filter data.
+ * @brief   Q16.16 fixed point value.
+ */
+typedef int32_t filters_q16_t;
+
+/**
+ * @brief   Fixed point Kalman filter data. All fields are Q16.16.
+ */
+typedef struct
+{
+    filters_q16_t process_noise_cov;        //!< Process noise covariance.
+    filters_q16_t measurement_noise_cov;    //!< Measurement noise covariance.
+    filters_q16_t value;                    //!< Current input value.
+    filters_q16_t estimation_error;         //!< Estimation error covariance.
+    filters_q16_t gain;                     //!< Kalman gain.
+} filters_kalman_q16_t;
+
+/**
+ * @brief   Fixed point Low Pass filter data. All fields are Q16.16.
  */
 typedef struct
 {
-    double process_noise_cov;       //!< Process noise covariance.
-    double measurement_noise_cov;   //!< Measurement noise covariance.
-    double value;                   //!< Current input value.
-    double estimation_error;        //!< Estimation error covariance.
-    double gain;                    //!< Kalman gain.
-} filters_kalman_t;
+    filters_q16_t input;    //!< Input value.
+    filters_q16_t output;   //!< Output value.
+    filters_q16_t cut_off;  //!< Filter cut off.
+} filters_low_pass_q16_t;
 
 /**
- * @brief   Low Pass filter data.
+ * @brief   Fixed point High Pass filter data. All fields are Q16.16.
  */
 typedef struct
 {
-    double input;   //!< Input value.
-    double output;  //!< Output value.
-    double cut_off; //!< Filter cut off.
-} filters_low_pass_t;
+    filters_q16_t input;    //!< Input value.
+    filters_q16_t output;   //!< Output value.
+    filters_q16_t cut_off;  //!< Filter cut off.
+} filters_high_pass_q16_t;
 
 /**
- * @brief   High Pass filter data.
+ * @brief   Fixed point biquad filter data (direct form I). All fields are Q16.16.
  */
 typedef struct
 {
-    double input;   //!< Input value.
-    double output;  //!< Output value.
-    double cut_off; //!< Filter cut off.
-} filters_high_pass_t;
+    filters_q16_t b0;   //!< Feed forward coefficient 0.
+    filters_q16_t b1;   //!< Feed forward coefficient 1.
+    filters_q16_t b2;   //!< Feed forward coefficient 2.
+    filters_q16_t a1;   //!< Feedback coefficient 1.
+    filters_q16_t a2;   //!< Feedback coefficient 2.
+    filters_q16_t x1;   //!< Input delayed by one sample.
+    filters_q16_t x2;   //!< Input delayed by two samples.
+    filters_q16_t y1;   //!< Output delayed by one sample.
+    filters_q16_t y2;   //!< Output delayed by two samples.
+} filters_biquad_q16_t;
+
+#if FILTERS_BENCH
+/**
+ * @brief   Filters benchmark result, order of @ref FILTERS_BENCH_FILTERS.
+ */
+typedef struct
+{
+    uint32_t cycles_double[FILTERS_BENCH_FILTERS];  //!< System timer cycles per call of double precision filter.
+    uint32_t cycles_q16[FILTERS_BENCH_FILTERS];     //!< System timer cycles per call of Q16.16 filter.
+    uint32_t err_max[FILTERS_BENCH_FILTERS];        //!< Maximal deviation of Q16.16 output from double, 1/65536.
+} filters_bench_t;
+#endif
 
 /**********************************************************************************************************************
  * Exported constants
@@ -79,49 +127,70 @@ typedef struct
  * Prototypes of exported functions
  *********************************************************************************************************************/
 /**
- * @brief   Initialize kalman filter.
+ * @brief   Initialize fixed point kalman filter.
  *
- * @param   proc_noise_cov  Process noise covariance.
- * @param   meas_noise_cov  Measurement noise covariance.
- * @param   est_error       Estimation error covariance.
- * @param   value           Initial value.
+ * @param   proc_noise_cov  Process noise covariance, Q16.16.
+ * @param   meas_noise_cov  Measurement noise covariance, Q16.16.
+ * @param   est_error       Estimation error covariance, Q16.16.
+ * @param   value           Initial value, Q16.16.
  *
- * @return  Initialized kalman data structure. See @ref filters_kalman_t.
+ * @return  Initialized kalman data structure. See @ref filters_kalman_q16_t.
  */
-filters_kalman_t filters_kalman_init(double proc_noise_cov, double meas_noise_cov, double est_error, double value);
+filters_kalman_q16_t filters_kalman_q16_init(filters_q16_t proc_noise_cov, filters_q16_t meas_noise_cov,
+                                             filters_q16_t est_error, filters_q16_t value);
 
 /**
- * @brief   Update kalman filter.
- * @note    Before using you must initialize kalman filter. See @ref filter_kalman_init.
+ * @brief   Update fixed point kalman filter.
  *
- * @param   data    Kalman filter data. See @ref filters_kalman_t.
- * @param   input   Input value for kalman filter.
+ * @param   data    Kalman filter data. See @ref filters_kalman_q16_t.
+ * @param   input   Input value, Q16.16.
  *
- * @return  Kalman filter output value.
+ * @return  Kalman filter output value, Q16.16.
  */
-double filters_kalman_update(filters_kalman_t *data, double input);
+filters_q16_t filters_kalman_q16_update(filters_kalman_q16_t *data, filters_q16_t input);
 
 /**
- * @brief   Low pass filter.
+ * @brief   Fixed point low pass filter.
  *
- * @param   data    Low pass filter data. See @ref filters_low_pass_t.
- * @param   input   Input data for low pass filter.
- * @param   cut_off Cut off value.
+ * @param   data    Low pass filter data. See @ref filters_low_pass_q16_t.
+ * @param   input   Input value, Q16.16.
+ * @param   cut_off Cut off value, Q16.16 (0 ... 1.0).
  *
- * @return  Output value of low pass filter.
+ * @return  Output value of low pass filter, Q16.16.
  */
-double filters_low_pass(filters_low_pass_t *data, double input, double cut_off);
+filters_q16_t filters_low_pass_q16(filters_low_pass_q16_t *data, filters_q16_t input, filters_q16_t cut_off);
 
 /**
- * @brief   High pass filter.
+ * @brief   Fixed point high pass filter.
  *
- * @param   data    High pass filter data. See @ref filters_high_pass_t.
- * @param   input   Input data for low pass filter.
- * @param   cut_off Cut off value.
+ * @param   data    High pass filter data. See @ref filters_high_pass_q16_t.
+ * @param   input   Input value, Q16.16.
+ * @param   cut_off Cut off value, Q16.16 (0 ... 1.0).
  *
- * @return  Output value of high pass filter.
+ * @return  Output value of high pass filter, Q16.16.
  */
-double filters_high_pass(filters_high_pass_t *data, double input, double cut_off);
+filters_q16_t filters_high_pass_q16(filters_high_pass_q16_t *data, filters_q16_t input, filters_q16_t cut_off);
+
+/**
+ * @brief   Fixed point biquad filter: y = b0*x + b1*x1 + b2*x2 - a1*y1 - a2*y2.
+ * @note    Coefficients must be set (normalized to a0 = 1) and delay line zeroed before use.
+ *
+ * @param   data    Biquad filter data. See @ref filters_biquad_q16_t.
+ * @param   input   Input value, Q16.16.
+ *
+ * @return  Output value of biquad filter, Q16.16.
+ */
+filters_q16_t filters_biquad_q16(filters_biquad_q16_t *data, filters_q16_t input);
+
+#if FILTERS_BENCH
+/**
+ * @brief   Measure Q16.16 filters and double precision filters they replaced in system timer cycles per call, on the
+ *          same pseudo random 12 bit input. Interrupts are disabled during each call, call from thread context.
+ *
+ * @param   result  Pointer where to store result.
+ */
+void filters_bench(filters_bench_t *result);
+#endif
 
 #ifdef __cplusplus
 }
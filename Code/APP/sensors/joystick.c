@@ -22,49 +22,137 @@
  *********************************************************************************************************************/
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
+#if JOYSTICK_BENCH
 #include <math.h>
-
+#endif
 #include "sensors/joystick.h"
 #include "sensors/filters.h"
 
 #include "periph/adc.h"
 #include "periph/gpio.h"
+#include "periph/nvm.h"
 
 #include "cmsis_os2.h"
 
 /**********************************************************************************************************************
  * Private definitions and macros
  *********************************************************************************************************************/
-#define JOYSTICK_RESOLUTION     1024
-#define JOYSTICK_ADC_RES        4096
-#define JOYSTICK_PI             3.14159265358979f
+#define JOYSTICK_ADC_RES        65536   //!< Full scale of decimated ADC values.
+#define JOYSTICK_LP_SHIFT       12      //!< Raw value to Q16.16 filter input shift, keeps 16 bit raw inside of range.
 #define JOYSTICK_CAL_COUNT      10
+#define JOYSTICK_ATAN_BITS      8       //!< Arctangent table index bits (256 intervals).
+#define JOYSTICK_DEG_SHIFT      16      //!< Fraction bits of angles in degrees.
+#define JOYSTICK_RATIO_SHIFT    20      //!< Fraction bits of octant tangent ratio.
+
+#define JOYSTICK_SPAN_MIN       2048    //!< Minimal calibrated span from center to end, keeps scaling inside of 32 bits.
+#define JOYSTICK_CURVE_SHIFT    5       //!< log2 of curve table step.
+
+#define JOYSTICK_GROW_COUNT     8       //!< Consecutive samples beyond travel before it grows, rejects outliers.
+#define JOYSTICK_REST_WINDOW    512     //!< Distance from center treated as stick at rest, ADC counts.
+#define JOYSTICK_REST_COUNT     50      //!< Samples in rest window before center tracking starts.
+#define JOYSTICK_DRIFT_SHIFT    10      //!< Center tracking time constant, log2 of samples.
+#define JOYSTICK_SAVE_DELTA     64      //!< Minimal calibration change worth EEPROM write, ADC counts.
+
+#if JOYSTICK_BENCH
+#define JOYSTICK_BENCH_GRID     16      //!< Benchmark grid step in axis units.
+#define JOYSTICK_BENCH_PI       3.14159265358979    //!< Pi for double precision reference.
+#endif
 
 #define JOYSTICK_X_INVERT       1
-#define JOYSTICK_X_OFFSET       5
-#define JOYSTICK_X_LP_CUTOF     0.5F
+#define JOYSTICK_X_LP_CUTOF     FILTERS_Q16(0.5)
 
 #define JOYSTICK_Y_INVERT       0
-#define JOYSTICK_Y_OFFSET       5
-#define JOYSTICK_Y_LP_CUTOF     0.5F
+#define JOYSTICK_Y_LP_CUTOF     FILTERS_Q16(0.5)
+
+/** Default calibration: center of ADC range and minimal travel, real range is learned from movement. */
+#define JOYSTICK_CAL_DEFAULT    {.zero = (JOYSTICK_ADC_RES / 2), \
+                                 .min = (JOYSTICK_ADC_RES / 2) - JOYSTICK_SPAN_MIN, \
+                                 .max = (JOYSTICK_ADC_RES / 2) + JOYSTICK_SPAN_MIN}
+
+/** Default response curve: linear with small dead zone (about 80 counts of 16 bit ADC). */
+#define JOYSTICK_CURVE_DEFAULT  {.deadzone = 3, .expo = 0, .rate = 100, .endpoint_pos = 100, .endpoint_neg = 100}
 
 /**********************************************************************************************************************
  * Private typedef
  *********************************************************************************************************************/
+/**
+ * @brief   Axis mapping from ADC counts to output through response curve tables.
+ */
+typedef struct
+{
+    joystick_curve_t curve;                         //!< Response curve settings.
+    uint32_t scale_pos;                             //!< Positive side counts to output scale, Q16.
+    uint32_t scale_neg;                             //!< Negative side counts to output scale, Q16.
+    int16_t lut_pos[JOYSTICK_CURVE_POINTS];         //!< Positive side response curve table.
+    int16_t lut_neg[JOYSTICK_CURVE_POINTS];         //!< Negative side response curve table.
+} joystick_map_t;
+
+/**
+ * @brief   Axis calibration with background center tracking and travel learning.
+ */
+typedef struct
+{
+    joystick_cal_t cal;     //!< Current calibration.
+    uint32_t zero_acc;      //!< Center estimate, Q.JOYSTICK_DRIFT_SHIFT.
+    uint16_t rest;          //!< Consecutive samples in rest window.
+    uint16_t held;          //!< Least extreme value of current run beyond travel.
+    uint8_t grow;           //!< Consecutive samples beyond travel on one side.
+} joystick_track_t;
+
 typedef struct
 {
     adc_id_t x;
     adc_id_t y;
     gpio_id_t sw;
-    uint16_t x_zero;
-    uint16_t y_zero;
-    filters_low_pass_t x_lp;
-    filters_low_pass_t y_lp;
+    joystick_track_t x_track;
+    joystick_track_t y_track;
+    filters_low_pass_q16_t x_lp;
+    filters_low_pass_q16_t y_lp;
+    joystick_map_t x_map;
+    joystick_map_t y_map;
 } joystick_config_t;
 
 /**********************************************************************************************************************
  * Private constants
  *********************************************************************************************************************/
+/** Arctangent of i / 256 in degrees, Q16. Linear interpolation error is below 0.0001 degree. */
+static const uint32_t joystick_atan_lut[(1 << JOYSTICK_ATAN_BITS) + 1] =
+{
+          0,   14668,   29335,   44001,   58666,   73329,   87990,  102648,
+     117304,  131955,  146603,  161246,  175884,  190517,  205144,  219765,
+     234379,  248986,  263585,  278177,  292760,  307334,  321899,  336454,
+     350999,  365534,  380058,  394570,  409070,  423558,  438034,  452496,
+     466945,  481380,  495801,  510207,  524598,  538973,  553333,  567676,
+     582003,  596312,  610605,  624879,  639135,  653372,  667591,  681790,
+     695970,  710129,  724268,  738387,  752484,  766560,  780613,  794645,
+     808654,  822641,  836604,  850544,  864460,  878352,  892219,  906062,
+     919879,  933671,  947438,  961178,  974893,  988580, 1002241, 1015875,
+    1029481, 1043060, 1056611, 1070133, 1083627, 1097092, 1110529, 1123936,
+    1137313, 1150661, 1163979, 1177267, 1190524, 1203751, 1216947, 1230111,
+    1243245, 1256347, 1269417, 1282455, 1295461, 1308435, 1321376, 1334285,
+    1347161, 1360004, 1372813, 1385590, 1398332, 1411041, 1423717, 1436358,
+    1448965, 1461538, 1474076, 1486580, 1499049, 1511483, 1523882, 1536246,
+    1548575, 1560868, 1573127, 1585349, 1597536, 1609687, 1621803, 1633882,
+    1645926, 1657933, 1669904, 1681839, 1693738, 1705600, 1717426, 1729215,
+    1740967, 1752683, 1764362, 1776004, 1787610, 1799179, 1810710, 1822205,
+    1833663, 1845084, 1856467, 1867814, 1879123, 1890396, 1901631, 1912829,
+    1923990, 1935113, 1946200, 1957249, 1968261, 1979236, 1990173, 2001074,
+    2011937, 2022763, 2033552, 2044303, 2055018, 2065695, 2076336, 2086939,
+    2097505, 2108034, 2118526, 2128981, 2139399, 2149780, 2160125, 2170432,
+    2180703, 2190937, 2201134, 2211295, 2221419, 2231507, 2241558, 2251572,
+    2261551, 2271492, 2281398, 2291267, 2301101, 2310898, 2320659, 2330384,
+    2340074, 2349727, 2359345, 2368927, 2378474, 2387985, 2397460, 2406901,
+    2416306, 2425675, 2435010, 2444310, 2453574, 2462804, 2471999, 2481159,
+    2490285, 2499376, 2508433, 2517455, 2526443, 2535397, 2544317, 2553203,
+    2562055, 2570873, 2579658, 2588409, 2597126, 2605811, 2614461, 2623079,
+    2631664, 2640215, 2648734, 2657220, 2665673, 2674093, 2682482, 2690837,
+    2699161, 2707452, 2715711, 2723939, 2732134, 2740298, 2748430, 2756531,
+    2764600, 2772638, 2780644, 2788620, 2796564, 2804478, 2812361, 2820213,
+    2828035, 2835826, 2843587, 2851318, 2859019, 2866690, 2874330, 2881941,
+    2889523, 2897075, 2904597, 2912090, 2919554, 2926989, 2934395, 2941772,
+    2949120,
+};
 
 /**********************************************************************************************************************
  * Private variables
@@ -75,21 +163,27 @@ joystick_config_t joystick_config[JOYSTICK_ID_LAST] =
         .x = ADC_ID_JOYSTICK_LEFT_X,
         .y = ADC_ID_JOYSTICK_LEFT_Y,
         .sw = GPIO_ID_JOYSTICK_LEFT_SW,
-        .x_zero = (JOYSTICK_ADC_RES / 2),
-        .y_zero = (JOYSTICK_ADC_RES / 2),
-        .x_lp = {.input = 0.0, .output = 0.0, .cut_off = 1.0},
-        .y_lp = {.input = 0.0, .output = 0.0, .cut_off = 1.0},
+        .x_track = {.cal = JOYSTICK_CAL_DEFAULT},
+        .y_track = {.cal = JOYSTICK_CAL_DEFAULT},
+        .x_lp = {.input = 0, .output = 0, .cut_off = FILTERS_Q16_ONE},
+        .y_lp = {.input = 0, .output = 0, .cut_off = FILTERS_Q16_ONE},
+        .x_map = {.curve = JOYSTICK_CURVE_DEFAULT},
+        .y_map = {.curve = JOYSTICK_CURVE_DEFAULT},
     }, //JOYSTICK_ID_LEFT
     {
         .x = ADC_ID_JOYSTICK_RIGHT_X,
         .y = ADC_ID_JOYSTICK_RIGHT_Y,
         .sw = GPIO_ID_JOYSTICK_RIGHT_SW,
-        .x_zero = (JOYSTICK_ADC_RES / 2),
-        .y_zero = (JOYSTICK_ADC_RES / 2),
-        .x_lp = {.input = 0.0, .output = 0.0, .cut_off = 1.0},
-        .y_lp = {.input = 0.0, .output = 0.0, .cut_off = 1.0},
+        .x_track = {.cal = JOYSTICK_CAL_DEFAULT},
+        .y_track = {.cal = JOYSTICK_CAL_DEFAULT},
+        .x_lp = {.input = 0, .output = 0, .cut_off = FILTERS_Q16_ONE},
+        .y_lp = {.input = 0, .output = 0, .cut_off = FILTERS_Q16_ONE},
+        .x_map = {.curve = JOYSTICK_CURVE_DEFAULT},
+        .y_map = {.curve = JOYSTICK_CURVE_DEFAULT},
     }, //JOYSTICK_ID_RIGHT
 };
+/** Calibration as last stored in EEPROM. */
+static joystick_cal_t joystick_cal_saved[JOYSTICK_ID_LAST][JOYSTICK_AXIS_LAST];
 
 /**********************************************************************************************************************
  * Exported variables
@@ -98,6 +192,99 @@ joystick_config_t joystick_config[JOYSTICK_ID_LAST] =
 /**********************************************************************************************************************
  * Prototypes of local functions
  *********************************************************************************************************************/
+/**
+ * @brief   Filter and scale raw X axis value.
+ *
+ * @param   id  Joystick ID.
+ * @param   x   Raw ADC value.
+ *
+ * @return  X axis position.
+ */
+static int16_t joystick_scale_x(joystick_id_t id, uint32_t x);
+
+/**
+ * @brief   Filter and scale raw Y axis value.
+ *
+ * @param   id  Joystick ID.
+ * @param   y   Raw ADC value.
+ *
+ * @return  Y axis position.
+ */
+static int16_t joystick_scale_y(joystick_id_t id, uint32_t y);
+
+/**
+ * @brief   Update axis map scales for calibrated center and travel.
+ *
+ * @param   map     Axis map.
+ * @param   cal     Axis calibration.
+ */
+static void joystick_map_scale(joystick_map_t *map, const joystick_cal_t *cal);
+
+/**
+ * @brief   Apply calibration to axis: restart center tracking, rescale map and preset filter at center.
+ *
+ * @param   id      Joystick ID.
+ * @param   axis    Axis.
+ * @param   cal     Axis calibration.
+ */
+static void joystick_axis_reset(joystick_id_t id, joystick_axis_t axis, const joystick_cal_t *cal);
+
+/**
+ * @brief   Track center drift and learn travel from filtered axis value. Center follows slowly only while the stick
+ *          rests near it. Travel starts from minimal span and grows to level held for @ref JOYSTICK_GROW_COUNT
+ *          samples, so single outliers are ignored. Map is rescaled only when calibration changes.
+ *
+ * @param   track   Axis calibration tracker.
+ * @param   map     Axis map.
+ * @param   value   Filtered ADC counts.
+ */
+static void joystick_track(joystick_track_t *track, joystick_map_t *map, uint32_t value);
+
+/**
+ * @brief   Rebuild axis map response curve tables from curve settings.
+ *
+ * @param   map     Axis map.
+ */
+static void joystick_map_build(joystick_map_t *map);
+
+/**
+ * @brief   Build one side of response curve table.
+ *
+ * @param   curve       Curve settings.
+ * @param   endpoint    End point of the side, %.
+ * @param   lut         Table to build.
+ */
+static void joystick_map_build_side(const joystick_curve_t *curve, uint8_t endpoint, int16_t *lut);
+
+/**
+ * @brief   Map ADC counts to axis position: one multiply and one table lookup.
+ *
+ * @param   map     Axis map.
+ * @param   value   ADC counts.
+ * @param   zero    Calibrated center in ADC counts.
+ *
+ * @return  Axis position, -JOYSTICK_RESOLUTION ... JOYSTICK_RESOLUTION.
+ */
+static int16_t joystick_map_apply(const joystick_map_t *map, uint32_t value, uint16_t zero);
+
+/**
+ * @brief   Integer square root.
+ *
+ * @param   value   Input value.
+ *
+ * @return  Square root rounded down.
+ */
+static uint32_t joystick_isqrt(uint32_t value);
+
+/**
+ * @brief   Arctangent of ratio num / den in the first octant.
+ *
+ * @param   num     Numerator, must not be greater than denominator.
+ * @param   den     Denominator, must be 1 ... 2047.
+ *
+ * @return  Angle 0 ... 45 degrees, Q16.
+ */
+static uint32_t joystick_atan_octant(uint32_t num, uint32_t den);
 
 /**********************************************************************************************************************
  * Exported functions
@@ -105,6 +292,9 @@ joystick_config_t joystick_config[JOYSTICK_ID_LAST] =
 bool joystick_init(void)
 {
     uint8_t i = 0;
+    uint8_t axis = 0;
+    bool loaded = nvm_load(NVM_ID_JOYSTICK, joystick_cal_saved, sizeof(joystick_cal_saved));
+    joystick_cal_t *cal = NULL;
 
     for(i = 0; i < JOYSTICK_ID_LAST; i++)
     {
@@ -112,7 +302,32 @@ bool joystick_init(void)
         {
             continue;
         }
-        joystick_calibrate((joystick_id_t)i);
+        // Joystick not fitted on this board, nothing to calibrate.
+        if(!adc_is_used(joystick_config[i].x) && !adc_is_used(joystick_config[i].y))
+        {
+            continue;
+        }
+        joystick_map_build(&joystick_config[i].x_map);
+        joystick_map_build(&joystick_config[i].y_map);
+
+        // Stored calibration skips startup calibration, remaining offset is removed by center tracking.
+        for(axis = 0; loaded && axis < JOYSTICK_AXIS_LAST; axis++)
+        {
+            cal = &joystick_cal_saved[i][axis];
+            if(cal->min >= cal->zero || cal->zero >= cal->max)
+            {
+                break;
+            }
+        }
+        if(!loaded || axis < JOYSTICK_AXIS_LAST)
+        {
+            joystick_calibrate((joystick_id_t)i);
+            continue;
+        }
+        for(axis = 0; axis < JOYSTICK_AXIS_LAST; axis++)
+        {
+            joystick_axis_reset((joystick_id_t)i, (joystick_axis_t)axis, &joystick_cal_saved[i][axis]);
+        }
     }
 
     return true;
@@ -123,104 +338,520 @@ void joystick_calibrate(joystick_id_t id)
     uint8_t i = JOYSTICK_CAL_COUNT;
     uint32_t x = 0;
     uint32_t y = 0;
+    uint32_t seq = 0;
+    adc_samples_t samples;
+    joystick_cal_t cal;
+
+    if(!adc_is_used(joystick_config[id].x) && !adc_is_used(joystick_config[id].y))
+    {
+        return;
+    }
 
     while(i--)
     {
-        x += adc_read_raw(joystick_config[id].x);
-        y += adc_read_raw(joystick_config[id].y);
-        osDelay(1);
+        // Wait for new sample block.
+        while(!adc_get_samples(&samples) || samples.seq == seq)
+        {
+            osDelay(1);
+        }
+        seq = samples.seq;
+        x += samples.raw[joystick_config[id].x];
+        y += samples.raw[joystick_config[id].y];
     }
-    joystick_config[id].x_zero = x / JOYSTICK_CAL_COUNT;
-    joystick_config[id].y_zero = y / JOYSTICK_CAL_COUNT;
+    x /= JOYSTICK_CAL_COUNT;
+    y /= JOYSTICK_CAL_COUNT;
+
+    // Travel is learned again from this center.
+    cal.zero = x;
+    cal.min = x > JOYSTICK_SPAN_MIN ? x - JOYSTICK_SPAN_MIN : 0;
+    cal.max = x + JOYSTICK_SPAN_MIN < JOYSTICK_ADC_RES ? x + JOYSTICK_SPAN_MIN : JOYSTICK_ADC_RES - 1;
+    joystick_axis_reset(id, JOYSTICK_AXIS_X, &cal);
+    cal.zero = y;
+    cal.min = y > JOYSTICK_SPAN_MIN ? y - JOYSTICK_SPAN_MIN : 0;
+    cal.max = y + JOYSTICK_SPAN_MIN < JOYSTICK_ADC_RES ? y + JOYSTICK_SPAN_MIN : JOYSTICK_ADC_RES - 1;
+    joystick_axis_reset(id, JOYSTICK_AXIS_Y, &cal);
 
     return;
 }
 
 int16_t joystick_get_x(joystick_id_t id)
 {
-    uint32_t x = adc_read_raw(joystick_config[id].x);
+    return joystick_scale_x(id, adc_read_raw(joystick_config[id].x));
+}
+
+int16_t joystick_get_y(joystick_id_t id)
+{
+    return joystick_scale_y(id, adc_read_raw(joystick_config[id].y));
+}
+
+bool joystick_get_axes(joystick_id_t id, int16_t *x, int16_t *y)
+{
+    adc_samples_t samples;
 
-    x = filters_low_pass(&joystick_config[id].x_lp, x, JOYSTICK_X_LP_CUTOF);
-    
-    if(x > (joystick_config[id].x_zero + JOYSTICK_X_OFFSET))
+    // Both axes from the same sample block.
+    if(!adc_get_samples(&samples))
     {
-#if JOYSTICK_X_INVERT
-        return -(((x - joystick_config[id].x_zero) * JOYSTICK_RESOLUTION) / (JOYSTICK_ADC_RES - joystick_config[id].x_zero));
-#else
-        return (((x - joystick_config[id].x_zero) * JOYSTICK_RESOLUTION) / (JOYSTICK_ADC_RES - joystick_config[id].x_zero));
-#endif
+        *x = 0;
+        *y = 0;
+        return false;
     }
+    *x = joystick_scale_x(id, samples.raw[joystick_config[id].x]);
+    *y = joystick_scale_y(id, samples.raw[joystick_config[id].y]);
+
+    return true;
+}
 
-    if(x < (joystick_config[id].x_zero - JOYSTICK_X_OFFSET))
+void joystick_get_vector(joystick_id_t id, int32_t *magnitude, int32_t *direction)
+{
+    int16_t x = 0;
+    int16_t y = 0;
+
+    if(!joystick_get_axes(id, &x, &y))
     {
-#if JOYSTICK_X_INVERT
-        return (((joystick_config[id].x_zero - x) * JOYSTICK_RESOLUTION) / joystick_config[id].x_zero);
-#else
-        return -(((joystick_config[id].x_zero - x) * JOYSTICK_RESOLUTION) / joystick_config[id].x_zero);
-#endif
+        *magnitude = 0;
+        *direction = 0;
+        return;
     }
 
-    return 0;
+    *magnitude = joystick_magnitude(x, y);
+    *direction = joystick_direction(x, y);
+
+    return;
 }
 
-int16_t joystick_get_y(joystick_id_t id)
+int32_t joystick_magnitude(int16_t x, int16_t y)
+{
+    uint32_t magn = joystick_isqrt((uint32_t)((int32_t)x * x) + (uint32_t)((int32_t)y * y));
+
+    return magn > JOYSTICK_RESOLUTION ? JOYSTICK_RESOLUTION : (int32_t)magn;
+}
+
+int32_t joystick_direction(int16_t x, int16_t y)
 {
-    uint32_t y = adc_read_raw(joystick_config[id].y);
-    
-    y = filters_low_pass(&joystick_config[id].y_lp, y, JOYSTICK_Y_LP_CUTOF);
+    uint32_t ax = x < 0 ? -(int32_t)x : x;
+    uint32_t ay = y < 0 ? -(int32_t)y : y;
+    uint32_t dir = 0;
 
-    if(y > (joystick_config[id].y_zero + JOYSTICK_Y_OFFSET))
+    if(ax == 0 && ay == 0)
     {
-#if JOYSTICK_Y_INVERT
-        return -(((y - joystick_config[id].y_zero) * JOYSTICK_RESOLUTION) / (JOYSTICK_ADC_RES - joystick_config[id].y_zero));
-#else
-        return (((y - joystick_config[id].y_zero) * JOYSTICK_RESOLUTION) / (JOYSTICK_ADC_RES - joystick_config[id].y_zero));
-#endif
+        return 0;
+    }
+    // Keep ratio computation inside of 32 bits.
+    while(ax > 2047 || ay > 2047)
+    {
+        ax >>= 1;
+        ay >>= 1;
+    }
+
+    // Angle from +Y axis toward +X axis inside of quadrant.
+    if(ax <= ay)
+    {
+        dir = joystick_atan_octant(ax, ay);
+    }
+    else
+    {
+        dir = (90UL << JOYSTICK_DEG_SHIFT) - joystick_atan_octant(ay, ax);
+    }
+
+    // Unfold quadrants, 0 ... 360 degrees.
+    if(y < 0)
+    {
+        dir = x < 0 ? (180UL << JOYSTICK_DEG_SHIFT) + dir : (180UL << JOYSTICK_DEG_SHIFT) - dir;
+    }
+    else if(x < 0)
+    {
+        dir = (360UL << JOYSTICK_DEG_SHIFT) - dir;
     }
+    // Round to nearest degree, 359.5 and above is 0.
+    dir = (dir + (1UL << (JOYSTICK_DEG_SHIFT - 1))) >> JOYSTICK_DEG_SHIFT;
+
+    return dir >= 360 ? 0 : (int32_t)dir;
+}
+
+bool joystick_get_sw(joystick_id_t id)
+{
+    return gpio_input_get(joystick_config[id].sw);
+}
+
+bool joystick_set_curve(joystick_id_t id, joystick_axis_t axis, const joystick_curve_t *curve)
+{
+    joystick_map_t *map = NULL;
+    joystick_map_t tmp;
 
-    if(y < (joystick_config[id].y_zero - JOYSTICK_Y_OFFSET))
+    if(id >= JOYSTICK_ID_LAST || axis >= JOYSTICK_AXIS_LAST || curve->deadzone >= JOYSTICK_RESOLUTION ||
+       curve->expo > 100 || curve->rate > 100 || curve->endpoint_pos > 100 || curve->endpoint_neg > 100)
     {
+        return false;
+    }
+    map = axis == JOYSTICK_AXIS_X ? &joystick_config[id].x_map : &joystick_config[id].y_map;
+
+    // Build tables aside, so sampling never sees half built curve.
+    tmp = *map;
+    tmp.curve = *curve;
+    joystick_map_build(&tmp);
+    __disable_irq();
+    *map = tmp;
+    __enable_irq();
+
+    return true;
+}
+
+void joystick_get_curve(joystick_id_t id, joystick_axis_t axis, joystick_curve_t *curve)
+{
+    *curve = axis == JOYSTICK_AXIS_X ? joystick_config[id].x_map.curve : joystick_config[id].y_map.curve;
+
+    return;
+}
+
+void joystick_get_cal(joystick_id_t id, joystick_axis_t axis, joystick_cal_t *cal)
+{
+    __disable_irq();
+    *cal = axis == JOYSTICK_AXIS_X ? joystick_config[id].x_track.cal : joystick_config[id].y_track.cal;
+    __enable_irq();
+
+    return;
+}
+
+bool joystick_save(void)
+{
+    joystick_cal_t cal[JOYSTICK_ID_LAST][JOYSTICK_AXIS_LAST];
+    joystick_cal_t *saved = NULL;
+    bool changed = false;
+    uint8_t i = 0;
+    uint8_t axis = 0;
+
+    for(i = 0; i < JOYSTICK_ID_LAST; i++)
+    {
+        for(axis = 0; axis < JOYSTICK_AXIS_LAST; axis++)
+        {
+            joystick_get_cal((joystick_id_t)i, (joystick_axis_t)axis, &cal[i][axis]);
+            saved = &joystick_cal_saved[i][axis];
+            changed |= cal[i][axis].zero + JOYSTICK_SAVE_DELTA <= saved->zero ||
+                       cal[i][axis].zero >= saved->zero + JOYSTICK_SAVE_DELTA ||
+                       cal[i][axis].min + JOYSTICK_SAVE_DELTA <= saved->min ||
+                       cal[i][axis].max >= saved->max + JOYSTICK_SAVE_DELTA;
+        }
+    }
+    // Small changes are not worth EEPROM wear.
+    if(!changed)
+    {
+        return true;
+    }
+    if(!nvm_store(NVM_ID_JOYSTICK, cal, sizeof(cal)))
+    {
+        return false;
+    }
+    memcpy(joystick_cal_saved, cal, sizeof(cal));
+
+    return true;
+}
+
+#if JOYSTICK_BENCH
+void joystick_bench(joystick_bench_t *result)
+{
+    volatile double magn_ref = 0;
+    volatile double dir_ref = 0;
+    volatile int32_t magn = 0;
+    volatile int32_t dir = 0;
+    uint32_t overhead = 0;
+    uint32_t start = 0;
+    int32_t x = 0;
+    int32_t y = 0;
+
+    memset(result, 0, sizeof(*result));
+
+    // Timer read overhead.
+    __disable_irq();
+    start = osKernelGetSysTimerCount();
+    overhead = osKernelGetSysTimerCount() - start;
+    __enable_irq();
+
+    for(x = -JOYSTICK_RESOLUTION; x <= JOYSTICK_RESOLUTION; x += JOYSTICK_BENCH_GRID)
+    {
+        for(y = -JOYSTICK_RESOLUTION; y <= JOYSTICK_RESOLUTION; y += JOYSTICK_BENCH_GRID)
+        {
+            __disable_irq();
+            // Reference: double precision implementation used before.
+            start = osKernelGetSysTimerCount();
+            magn_ref = sqrt(pow(x, 2) + pow(y, 2));
+            if(magn_ref > JOYSTICK_RESOLUTION)
+            {
+                magn_ref = JOYSTICK_RESOLUTION;
+            }
+            dir_ref = atan2(x, y);
+            if(dir_ref < 0)
+            {
+                dir_ref += 2 * JOYSTICK_BENCH_PI;
+            }
+            dir_ref = dir_ref * 180 / JOYSTICK_BENCH_PI;
+            result->cycles_double += osKernelGetSysTimerCount() - start - overhead;
+
+            start = osKernelGetSysTimerCount();
+            magn = joystick_magnitude((int16_t)x, (int16_t)y);
+            dir = joystick_direction((int16_t)x, (int16_t)y);
+            result->cycles_int += osKernelGetSysTimerCount() - start - overhead;
+            __enable_irq();
+
+            result->magn_mismatch += magn != (int32_t)magn_ref;
+            result->dir_mismatch += (x != 0 || y != 0) && dir != (int32_t)(dir_ref + 0.5) % 360;
+            result->points++;
+        }
+        // Let other threads run between grid rows.
+        osDelay(1);
+    }
+    result->cycles_double /= result->points;
+    result->cycles_int /= result->points;
+
+    return;
+}
+#endif
+
+/**********************************************************************************************************************
+ * Private functions
+ *********************************************************************************************************************/
+static int16_t joystick_scale_x(joystick_id_t id, uint32_t x)
+{
+    x = filters_low_pass_q16(&joystick_config[id].x_lp, (filters_q16_t)(x << JOYSTICK_LP_SHIFT), JOYSTICK_X_LP_CUTOF) >>
+        JOYSTICK_LP_SHIFT;
+    joystick_track(&joystick_config[id].x_track, &joystick_config[id].x_map, x);
+
+#if JOYSTICK_X_INVERT
+    return -joystick_map_apply(&joystick_config[id].x_map, x, joystick_config[id].x_track.cal.zero);
+#else
+    return joystick_map_apply(&joystick_config[id].x_map, x, joystick_config[id].x_track.cal.zero);
+#endif
+}
+
+static int16_t joystick_scale_y(joystick_id_t id, uint32_t y)
+{
+    y = filters_low_pass_q16(&joystick_config[id].y_lp, (filters_q16_t)(y << JOYSTICK_LP_SHIFT), JOYSTICK_Y_LP_CUTOF) >>
+        JOYSTICK_LP_SHIFT;
+    joystick_track(&joystick_config[id].y_track, &joystick_config[id].y_map, y);
+
 #if JOYSTICK_Y_INVERT
-        return (((joystick_config[id].y_zero - y) * JOYSTICK_RESOLUTION) / joystick_config[id].y_zero);
+    return -joystick_map_apply(&joystick_config[id].y_map, y, joystick_config[id].y_track.cal.zero);
 #else
-        return -(((joystick_config[id].y_zero - y) * JOYSTICK_RESOLUTION) / joystick_config[id].y_zero);
+    return joystick_map_apply(&joystick_config[id].y_map, y, joystick_config[id].y_track.cal.zero);
 #endif
-    }
+}
+
+static void joystick_axis_reset(joystick_id_t id, joystick_axis_t axis, const joystick_cal_t *cal)
+{
+    joystick_track_t *track = axis == JOYSTICK_AXIS_X ? &joystick_config[id].x_track : &joystick_config[id].y_track;
+    joystick_map_t *map = axis == JOYSTICK_AXIS_X ? &joystick_config[id].x_map : &joystick_config[id].y_map;
+    filters_low_pass_q16_t *lp = axis == JOYSTICK_AXIS_X ? &joystick_config[id].x_lp : &joystick_config[id].y_lp;
+
+    __disable_irq();
+    track->cal = *cal;
+    track->zero_acc = (uint32_t)cal->zero << JOYSTICK_DRIFT_SHIFT;
+    track->rest = 0;
+    track->grow = 0;
+    __enable_irq();
+    joystick_map_scale(map, cal);
+    // Start filter at center, so its settling is not learned as travel.
+    lp->input = (filters_q16_t)cal->zero << JOYSTICK_LP_SHIFT;
+    lp->output = lp->input;
 
-    return 0;
+    return;
 }
 
-void joystick_get_vector(joystick_id_t id, int32_t *magnitude, int32_t *direction)
+static void joystick_track(joystick_track_t *track, joystick_map_t *map, uint32_t value)
 {
-    double magn = 0;
-    double dir = 0;
-    int16_t x = joystick_get_x(id);
-    int16_t y = joystick_get_y(id);
+    bool changed = false;
+    uint16_t zero = 0;
 
-    magn = sqrt(pow(x, 2) + pow(y, 2));
-    if(magn > 1024)
+    if(value >= UINT16_MAX)
     {
-        magn = JOYSTICK_RESOLUTION;
+        // Channel not used.
+        return;
     }
 
-    dir = atan2(x, y);
-    if(dir < 0)
+    if(value < track->cal.min || value > track->cal.max)
+    {
+        // New run starts on first sample or on other side.
+        if(track->grow == 0 || (value < track->cal.min) != (track->held < track->cal.min))
+        {
+            track->held = value;
+        }
+        // Travel grows only to level held by whole run.
+        else if(value < track->cal.min ? value > track->held : value < track->held)
+        {
+            track->held = value;
+        }
+        if(++track->grow >= JOYSTICK_GROW_COUNT)
+        {
+            if(track->held < track->cal.min)
+            {
+                track->cal.min = track->held;
+            }
+            else
+            {
+                track->cal.max = track->held;
+            }
+            track->grow = 0;
+            changed = true;
+        }
+    }
+    else
     {
-        dir += 2 * JOYSTICK_PI;
+        track->grow = 0;
     }
-    dir = dir * 180 / JOYSTICK_PI;
 
-    *magnitude = (int32_t)magn;
-    *direction = (int32_t)dir;
+    if(value + JOYSTICK_REST_WINDOW < track->cal.zero || value > (uint32_t)track->cal.zero + JOYSTICK_REST_WINDOW)
+    {
+        track->rest = 0;
+    }
+    else if(track->rest < JOYSTICK_REST_COUNT)
+    {
+        track->rest++;
+    }
+    else
+    {
+        // First order low pass of resting position.
+        track->zero_acc += ((int32_t)(value << JOYSTICK_DRIFT_SHIFT) - (int32_t)track->zero_acc) >> JOYSTICK_DRIFT_SHIFT;
+        zero = track->zero_acc >> JOYSTICK_DRIFT_SHIFT;
+        if(zero != track->cal.zero)
+        {
+            track->cal.zero = zero;
+            changed = true;
+        }
+    }
+
+    if(changed)
+    {
+        joystick_map_scale(map, &track->cal);
+    }
 
     return;
 }
 
-bool joystick_get_sw(joystick_id_t id)
+static void joystick_map_scale(joystick_map_t *map, const joystick_cal_t *cal)
 {
-    return gpio_input_get(joystick_config[id].sw);
+    uint32_t span_pos = cal->max > cal->zero ? cal->max - cal->zero : 0;
+    uint32_t span_neg = cal->zero > cal->min ? cal->zero - cal->min : 0;
+
+    span_pos = span_pos < JOYSTICK_SPAN_MIN ? JOYSTICK_SPAN_MIN : span_pos;
+    span_neg = span_neg < JOYSTICK_SPAN_MIN ? JOYSTICK_SPAN_MIN : span_neg;
+
+    // Rounded up, so full travel reaches full output.
+    map->scale_pos = (((uint32_t)JOYSTICK_RESOLUTION << 16) + span_pos - 1) / span_pos;
+    map->scale_neg = (((uint32_t)JOYSTICK_RESOLUTION << 16) + span_neg - 1) / span_neg;
+
+    return;
 }
 
-/**********************************************************************************************************************
- * Private functions
- *********************************************************************************************************************/
+static void joystick_map_build(joystick_map_t *map)
+{
+    joystick_map_build_side(&map->curve, map->curve.endpoint_pos, map->lut_pos);
+    joystick_map_build_side(&map->curve, map->curve.endpoint_neg, map->lut_neg);
+
+    return;
+}
+
+static void joystick_map_build_side(const joystick_curve_t *curve, uint8_t endpoint, int16_t *lut)
+{
+    uint8_t i = 0;
+    uint32_t in = 0;
+    int64_t v = 0;
+    int64_t out = 0;
+
+    for(i = 0; i < JOYSTICK_CURVE_POINTS; i++)
+    {
+        in = (uint32_t)i << JOYSTICK_CURVE_SHIFT;
+        if(in <= curve->deadzone)
+        {
+            lut[i] = 0;
+            continue;
+        }
+
+        // Position outside of dead zone, Q15.
+        v = ((int64_t)(in - curve->deadzone) << 15) / (JOYSTICK_RESOLUTION - curve->deadzone);
+        // Expo: mix of linear and cubic parts.
+        out = (v * (100 - curve->expo) + ((v * v * v) >> 30) * curve->expo) / 100;
+        // Rate and end point.
+        out = (out * curve->rate * endpoint) / (100 * 100);
+        out = ((out * JOYSTICK_RESOLUTION) + (1L << 14)) >> 15;
+
+        lut[i] = (int16_t)(out > JOYSTICK_RESOLUTION ? JOYSTICK_RESOLUTION : out);
+    }
+
+    return;
+}
+
+static int16_t joystick_map_apply(const joystick_map_t *map, uint32_t value, uint16_t zero)
+{
+    uint32_t in = 0;
+    uint32_t idx = 0;
+    uint32_t frac = 0;
+    const int16_t *lut = NULL;
+    int16_t out = 0;
+
+    if(value >= zero)
+    {
+        in = ((value - zero) * map->scale_pos + 0x8000) >> 16;
+        lut = map->lut_pos;
+    }
+    else
+    {
+        in = ((zero - value) * map->scale_neg + 0x8000) >> 16;
+        lut = map->lut_neg;
+    }
+    if(in <= map->curve.deadzone)
+    {
+        return 0;
+    }
+    if(in >= JOYSTICK_RESOLUTION)
+    {
+        out = lut[JOYSTICK_CURVE_POINTS - 1];
+    }
+    else
+    {
+        idx = in >> JOYSTICK_CURVE_SHIFT;
+        frac = in & ((1UL << JOYSTICK_CURVE_SHIFT) - 1);
+        out = lut[idx] + (((lut[idx + 1] - lut[idx]) * (int32_t)frac + (1L << (JOYSTICK_CURVE_SHIFT - 1))) >>
+                          JOYSTICK_CURVE_SHIFT);
+    }
+
+    return value >= zero ? out : -out;
+}
+
+static uint32_t joystick_isqrt(uint32_t value)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+
+    while(bit > value)
+    {
+        bit >>= 2;
+    }
+    while(bit != 0)
+    {
+        if(value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return root;
+}
+
+static uint32_t joystick_atan_octant(uint32_t num, uint32_t den)
+{
+    uint32_t ratio = ((num << JOYSTICK_RATIO_SHIFT) + (den / 2)) / den;
+    uint32_t idx = ratio >> (JOYSTICK_RATIO_SHIFT - JOYSTICK_ATAN_BITS);
+    uint32_t frac = ratio & ((1UL << (JOYSTICK_RATIO_SHIFT - JOYSTICK_ATAN_BITS)) - 1);
+
+    if(idx >= (1 << JOYSTICK_ATAN_BITS))
+    {
+        return joystick_atan_lut[1 << JOYSTICK_ATAN_BITS];
+    }
+
+    return joystick_atan_lut[idx] +
+           (((joystick_atan_lut[idx + 1] - joystick_atan_lut[idx]) * frac) >> (JOYSTICK_RATIO_SHIFT - JOYSTICK_ATAN_BITS));
+}
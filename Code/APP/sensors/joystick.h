@@ -31,6 +31,12 @@ extern "C" {
 /**********************************************************************************************************************
  * Exported definitions and macros
  *********************************************************************************************************************/
+#define JOYSTICK_RESOLUTION     1024    //!< Axis and magnitude full scale.
+#define JOYSTICK_CURVE_POINTS   33      //!< Response curve table points, linear interpolation between them.
+
+#ifndef JOYSTICK_BENCH
+#define JOYSTICK_BENCH          0       //!< 1 - build vector cycle count benchmark, see @ref joystick_bench.
+#endif
 
 /**********************************************************************************************************************
  * Exported types
@@ -42,6 +48,49 @@ typedef enum
     JOYSTICK_ID_LAST,
 } joystick_id_t;
 
+typedef enum
+{
+    JOYSTICK_AXIS_X,
+    JOYSTICK_AXIS_Y,
+    JOYSTICK_AXIS_LAST,
+} joystick_axis_t;
+
+/**
+ * @brief   Axis response curve settings.
+ */
+typedef struct
+{
+    uint16_t deadzone;      //!< Dead zone around center, 0 ... JOYSTICK_RESOLUTION - 1.
+    uint8_t expo;           //!< Exponential part, 0 - linear ... 100 - cubic, %.
+    uint8_t rate;           //!< Rate (dual rate), 0 ... 100 %.
+    uint8_t endpoint_pos;   //!< Positive direction end point, 0 ... 100 %.
+    uint8_t endpoint_neg;   //!< Negative direction end point, 0 ... 100 %.
+} joystick_curve_t;
+
+/**
+ * @brief   Axis calibration in ADC counts of 16 bit full scale.
+ */
+typedef struct
+{
+    uint16_t zero;          //!< Center.
+    uint16_t min;           //!< Negative end of travel.
+    uint16_t max;           //!< Positive end of travel.
+} joystick_cal_t;
+
+#if JOYSTICK_BENCH
+/**
+ * @brief   Vector benchmark result.
+ */
+typedef struct
+{
+    uint32_t points;        //!< Input grid points.
+    uint32_t cycles_double; //!< System timer cycles per point of sqrt/atan2 implementation used before.
+    uint32_t cycles_int;    //!< System timer cycles per point of @ref joystick_magnitude and @ref joystick_direction.
+    uint32_t magn_mismatch; //!< Points where magnitude differs from truncated double result.
+    uint32_t dir_mismatch;  //!< Points where direction differs from double result rounded to degrees.
+} joystick_bench_t;
+#endif
+
 /**********************************************************************************************************************
  * Exported constants
  *********************************************************************************************************************/
@@ -57,8 +106,25 @@ bool joystick_init(void);
 void joystick_calibrate(joystick_id_t id);
 int16_t joystick_get_x(joystick_id_t id);
 int16_t joystick_get_y(joystick_id_t id);
+bool joystick_get_axes(joystick_id_t id, int16_t *x, int16_t *y);
 void joystick_get_vector(joystick_id_t id, int32_t *magnitude, int32_t *direction);
 bool joystick_get_sw(joystick_id_t id);
+int32_t joystick_magnitude(int16_t x, int16_t y);
+int32_t joystick_direction(int16_t x, int16_t y);
+bool joystick_set_curve(joystick_id_t id, joystick_axis_t axis, const joystick_curve_t *curve);
+void joystick_get_curve(joystick_id_t id, joystick_axis_t axis, joystick_curve_t *curve);
+void joystick_get_cal(joystick_id_t id, joystick_axis_t axis, joystick_cal_t *cal);
+bool joystick_save(void);
+
+#if JOYSTICK_BENCH
+/**
+ * @brief   Measure vector math of @ref joystick_get_vector against sqrt/atan2 implementation it replaced, in system
+ *          timer cycles over grid of axis values. Interrupts are disabled during each point, call from thread context.
+ *
+ * @param   result  Pointer where to store result.
+ */
+void joystick_bench(joystick_bench_t *result);
+#endif
 
 
 #ifdef __cplusplus
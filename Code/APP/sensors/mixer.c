@@ -0,0 +1,241 @@
+/**
+ **********************************************************************************************************************
+ * @file         mixer.c
+ * @author       Diamond Sparrow
+ * @version      1.0.0.0
+ * @date         2016-10-04
+ * @brief        Channel mixer C source file.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sensors/mixer.h"
+
+#include "seqlock.h"
+
+/**********************************************************************************************************************
+ * Private definitions and macros
+ *********************************************************************************************************************/
+#define MIXER_WEIGHT_SHIFT  10  //!< Fraction bits of precomputed line weight.
+
+/** Mix table line without curve and offset. */
+#define MIXER_LINE(output, input, weight) \
+    {.line = {(output), (input), MIXER_CURVE_NONE, (weight), 0}, .scale = ((weight) * (1 << MIXER_WEIGHT_SHIFT)) / 100}
+
+/** Unused mix table line. */
+#define MIXER_LINE_NONE     {.line = {.output = MIXER_OUTPUT_LAST}, .scale = 0}
+
+/** Default mix table: differential drive from left joystick, left = Y + X, right = Y - X. Full range outputs. */
+#define MIXER_TABLE_DEFAULT \
+{ \
+    .lines = \
+    { \
+        MIXER_LINE(MIXER_OUTPUT_MOTOR_LEFT, MIXER_INPUT_LEFT_Y, 100), \
+        MIXER_LINE(MIXER_OUTPUT_MOTOR_LEFT, MIXER_INPUT_LEFT_X, 100), \
+        MIXER_LINE(MIXER_OUTPUT_MOTOR_RIGHT, MIXER_INPUT_LEFT_Y, 100), \
+        MIXER_LINE(MIXER_OUTPUT_MOTOR_RIGHT, MIXER_INPUT_LEFT_X, -100), \
+        MIXER_LINE(MIXER_OUTPUT_AUX_1, MIXER_INPUT_RIGHT_Y, 100), \
+        MIXER_LINE(MIXER_OUTPUT_AUX_2, MIXER_INPUT_LEFT_SW, 100), \
+        MIXER_LINE_NONE, \
+        MIXER_LINE_NONE, \
+    }, \
+    .limits = \
+    { \
+        {-MIXER_RESOLUTION, MIXER_RESOLUTION}, \
+        {-MIXER_RESOLUTION, MIXER_RESOLUTION}, \
+        {-MIXER_RESOLUTION, MIXER_RESOLUTION}, \
+        {-MIXER_RESOLUTION, MIXER_RESOLUTION}, \
+    }, \
+}
+
+/**********************************************************************************************************************
+ * Private typedef
+ *********************************************************************************************************************/
+/**
+ * @brief   Mix table entry with weight converted for the sample path.
+ */
+typedef struct
+{
+    mixer_line_t line;  //!< Line settings.
+    int16_t scale;      //!< Weight in Q.MIXER_WEIGHT_SHIFT.
+} mixer_entry_t;
+
+/**
+ * @brief   Output channel clipping limits.
+ */
+typedef struct
+{
+    int16_t min;    //!< Minimal output value.
+    int16_t max;    //!< Maximal output value.
+} mixer_limits_t;
+
+/**
+ * @brief   Mix table with output limits, published to sample path as one object.
+ */
+typedef struct
+{
+    mixer_entry_t lines[MIXER_LINES_MAX];       //!< Mix table lines.
+    mixer_limits_t limits[MIXER_OUTPUT_LAST];   //!< Output channel limits.
+} mixer_table_t;
+
+/**********************************************************************************************************************
+ * Private constants
+ *********************************************************************************************************************/
+
+/**********************************************************************************************************************
+ * Private variables
+ *********************************************************************************************************************/
+/** Mix table, changed only by setters. */
+static mixer_table_t mixer_table = MIXER_TABLE_DEFAULT;
+/** Mix table published to sample path. Default is in copy selected by sequence 0. */
+static SEQLOCK_OBJECT(mixer_table_t) mixer_table_pub = {.copy = {MIXER_TABLE_DEFAULT}};
+
+/**********************************************************************************************************************
+ * Exported variables
+ *********************************************************************************************************************/
+
+/**********************************************************************************************************************
+ * Prototypes of local functions
+ *********************************************************************************************************************/
+/**
+ * @brief   Apply mix line curve to input value.
+ *
+ * @param   curve   Curve, see @ref mixer_curve_t.
+ * @param   value   Input value.
+ *
+ * @return  Curve output.
+ */
+static int32_t mixer_curve(uint8_t curve, int32_t value);
+
+/**********************************************************************************************************************
+ * Exported functions
+ *********************************************************************************************************************/
+bool mixer_set_line(uint8_t idx, const mixer_line_t *line)
+{
+    mixer_entry_t entry;
+
+    if(idx >= MIXER_LINES_MAX || line == NULL)
+    {
+        return false;
+    }
+    if(line->output < MIXER_OUTPUT_LAST &&
+       (line->input >= MIXER_INPUT_LAST || line->curve >= MIXER_CURVE_LAST ||
+        line->weight < -100 || line->weight > 100 ||
+        line->offset < -MIXER_RESOLUTION || line->offset > MIXER_RESOLUTION))
+    {
+        return false;
+    }
+
+    entry.line = *line;
+    if(entry.line.output > MIXER_OUTPUT_LAST)
+    {
+        entry.line.output = MIXER_OUTPUT_LAST;
+    }
+    // Division only here, sample path multiplies and shifts.
+    entry.scale = (int16_t)(((int32_t)line->weight << MIXER_WEIGHT_SHIFT) / 100);
+
+    mixer_table.lines[idx] = entry;
+    SEQLOCK_PUBLISH(mixer_table_pub, &mixer_table);
+
+    return true;
+}
+
+bool mixer_get_line(uint8_t idx, mixer_line_t *line)
+{
+    mixer_table_t table;
+
+    if(idx >= MIXER_LINES_MAX || line == NULL)
+    {
+        return false;
+    }
+
+    SEQLOCK_SNAPSHOT(mixer_table_pub, &table);
+    *line = table.lines[idx].line;
+
+    return true;
+}
+
+bool mixer_set_limits(mixer_output_t output, int16_t min, int16_t max)
+{
+    if(output >= MIXER_OUTPUT_LAST || min > max || min < -MIXER_RESOLUTION || max > MIXER_RESOLUTION)
+    {
+        return false;
+    }
+
+    mixer_table.limits[output].min = min;
+    mixer_table.limits[output].max = max;
+    SEQLOCK_PUBLISH(mixer_table_pub, &mixer_table);
+
+    return true;
+}
+
+void mixer_update(const int16_t inputs[MIXER_INPUT_LAST], int16_t outputs[MIXER_OUTPUT_LAST])
+{
+    int32_t sum[MIXER_OUTPUT_LAST] = {0};
+    const mixer_entry_t *entry = NULL;
+    mixer_table_t table;
+    uint8_t i = 0;
+
+    // Table may be changed from another thread, whole update uses one consistent copy.
+    SEQLOCK_SNAPSHOT(mixer_table_pub, &table);
+
+    for(i = 0; i < MIXER_LINES_MAX; i++)
+    {
+        entry = &table.lines[i];
+        if(entry->line.output >= MIXER_OUTPUT_LAST)
+        {
+            continue;
+        }
+        sum[entry->line.output] += ((mixer_curve(entry->line.curve, inputs[entry->line.input]) * entry->scale) >>
+                                    MIXER_WEIGHT_SHIFT) + entry->line.offset;
+    }
+
+    for(i = 0; i < MIXER_OUTPUT_LAST; i++)
+    {
+        if(sum[i] < table.limits[i].min)
+        {
+            sum[i] = table.limits[i].min;
+        }
+        else if(sum[i] > table.limits[i].max)
+        {
+            sum[i] = table.limits[i].max;
+        }
+        outputs[i] = (int16_t)sum[i];
+    }
+
+    return;
+}
+
+/**********************************************************************************************************************
+ * Private functions
+ *********************************************************************************************************************/
+static int32_t mixer_curve(uint8_t curve, int32_t value)
+{
+    switch(curve)
+    {
+        case MIXER_CURVE_POSITIVE:
+            return value > 0 ? value : 0;
+        case MIXER_CURVE_NEGATIVE:
+            return value < 0 ? value : 0;
+        case MIXER_CURVE_ABSOLUTE:
+            return value < 0 ? -value : value;
+        default:
+            break;
+    }
+
+    return value;
+}
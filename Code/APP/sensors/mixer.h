@@ -0,0 +1,151 @@
+/**
+ **********************************************************************************************************************
+ * @file        mixer.h
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        2016-10-04
+ * @brief       Channel mixer C header file.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+#ifndef MIXER_H_
+#define MIXER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sensors/joystick.h"
+
+/**********************************************************************************************************************
+ * Exported definitions and macros
+ *********************************************************************************************************************/
+#define MIXER_RESOLUTION    JOYSTICK_RESOLUTION //!< Input and output channel full scale.
+#define MIXER_LINES_MAX     8                   //!< Maximal number of mix table lines.
+
+/**********************************************************************************************************************
+ * Exported types
+ *********************************************************************************************************************/
+/**
+ * @brief   Mixer input channels.
+ */
+typedef enum
+{
+    MIXER_INPUT_LEFT_X,     //!< Left joystick X axis.
+    MIXER_INPUT_LEFT_Y,     //!< Left joystick Y axis.
+    MIXER_INPUT_RIGHT_X,    //!< Right joystick X axis.
+    MIXER_INPUT_RIGHT_Y,    //!< Right joystick Y axis.
+    MIXER_INPUT_LEFT_SW,    //!< Left joystick switch, 0 or full scale.
+    MIXER_INPUT_RIGHT_SW,   //!< Right joystick switch, 0 or full scale.
+    MIXER_INPUT_LAST,
+} mixer_input_t;
+
+/**
+ * @brief   Mixer output channels.
+ */
+typedef enum
+{
+    MIXER_OUTPUT_MOTOR_LEFT,    //!< Left motor speed.
+    MIXER_OUTPUT_MOTOR_RIGHT,   //!< Right motor speed.
+    MIXER_OUTPUT_AUX_1,         //!< Auxiliary channel 1.
+    MIXER_OUTPUT_AUX_2,         //!< Auxiliary channel 2.
+    MIXER_OUTPUT_LAST,
+} mixer_output_t;
+
+/**
+ * @brief   Mix line input curves.
+ */
+typedef enum
+{
+    MIXER_CURVE_NONE,       //!< Input as is.
+    MIXER_CURVE_POSITIVE,   //!< Positive half only, negative part is 0.
+    MIXER_CURVE_NEGATIVE,   //!< Negative half only, positive part is 0.
+    MIXER_CURVE_ABSOLUTE,   //!< Absolute value of input.
+    MIXER_CURVE_LAST,
+} mixer_curve_t;
+
+/**
+ * @brief   Mix table line. Adds weighted and offset input to output channel.
+ */
+typedef struct
+{
+    uint8_t output;     //!< Output channel, see @ref mixer_output_t. MIXER_OUTPUT_LAST - line not used.
+    uint8_t input;      //!< Input channel, see @ref mixer_input_t.
+    uint8_t curve;      //!< Input curve, see @ref mixer_curve_t.
+    int8_t weight;      //!< Weight, -100 ... 100 %.
+    int16_t offset;     //!< Offset added after weight, -MIXER_RESOLUTION ... MIXER_RESOLUTION.
+} mixer_line_t;
+
+/**********************************************************************************************************************
+ * Exported constants
+ *********************************************************************************************************************/
+
+/**********************************************************************************************************************
+ * Prototypes of exported variables
+ *********************************************************************************************************************/
+
+/**********************************************************************************************************************
+ * Prototypes of exported functions
+ *********************************************************************************************************************/
+/**
+ * @brief   Set mix table line.
+ * @note    Mix table has single writer, call setters from one thread only.
+ *
+ * @param   idx     Line index, 0 ... MIXER_LINES_MAX - 1.
+ * @param   line    Line settings. Output MIXER_OUTPUT_LAST disables the line.
+ *
+ * @return  Settings state.
+ * @retval  true    line set.
+ * @retval  false   invalid index or settings.
+ */
+bool mixer_set_line(uint8_t idx, const mixer_line_t *line);
+
+/**
+ * @brief   Get mix table line.
+ *
+ * @param   idx     Line index, 0 ... MIXER_LINES_MAX - 1.
+ * @param   line    Line settings.
+ *
+ * @return  false if index is invalid.
+ */
+bool mixer_get_line(uint8_t idx, mixer_line_t *line);
+
+/**
+ * @brief   Set output channel clipping limits.
+ *
+ * @param   output  Output channel.
+ * @param   min     Minimal value, not less than -MIXER_RESOLUTION.
+ * @param   max     Maximal value, not more than MIXER_RESOLUTION.
+ *
+ * @return  false if channel or limits are invalid.
+ */
+bool mixer_set_limits(mixer_output_t output, int16_t min, int16_t max);
+
+/**
+ * @brief   Mix input channels to output channels.
+ *
+ * @param   inputs  Input channel values, -MIXER_RESOLUTION ... MIXER_RESOLUTION.
+ * @param   outputs Output channel values, clipped to channel limits.
+ */
+void mixer_update(const int16_t inputs[MIXER_INPUT_LAST], int16_t outputs[MIXER_OUTPUT_LAST]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MIXER_H_ */
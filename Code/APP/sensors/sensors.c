@@ -22,19 +22,35 @@
  *********************************************************************************************************************/
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
 
 #include "sensors/sensors.h"
 #include "sensors/joystick.h"
+#include "sensors/mixer.h"
 
 #include "display/display.h"
 
+#include "periph/adc.h"
+
+#include "cli/cli.h"
+
 #include "debug.h"
+#include "common.h"
+#include "seqlock.h"
 #include "cmsis_os2.h"
 
 /**********************************************************************************************************************
  * Private definitions and macros
  *********************************************************************************************************************/
-#define SENSORS_READ_PERIOD     10  //!< Sensors read period in milliseconds.
+#define SENSORS_FLAG_SAMPLES    0x0001  //!< New ADC sample block thread flag.
+#define SENSORS_FLAG_WAKEUP     0x0002  //!< Standby wakeup thread flag.
+#define SENSORS_FLAG_CAL_SAVE   0x0004  //!< Joystick calibration save request thread flag.
+#define SENSORS_FLAG_CAL_RESET  0x0008  //!< Joystick calibration reset request thread flag.
+#define SENSORS_WAIT_TIMEOUT    100     //!< Maximal wait for sample block in milliseconds.
+#define SENSORS_STANDBY_DELAY   2000    //!< Idle time with display off before standby in milliseconds.
+#define SENSORS_WAKEUP_MARGIN   4096    //!< Stick movement from rest to wake up, 16 bit ADC full scale.
+#define SENSORS_STANDBY_POLL    1000    //!< Display state check period in standby in milliseconds.
 
 /**********************************************************************************************************************
  * Private typedef
@@ -50,14 +66,27 @@ const osThreadAttr_t sensors_thread_attr =
     .stack_size = 512,
     .priority = osPriorityNormal,
 };
+/** CLI command parameters. */
+static const char * const sensors_cmd_names[] = {"stats", "reset", "rate", "decim", "mix", "cal"};
+static const cli_enum_t sensors_cmd_enum = {sensors_cmd_names, 6};
 
 /**********************************************************************************************************************
  * Private variables
  *********************************************************************************************************************/
 /** Sensors thread ID. */
 osThreadId_t sensors_thread_id;
-/** Sensors data structure. */
-volatile sensors_data_t sensors_data;
+/** Sensors data, published to readers. */
+static SEQLOCK_OBJECT(sensors_data_t) sensors_data;
+/** Sensors data as last published, owned by sensors thread. */
+static sensors_data_t sensors_data_last;
+/** Sampling pipeline statistics. */
+static sensors_stats_t sensors_stats;
+/** Sequence number of last processed sample block, 0 - not synchronized. */
+static uint32_t sensors_stats_seq = 0;
+/** Completion timestamp of last processed sample block. */
+static uint32_t sensors_stats_timestamp = 0;
+/** Kernel tick of last stick activity. */
+static uint32_t sensors_active_tick = 0;
 
 /**********************************************************************************************************************
  * Exported variables
@@ -66,7 +95,47 @@ volatile sensors_data_t sensors_data;
 /**********************************************************************************************************************
  * Prototypes of local functions
  *********************************************************************************************************************/
-static void sensors_joystick_handler(void);
+/**
+ * @brief   Read joysticks, run mixer and publish sensors data.
+ *
+ * @return  Activity state.
+ * @retval  true    stick deflected or switch pressed.
+ * @retval  false   sticks at rest.
+ */
+static bool sensors_joystick_handler(void);
+
+/**
+ * @brief   ADC sample block completion callback. Wakes up sensors thread.
+ */
+static void sensors_samples_handler(void);
+
+/**
+ * @brief   ADC standby wakeup callback. Wakes up sensors thread.
+ */
+static void sensors_wakeup_handler(void);
+
+/**
+ * @brief   Put sampling to standby while display is off and sticks are at rest. Returns after stick movement.
+ */
+static void sensors_standby_handler(void);
+
+/**
+ * @brief   Handle joystick calibration requests of CLI. Calibration is saved and reset only by sensors thread, so
+ *          nvm buffer and saved calibration have single user.
+ *
+ * @param   flags   Thread flags set.
+ */
+static void sensors_cal_handler(uint32_t flags);
+
+/**
+ * @brief   Update sampling pipeline statistics with latest sample block.
+ */
+static void sensors_stats_update(void);
+
+/**
+ * @brief   CLI command "sensors" callback. See @ref cli_cmd_callback.
+ */
+static bool sensors_cmd_cb(uint8_t *data, uint32_t size, const uint8_t *cmd);
 
 /**********************************************************************************************************************
  * Exported functions
@@ -85,42 +154,339 @@ bool sensors_init(void)
 
 void sensors_thread(void *arguments)
 {
+    uint32_t flags = 0;
+
+    sensors_reset_stats();
+    adc_set_callback(sensors_samples_handler);
+    adc_set_wakeup_callback(sensors_wakeup_handler);
+    sensors_active_tick = osKernelGetTickCount();
+
     while(1)
     {
-        osDelay(SENSORS_READ_PERIOD);
-        sensors_joystick_handler();
+        // Processing is paced by sample blocks of hardware triggered ADC.
+        flags = osThreadFlagsWait(SENSORS_FLAG_SAMPLES | SENSORS_FLAG_CAL_SAVE | SENSORS_FLAG_CAL_RESET, osFlagsWaitAny,
+                                  SENSORS_WAIT_TIMEOUT);
+        if((flags & osFlagsError) == 0)
+        {
+            sensors_cal_handler(flags);
+        }
+        if(sensors_joystick_handler())
+        {
+            sensors_active_tick = osKernelGetTickCount();
+        }
+        sensors_stats_update();
+        sensors_standby_handler();
     }
 }
 
+uint32_t sensors_get_data(sensors_data_t *data)
+{
+    return SEQLOCK_SNAPSHOT(sensors_data, data);
+}
+
+void sensors_get_stats(sensors_stats_t *stats)
+{
+    __disable_irq();
+    *stats = sensors_stats;
+    __enable_irq();
+    stats->period = adc_get_block_period();
+
+    return;
+}
+
+void sensors_reset_stats(void)
+{
+    __disable_irq();
+    memset(&sensors_stats, 0, sizeof(sensors_stats));
+    sensors_stats.period_min = UINT32_MAX;
+    sensors_stats_seq = 0;
+    __enable_irq();
+
+    return;
+}
+
 /**********************************************************************************************************************
  * Private functions
  *********************************************************************************************************************/
-static void sensors_joystick_handler(void)
+static bool sensors_joystick_handler(void)
 {
     bool sw = false;
+    bool active = false;
+    bool changed = false;
     int32_t magnitude = 0;
     int32_t direction = 0;
+    int16_t inputs[MIXER_INPUT_LAST] = {0};
+    int16_t channels[MIXER_OUTPUT_LAST] = {0};
+    uint8_t i = 0;
 
-    if(sensors_data.joystick_1.state == false)
+    if(sensors_data_last.joystick_1.state == false)
     {
         joystick_init();
-        sensors_data.joystick_1.state  = true;
+        sensors_data_last.joystick_1.state  = true;
         osDelay(10); // Give some time to settle.
+        sensors_stats_seq = 0;
     }
 
     sw = joystick_get_sw(JOYSTICK_ID_LEFT);
-    joystick_get_vector(JOYSTICK_ID_LEFT, &magnitude, &direction);
+    joystick_get_axes(JOYSTICK_ID_LEFT, &inputs[MIXER_INPUT_LEFT_X], &inputs[MIXER_INPUT_LEFT_Y]);
+    joystick_get_axes(JOYSTICK_ID_RIGHT, &inputs[MIXER_INPUT_RIGHT_X], &inputs[MIXER_INPUT_RIGHT_Y]);
+    inputs[MIXER_INPUT_LEFT_SW] = sw ? MIXER_RESOLUTION : 0;
+    inputs[MIXER_INPUT_RIGHT_SW] = joystick_get_sw(JOYSTICK_ID_RIGHT) ? MIXER_RESOLUTION : 0;
+
+    magnitude = joystick_magnitude(inputs[MIXER_INPUT_LEFT_X], inputs[MIXER_INPUT_LEFT_Y]);
+    direction = joystick_direction(inputs[MIXER_INPUT_LEFT_X], inputs[MIXER_INPUT_LEFT_Y]);
+    mixer_update(inputs, channels);
+    for(i = 0; i < MIXER_INPUT_LAST; i++)
+    {
+        active |= inputs[i] != 0;
+    }
 
     if(magnitude > 0 && direction > 0)
     {
         display_keep_on();
     }
 
+    for(i = 0; i < MIXER_OUTPUT_LAST; i++)
+    {
+        changed |= sensors_data_last.channels[i] != channels[i];
+    }
+    if(!changed &&
+       sensors_data_last.joystick_1.sw == sw &&
+       sensors_data_last.joystick_1.magnitude == magnitude &&
+       sensors_data_last.joystick_1.direction == direction)
+    {
+        return active;
+    }
+
+    sensors_data_last.joystick_1.sw  = sw;
+    sensors_data_last.joystick_1.magnitude = magnitude;
+    sensors_data_last.joystick_1.direction = direction;
+    for(i = 0; i < MIXER_OUTPUT_LAST; i++)
+    {
+        sensors_data_last.channels[i] = channels[i];
+    }
+    SEQLOCK_PUBLISH(sensors_data, &sensors_data_last);
+
+    display_refresh();
+
+    return active;
+}
+
+static void sensors_samples_handler(void)
+{
+    osThreadFlagsSet(sensors_thread_id, SENSORS_FLAG_SAMPLES);
+
+    return;
+}
+
+static void sensors_wakeup_handler(void)
+{
+    osThreadFlagsSet(sensors_thread_id, SENSORS_FLAG_WAKEUP);
+
+    return;
+}
+
+static void sensors_standby_handler(void)
+{
+    if(display_power_state() || osKernelGetTickCount() - sensors_active_tick < SENSORS_STANDBY_DELAY)
+    {
+        return;
+    }
+
+    // Sticks are at rest, good time to persist learned calibration.
+    joystick_save();
+
+    // Sampling does not run the CPU here. Stick movement wakes up through threshold compare interrupt, display
+    // turned on by other means is picked up by slow poll.
+    osThreadFlagsClear(SENSORS_FLAG_WAKEUP);
+    adc_standby_enter(SENSORS_WAKEUP_MARGIN);
+    while(osThreadFlagsWait(SENSORS_FLAG_WAKEUP, osFlagsWaitAny, SENSORS_STANDBY_POLL) == (uint32_t)osFlagsErrorTimeout &&
+          !display_power_state());
+    adc_standby_exit();
+
     __disable_irq();
-    sensors_data.joystick_1.sw  = sw;
-    sensors_data.joystick_1.magnitude = magnitude;
-    sensors_data.joystick_1.direction = direction;
+    sensors_stats.wakeups++;
+    sensors_stats_seq = 0;
     __enable_irq();
+    sensors_active_tick = osKernelGetTickCount();
+    display_turn_on();
 
     return;
 }
+
+static void sensors_cal_handler(uint32_t flags)
+{
+    uint8_t id = 0;
+
+    if(flags & SENSORS_FLAG_CAL_RESET)
+    {
+        // Sticks must be released, travel is learned again from measured center.
+        for(id = 0; id < JOYSTICK_ID_LAST; id++)
+        {
+            joystick_calibrate((joystick_id_t)id);
+        }
+        DEBUG_SENSORS("Joystick calibration reset.");
+    }
+    if(flags & SENSORS_FLAG_CAL_SAVE)
+    {
+        if(joystick_save())
+        {
+            DEBUG_SENSORS("Joystick calibration saved.");
+        }
+        else
+        {
+            DEBUG_LOG(SENSORS, ERROR, "Failed to save joystick calibration.");
+        }
+    }
+
+    return;
+}
+
+static void sensors_stats_update(void)
+{
+    adc_samples_t samples;
+    uint32_t period = 0;
+    uint32_t latency = 0;
+
+    if(!adc_get_samples(&samples) || samples.seq == sensors_stats_seq)
+    {
+        return;
+    }
+    latency = osKernelGetSysTimerCount() - samples.timestamp;
+
+    __disable_irq();
+    if(sensors_stats_seq != 0)
+    {
+        sensors_stats.missed += samples.seq - sensors_stats_seq - 1;
+        if(samples.seq == sensors_stats_seq + 1)
+        {
+            period = samples.timestamp - sensors_stats_timestamp;
+            sensors_stats.period_min = MIN(sensors_stats.period_min, period);
+            sensors_stats.period_max = MAX(sensors_stats.period_max, period);
+        }
+    }
+    sensors_stats.latency_max = MAX(sensors_stats.latency_max, latency);
+    sensors_stats.blocks++;
+    __enable_irq();
+
+    sensors_stats_seq = samples.seq;
+    sensors_stats_timestamp = samples.timestamp;
+
+    return;
+}
+
+static bool sensors_cmd_cb(uint8_t *data, uint32_t size, const uint8_t *cmd)
+{
+    const uint8_t *prm = NULL;
+    uint8_t prm_size = 0;
+    sensors_stats_t stats = {0};
+    mixer_line_t line = {0};
+    joystick_cal_t cal = {0};
+    sensors_data_t sensors;
+    uint32_t freq = osKernelGetSysTimerFreq() / 1000000;
+    uint32_t id = 0;
+    int32_t value = 0;
+    int32_t ch = 0;
+
+    switch(cli_get_enum(cmd, 1, &sensors_cmd_enum))
+    {
+        case 0:
+            sensors_get_stats(&stats);
+            if(stats.blocks < 2)
+            {
+                stats.period_min = 0;
+            }
+            DEBUG_CLI("# Sensors stats:");
+            DEBUG_CLI("ADC rate ...... %d Hz.", adc_get_rate());
+            for(id = 0; id < ADC_ID_LAST; id++)
+            {
+                DEBUG_CLI("Decimation %d .. %d (%d Hz).", id, adc_get_decimation((adc_id_t)id),
+                      adc_get_rate() / adc_get_decimation((adc_id_t)id));
+            }
+            DEBUG_CLI("Blocks ........ %d", stats.blocks);
+            DEBUG_CLI("Missed ........ %d", stats.missed);
+            DEBUG_CLI("Period ........ %d us (min %d us, max %d us).",
+                  stats.period / freq, stats.period_min / freq, stats.period_max / freq);
+            DEBUG_CLI("Latency max ... %d us.", stats.latency_max / freq);
+            DEBUG_CLI("Wakeups ....... %d", stats.wakeups);
+            break;
+        case 1:
+            sensors_reset_stats();
+            DEBUG_CLI("Sensors stats reset.");
+            break;
+        case 2:
+            if(cli_get_parameter(cmd, 2, &prm_size) != NULL)
+            {
+                if(!cli_get_int(cmd, 2, &value) || value < 0 || !adc_set_rate((uint32_t)value))
+                {
+                    snprintf((char *)data, size, "Rate must be %d ... %d Hz.", ADC_RATE_MIN, ADC_RATE_MAX);
+                    return true;
+                }
+                sensors_reset_stats();
+            }
+            DEBUG_CLI("ADC rate %d Hz.", adc_get_rate());
+            break;
+        case 3:
+            if(!cli_get_int(cmd, 2, &ch) || ch < 0 || ch >= ADC_ID_LAST ||
+               !cli_get_int(cmd, 3, &value) || value < 0 || !adc_set_decimation((adc_id_t)ch, (uint32_t)value))
+            {
+                snprintf((char *)data, size, "Use: decim <0 ... %d> <1, 2, 4 ... %d>.", ADC_ID_LAST - 1, ADC_DECIMATION_MAX);
+                return true;
+            }
+            sensors_reset_stats();
+            DEBUG_CLI("Channel %d decimation %d.", ch, adc_get_decimation((adc_id_t)ch));
+            break;
+        case 4:
+            DEBUG_CLI("# Mixer lines (output, input, curve, weight %%, offset):");
+            for(id = 0; id < MIXER_LINES_MAX; id++)
+            {
+                if(mixer_get_line((uint8_t)id, &line) && line.output < MIXER_OUTPUT_LAST)
+                {
+                    DEBUG_CLI("%d: %d, %d, %d, %d, %d", id, line.output, line.input, line.curve, line.weight, line.offset);
+                }
+            }
+            DEBUG_CLI("# Mixer outputs:");
+            sensors_get_data(&sensors);
+            for(id = 0; id < MIXER_OUTPUT_LAST; id++)
+            {
+                DEBUG_CLI("%d: %d", id, sensors.channels[id]);
+            }
+            break;
+        case 5:
+            prm = cli_get_parameter(cmd, 2, &prm_size);
+            if(prm != NULL && prm_size == 4 && memcmp(prm, "save", 4) == 0)
+            {
+                osThreadFlagsSet(sensors_thread_id, SENSORS_FLAG_CAL_SAVE);
+                DEBUG_CLI("Calibration save requested.");
+                break;
+            }
+            if(prm != NULL && prm_size == 5 && memcmp(prm, "reset", 5) == 0)
+            {
+                osThreadFlagsSet(sensors_thread_id, SENSORS_FLAG_CAL_RESET);
+                DEBUG_CLI("Calibration reset requested, release sticks.");
+                break;
+            }
+            if(prm != NULL)
+            {
+                snprintf((char *)data, size, "Use: cal [save|reset].");
+                return true;
+            }
+            DEBUG_CLI("# Joystick calibration (zero, min, max):");
+            for(id = 0; id < JOYSTICK_ID_LAST; id++)
+            {
+                joystick_get_cal((joystick_id_t)id, JOYSTICK_AXIS_X, &cal);
+                DEBUG_CLI("%d X: %d, %d, %d", id, cal.zero, cal.min, cal.max);
+                joystick_get_cal((joystick_id_t)id, JOYSTICK_AXIS_Y, &cal);
+                DEBUG_CLI("%d Y: %d, %d, %d", id, cal.zero, cal.min, cal.max);
+            }
+            break;
+        default:
+            snprintf((char *)data, size, "Unknown parameter. Use: stats, reset, rate, decim, mix or cal.");
+            return true;
+    }
+
+    return false;
+}
+CLI_CMD_REGISTER(sensors,
+                 "sensors   Sampling statistics and rate: sensors <stats|reset|rate [Hz]|decim <ch> <ratio>|mix|cal [save|reset]>.",
+                 sensors_cmd_cb, -1);
@@ -27,8 +27,11 @@ extern "C" {
 /**********************************************************************************************************************
  * Includes
  *********************************************************************************************************************/
+#include <stdint.h>
 #include <stdbool.h>
 
+#include "sensors/mixer.h"
+
 /**********************************************************************************************************************
  * Exported definitions and macros
  *********************************************************************************************************************/
@@ -45,8 +48,23 @@ typedef struct
         int32_t direction;
         bool sw;
     } joystick_1;
+    int16_t channels[MIXER_OUTPUT_LAST];    //!< Mixed output channels, see @ref mixer_output_t.
 } sensors_data_t;
 
+/**
+ * @brief   Sampling pipeline statistics. Times are in RTOS system timer ticks.
+ */
+typedef struct
+{
+    uint32_t blocks;        //!< Processed sample blocks.
+    uint32_t missed;        //!< Sample blocks completed but not processed in time.
+    uint32_t period;        //!< Nominal sample block period.
+    uint32_t period_min;    //!< Minimal period between processed consecutive blocks.
+    uint32_t period_max;    //!< Maximal period between processed consecutive blocks.
+    uint32_t latency_max;   //!< Maximal delay from block completion to processing.
+    uint32_t wakeups;       //!< Wakeups from standby.
+} sensors_stats_t;
+
 /**********************************************************************************************************************
  * Exported constants
  *********************************************************************************************************************/
@@ -54,7 +72,6 @@ typedef struct
 /**********************************************************************************************************************
  * Prototypes of exported variables
  *********************************************************************************************************************/
-extern volatile sensors_data_t sensors_data;
 
 /**********************************************************************************************************************
  * Prototypes of exported functions
@@ -62,6 +79,17 @@ extern volatile sensors_data_t sensors_data;
 bool sensors_init(void);
 void sensors_thread(void *arguments);
 
+/**
+ * @brief   Get consistent snapshot of latest sensors data. Does not block and does not mask interrupts.
+ *
+ * @param   data    Pointer where to store sensors data.
+ *
+ * @return  Publication sequence number, 0 - no data yet.
+ */
+uint32_t sensors_get_data(sensors_data_t *data);
+void sensors_get_stats(sensors_stats_t *stats);
+void sensors_reset_stats(void);
+
 #ifdef __cplusplus
 }
 #endif
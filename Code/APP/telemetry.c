@@ -0,0 +1,423 @@
+/**
+ **********************************************************************************************************************
+ * @file        telemetry.c
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        2017-05-20
+ * @brief       Binary telemetry stream C source file.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "telemetry.h"
+#include "app.h"
+#include "buttons.h"
+#include "debug.h"
+
+#include "cli/cli.h"
+#include "radio/radio.h"
+#include "sensors/sensors.h"
+
+#include "cobs.h"
+#include "chip.h"
+#include "cmsis_os2.h"
+
+/**********************************************************************************************************************
+ * Private definitions and macros
+ *********************************************************************************************************************/
+#define TELEMETRY_FLAG_START    0x0001  //!< Thread flag: stream rate was set.
+#define TELEMETRY_LOAD_PERIOD   1000    //!< CPU load record period in milliseconds.
+#define TELEMETRY_HEADER_SIZE   6       //!< Record type, sequence and tick.
+#define TELEMETRY_PAYLOAD_MAX   32      //!< Maximal record payload size in bytes.
+#define TELEMETRY_CRC_SIZE      2       //!< Record CRC size in bytes.
+
+/** Record size before encoding. */
+#define TELEMETRY_RECORD_MAX    (TELEMETRY_HEADER_SIZE + TELEMETRY_PAYLOAD_MAX + TELEMETRY_CRC_SIZE)
+/** Frame size: delimiter, encoded record, delimiter. */
+#define TELEMETRY_FRAME_MAX     (COBS_ENCODED_MAX(TELEMETRY_RECORD_MAX) + 2)
+
+/**********************************************************************************************************************
+ * Private typedef
+ *********************************************************************************************************************/
+/** Payload of @ref TELEMETRY_RECORD_SENSORS. */
+typedef struct __attribute__((packed))
+{
+    int32_t magnitude;
+    int32_t direction;
+    uint8_t state;
+    uint8_t sw;
+    int16_t channels[MIXER_OUTPUT_LAST];
+} telemetry_sensors_t;
+
+/** Payload of @ref TELEMETRY_RECORD_RADIO. */
+typedef struct __attribute__((packed))
+{
+    uint32_t tx_counter;
+    uint32_t tx_lost_counter;
+    uint32_t rx_counter;
+    uint8_t rtr_current;
+    uint8_t rtr;
+    uint8_t quality;
+} telemetry_radio_t;
+
+/** Payload of @ref TELEMETRY_RECORD_LOAD. */
+typedef struct __attribute__((packed))
+{
+    uint16_t cpu_load;          //!< Total CPU load of threads and interrupts (not idle) in 0.1 %.
+    uint32_t log_dropped;       //!< Log and telemetry records dropped because of full log ring.
+    uint32_t dropped;           //!< Telemetry records dropped.
+} telemetry_load_t;
+
+/** Payload of @ref TELEMETRY_RECORD_EVENT. */
+typedef struct __attribute__((packed))
+{
+    uint16_t id;
+    int32_t value;
+} telemetry_marker_t;
+
+/**********************************************************************************************************************
+ * Private constants
+ *********************************************************************************************************************/
+/** Telemetry thread attributes. */
+const osThreadAttr_t telemetry_thread_attr =
+{
+    .name = "TELEMETRY",
+    .stack_size = 512,
+    .priority = osPriorityBelowNormal,
+};
+/** CRC-16/CCITT (polynomial 0x1021) table for 4 bits. */
+static const uint16_t telemetry_crc_table[16] =
+{
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+/** CLI command parameters. */
+static const char * const telemetry_cmd_names[] = {"off"};
+static const cli_enum_t telemetry_cmd_enum = {telemetry_cmd_names, 1};
+
+/**********************************************************************************************************************
+ * Private variables
+ *********************************************************************************************************************/
+/** Telemetry thread ID. */
+osThreadId_t telemetry_thread_id;
+/** Record rate in Hz, 0 - stream off. */
+static volatile uint32_t telemetry_rate = 0;
+/** Record sequence number. */
+static volatile uint8_t telemetry_seq = 0;
+/** Dropped records counter. */
+static volatile uint32_t telemetry_dropped = 0;
+/** Idle cycles count at last load record. See @ref app_get_idle_cycles. */
+static uint32_t telemetry_idle_cycles = 0;
+
+/**********************************************************************************************************************
+ * Exported variables
+ *********************************************************************************************************************/
+
+/**********************************************************************************************************************
+ * Prototypes of local functions
+ *********************************************************************************************************************/
+/**
+ * @brief   Build record, encode it to frame and queue it after log output.
+ *
+ * @param   type    Record type. See @ref telemetry_record_t.
+ * @param   payload Record payload.
+ * @param   size    Size of payload in bytes, not more than @ref TELEMETRY_PAYLOAD_MAX.
+ */
+static void telemetry_send(telemetry_record_t type, const void *payload, uint8_t size);
+
+/**
+ * @brief   Calculate CRC-16/CCITT, initial value 0xFFFF. Same as CRC engine CCITT mode used by NVM.
+ *
+ * @param   data    Data.
+ * @param   size    Size of data in bytes.
+ *
+ * @return  CRC.
+ */
+static uint16_t telemetry_crc(const uint8_t *data, uint32_t size);
+
+/**
+ * @brief   Send sensors and radio records if they have new data.
+ *
+ * @param   sensors_seq Publication sequence of last sent sensors data.
+ * @param   radio_seq   Publication sequence of last sent radio data.
+ */
+static void telemetry_sample(uint32_t *sensors_seq, uint32_t *radio_seq);
+
+/**
+ * @brief   Send total CPU load record.
+ *
+ * @param   start   System timer count at start of measured period, updated to current count.
+ */
+static void telemetry_load(uint32_t *start);
+
+/**
+ * @brief   Button events subscriber, sends event markers.
+ *
+ * @param   event   Button event.
+ */
+static void telemetry_buttons_cb(const buttons_event_t *event);
+
+/**
+ * @brief   CLI command "telemetry" callback. See @ref cli_cmd_callback.
+ */
+static bool telemetry_cmd_cb(uint8_t *data, uint32_t size, const uint8_t *cmd);
+
+/**********************************************************************************************************************
+ * Exported functions
+ *********************************************************************************************************************/
+bool telemetry_init(void)
+{
+    buttons_subscribe((1 << BUTTONS_ID_LAST) - 1, (1 << BUTTONS_EVENT_LAST) - 1, &telemetry_buttons_cb);
+
+    // Create telemetry thread.
+    if((telemetry_thread_id = osThreadNew(&telemetry_thread, NULL, &telemetry_thread_attr)) == NULL)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+void telemetry_thread(void *arguments)
+{
+    uint32_t sensors_seq = 0;
+    uint32_t radio_seq = 0;
+    uint32_t load_start = 0;
+    uint32_t load_tick = 0;
+    uint32_t next = 0;
+    uint32_t error = 0;
+    uint32_t rate = 0;
+
+    while(1)
+    {
+        if((rate = telemetry_rate) == 0)
+        {
+            // Stream off, nothing runs until rate is set.
+            osThreadFlagsWait(TELEMETRY_FLAG_START, osFlagsWaitAny, osWaitForever);
+            next = osKernelGetTickCount();
+            load_tick = next;
+            load_start = osKernelGetSysTimerCount();
+            error = 0;
+            telemetry_event(TELEMETRY_EVENT_START, telemetry_rate);
+            continue;
+        }
+
+        // Period in whole ticks, remainder is spread over periods so any rate up to tick frequency is exact.
+        next += 1000 / rate;
+        error += 1000 % rate;
+        if(error >= rate)
+        {
+            error -= rate;
+            next++;
+        }
+        if((int32_t)(next - osKernelGetTickCount()) > 0)
+        {
+            osDelayUntil(next);
+        }
+        else
+        {
+            // Fell behind, don't send burst of records.
+            next = osKernelGetTickCount();
+        }
+
+        telemetry_sample(&sensors_seq, &radio_seq);
+        if(osKernelGetTickCount() - load_tick >= TELEMETRY_LOAD_PERIOD)
+        {
+            load_tick += TELEMETRY_LOAD_PERIOD;
+            telemetry_load(&load_start);
+        }
+    }
+}
+
+bool telemetry_set_rate(uint32_t rate)
+{
+    if(rate > TELEMETRY_RATE_MAX)
+    {
+        return false;
+    }
+
+    telemetry_rate = rate;
+    if(rate != 0 && telemetry_thread_id != NULL)
+    {
+        osThreadFlagsSet(telemetry_thread_id, TELEMETRY_FLAG_START);
+    }
+
+    return true;
+}
+
+uint32_t telemetry_get_rate(void)
+{
+    return telemetry_rate;
+}
+
+void telemetry_event(uint16_t id, int32_t value)
+{
+    telemetry_marker_t marker;
+
+    if(telemetry_rate == 0)
+    {
+        return;
+    }
+
+    marker.id = id;
+    marker.value = value;
+    telemetry_send(TELEMETRY_RECORD_EVENT, &marker, sizeof(marker));
+
+    return;
+}
+
+/**********************************************************************************************************************
+ * Private functions
+ *********************************************************************************************************************/
+static void telemetry_send(telemetry_record_t type, const void *payload, uint8_t size)
+{
+    uint8_t record[TELEMETRY_RECORD_MAX];
+    uint8_t frame[TELEMETRY_FRAME_MAX];
+    uint32_t tick = osKernelGetTickCount();
+    uint16_t crc = 0;
+    uint32_t len = 0;
+
+    record[0] = type;
+    __disable_irq();
+    record[1] = telemetry_seq++;
+    __enable_irq();
+    memcpy(&record[2], &tick, sizeof(tick));
+    memcpy(&record[TELEMETRY_HEADER_SIZE], payload, size);
+    crc = telemetry_crc(record, TELEMETRY_HEADER_SIZE + size);
+    memcpy(&record[TELEMETRY_HEADER_SIZE + size], &crc, sizeof(crc));
+
+    // Leading delimiter separates frame from log text sent before it.
+    frame[0] = 0x00;
+    len = 1 + cobs_encode(record, TELEMETRY_HEADER_SIZE + size + TELEMETRY_CRC_SIZE, &frame[1]);
+    frame[len++] = 0x00;
+
+    if(debug_send_raw_os(frame, len) != true)
+    {
+        telemetry_dropped++;
+    }
+
+    return;
+}
+
+static uint16_t telemetry_crc(const uint8_t *data, uint32_t size)
+{
+    uint16_t crc = 0xFFFF;
+
+    while(size--)
+    {
+        crc = (crc << 4) ^ telemetry_crc_table[(crc >> 12) ^ (*data >> 4)];
+        crc = (crc << 4) ^ telemetry_crc_table[(crc >> 12) ^ (*data & 0x0F)];
+        data++;
+    }
+
+    return crc;
+}
+
+static void telemetry_sample(uint32_t *sensors_seq, uint32_t *radio_seq)
+{
+    telemetry_sensors_t sensors_rec;
+    telemetry_radio_t radio_rec;
+    sensors_data_t sensors;
+    radio_data_t radio;
+    uint32_t seq = 0;
+    uint8_t i = 0;
+
+    if((seq = sensors_get_data(&sensors)) != *sensors_seq)
+    {
+        *sensors_seq = seq;
+        sensors_rec.magnitude = sensors.joystick_1.magnitude;
+        sensors_rec.direction = sensors.joystick_1.direction;
+        sensors_rec.state = sensors.joystick_1.state;
+        sensors_rec.sw = sensors.joystick_1.sw;
+        for(i = 0; i < MIXER_OUTPUT_LAST; i++)
+        {
+            sensors_rec.channels[i] = sensors.channels[i];
+        }
+        telemetry_send(TELEMETRY_RECORD_SENSORS, &sensors_rec, sizeof(sensors_rec));
+    }
+
+    if((seq = radio_get_data(&radio)) != *radio_seq)
+    {
+        *radio_seq = seq;
+        radio_rec.tx_counter = radio.tx_counter;
+        radio_rec.tx_lost_counter = radio.tx_lost_counter;
+        radio_rec.rx_counter = radio.rx_counter;
+        radio_rec.rtr_current = (uint8_t)radio.rtr_current;
+        radio_rec.rtr = (uint8_t)radio.rtr;
+        radio_rec.quality = (uint8_t)radio.quality;
+        telemetry_send(TELEMETRY_RECORD_RADIO, &radio_rec, sizeof(radio_rec));
+    }
+
+    return;
+}
+
+static void telemetry_load(uint32_t *start)
+{
+    telemetry_load_t load;
+    uint32_t now = 0;
+    uint32_t idle = 0;
+    uint32_t total = 0;
+
+    __disable_irq();
+    now = osKernelGetSysTimerCount();
+    idle = app_get_idle_cycles();
+    __enable_irq();
+
+    total = now - *start;
+    idle -= telemetry_idle_cycles;
+    telemetry_idle_cycles += idle;
+    *start = now;
+    idle = idle > total ? total : idle;
+    load.cpu_load = total != 0 ? (uint16_t)(1000 - (uint32_t)(((uint64_t)idle * 1000) / total)) : 0;
+    load.log_dropped = debug_get_dropped();
+    load.dropped = telemetry_dropped;
+    telemetry_send(TELEMETRY_RECORD_LOAD, &load, sizeof(load));
+
+    return;
+}
+
+static void telemetry_buttons_cb(const buttons_event_t *event)
+{
+    telemetry_event(TELEMETRY_EVENT_BUTTON, (event->id << 8) | event->type);
+
+    return;
+}
+
+static bool telemetry_cmd_cb(uint8_t *data, uint32_t size, const uint8_t *cmd)
+{
+    uint8_t prm_size = 0;
+    int32_t rate = 0;
+
+    if(cli_get_enum(cmd, 1, &telemetry_cmd_enum) == 0)
+    {
+        telemetry_set_rate(0);
+    }
+    else if(cli_get_parameter(cmd, 1, &prm_size) != NULL)
+    {
+        if(!cli_get_int(cmd, 1, &rate) || rate <= 0 || !telemetry_set_rate((uint32_t)rate))
+        {
+            snprintf((char *)data, size, "Rate must be 1 ... %d Hz.", TELEMETRY_RATE_MAX);
+            return true;
+        }
+    }
+    DEBUG_CLI("Telemetry %d Hz (dropped %d).", telemetry_get_rate(), telemetry_dropped);
+
+    return false;
+}
+CLI_CMD_REGISTER(telemetry, "telemetry Binary telemetry stream: telemetry [off|<rate Hz>].", telemetry_cmd_cb, -1);
@@ -0,0 +1,121 @@
+/**
+ **********************************************************************************************************************
+ * @file        telemetry.h
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        2017-05-20
+ * @brief       Binary telemetry stream C header file.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/**********************************************************************************************************************
+ * Exported definitions and macros
+ *********************************************************************************************************************/
+#define TELEMETRY_RATE_MAX      500     //!< Maximal record rate in Hz.
+
+/**********************************************************************************************************************
+ * Exported types
+ *********************************************************************************************************************/
+/**
+ * @brief   Telemetry record types. Record is COBS encoded and delimited by zero bytes:
+ *          type, sequence, tick (4), payload, CRC-16/CCITT (2). Multi-byte fields are little endian.
+ */
+typedef enum
+{
+    TELEMETRY_RECORD_SENSORS = 1,   //!< Joystick vector and mixer outputs, sent on new data at stream rate.
+    TELEMETRY_RECORD_RADIO,         //!< Link statistics, sent on new data.
+    TELEMETRY_RECORD_LOAD,          //!< Total CPU load and dropped records, sent every second.
+    TELEMETRY_RECORD_EVENT,         //!< Event marker. See @ref telemetry_event_t.
+} telemetry_record_t;
+
+/**
+ * @brief   Event marker IDs.
+ */
+typedef enum
+{
+    TELEMETRY_EVENT_START,      //!< Stream started, value is rate in Hz.
+    TELEMETRY_EVENT_BUTTON,     //!< Button event, value is button ID << 8 | event type.
+    TELEMETRY_EVENT_LINK,       //!< Radio link state changed, value 1 - connected, 0 - disconnected.
+    TELEMETRY_EVENT_USER,       //!< First ID free for temporary markers.
+} telemetry_event_t;
+
+/**********************************************************************************************************************
+ * Prototypes of exported constants
+ *********************************************************************************************************************/
+
+/**********************************************************************************************************************
+ * Prototypes of exported variables
+ *********************************************************************************************************************/
+
+/**********************************************************************************************************************
+ * Prototypes of exported functions
+ *********************************************************************************************************************/
+/**
+ * @brief   Initialize telemetry. Stream is off until rate is set.
+ *
+ * @return  State of initialization.
+ * @retval  0   failed.
+ * @retval  1   success.
+ */
+bool telemetry_init(void);
+
+/**
+ * @brief   Telemetry thread.
+ *
+ * @param   arguments   Not used.
+ */
+void telemetry_thread(void *arguments);
+
+/**
+ * @brief   Set record rate.
+ *
+ * @param   rate    Rate in Hz, 0 - stream off.
+ *
+ * @return  false if rate is more than @ref TELEMETRY_RATE_MAX.
+ */
+bool telemetry_set_rate(uint32_t rate);
+
+/**
+ * @brief   Get record rate.
+ *
+ * @return  Rate in Hz, 0 - stream off.
+ */
+uint32_t telemetry_get_rate(void);
+
+/**
+ * @brief   Send event marker if stream is on. Never blocks.
+ *
+ * @note    Can be called from interrupt.
+ *
+ * @param   id      Event ID. See @ref telemetry_event_t.
+ * @param   value   Event value.
+ */
+void telemetry_event(uint16_t id, int32_t value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TELEMETRY_H_ */
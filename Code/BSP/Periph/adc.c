@@ -21,14 +21,19 @@
  * Includes
  *********************************************************************************************************************/
 #include <stdint.h>
+#include <string.h>
 
 #include "adc.h"
 
 #include "chip.h"
+#include "seqlock.h"
+
+#include "cmsis_os2.h"
 
 /**********************************************************************************************************************
  * Private definitions and macros
  *********************************************************************************************************************/
+#define ADC_CHANNELS_MASK   0xFFF   //!< All ADC channels bit mask, also threshold compare flags of all channels.
 
 /**********************************************************************************************************************
  * Private typedef
@@ -44,6 +49,17 @@ typedef struct
     uint32_t modefunc;  //!< Pin mux settings.
 } adc_ch_t;
 
+/**
+ * @brief   2nd order CIC decimator state.
+ */
+typedef struct
+{
+    uint32_t integrator[2]; //!< Integrator stages, running at trigger rate. Wrap around is expected.
+    uint32_t comb[2];       //!< Comb stages delay, running at output rate.
+    uint8_t count;          //!< Sequences since last output.
+    uint8_t shift;          //!< Decimation ratio log2.
+} adc_cic_t;
+
 /**********************************************************************************************************************
  * Private constants
  *********************************************************************************************************************/
@@ -63,6 +79,20 @@ const adc_ch_t adc_ch_list[ADC_ID_LAST] =
 /**********************************************************************************************************************
  * Private variables
  *********************************************************************************************************************/
+/** Latest sample block, published by interrupt to readers. */
+static SEQLOCK_OBJECT(adc_samples_t) adc_samples;
+/** Decimator of each channel. */
+static adc_cic_t adc_cic[ADC_ID_LAST];
+/** Latest decimated value of each channel. */
+static uint16_t adc_value[ADC_ID_LAST];
+/** Sequence trigger rate in Hz. */
+static uint32_t adc_rate = ADC_RATE;
+/** Sample block completion callback. */
+static volatile adc_samples_cb_t adc_samples_cb = NULL;
+/** Standby wakeup callback. */
+static volatile adc_wakeup_cb_t adc_wakeup_cb = NULL;
+/** Standby state. */
+static volatile bool adc_standby = false;
 
 /**********************************************************************************************************************
  * Exported variables
@@ -71,6 +101,21 @@ const adc_ch_t adc_ch_list[ADC_ID_LAST] =
 /**********************************************************************************************************************
  * Prototypes of local functions
  *********************************************************************************************************************/
+/**
+ * @brief   Get log2 of decimation ratio.
+ *
+ * @param   ratio   Decimation ratio.
+ *
+ * @return  log2 of ratio, UINT8_MAX if ratio is not power of 2 or out of range.
+ */
+static uint8_t adc_decimation_shift(uint32_t ratio);
+
+/**
+ * @brief   Set trigger timer period.
+ *
+ * @param   rate    Trigger rate in Hz.
+ */
+static void adc_timer_set(uint32_t rate);
 
 /**********************************************************************************************************************
  * Exported functions
@@ -78,7 +123,16 @@ const adc_ch_t adc_ch_list[ADC_ID_LAST] =
 void adc_init(void)
 {
     uint8_t i = 0;
-    uint32_t seq_opt = (ADC_SEQ_CTRL_CHANSEL(0) | ADC_SEQ_CTRL_LOWPRIO | ADC_SEQ_CTRL_MODE_EOS);
+    uint32_t seq_opt = (ADC_SEQ_CTRL_CHANSEL(0) | ADC_SEQ_CTRL_LOWPRIO | ADC_SEQ_CTRL_MODE_EOS |
+                        ADC_SEQ_CTRL_HWTRIG_CT32B0_MAT0 | ADC_SEQ_CTRL_HWTRIG_POLPOS);
+
+    /* Reset decimators */
+    for(i = 0; i < ADC_ID_LAST; i++)
+    {
+        memset(&adc_cic[i], 0, sizeof(adc_cic_t));
+        adc_cic[i].shift = adc_decimation_shift(ADC_DECIMATION);
+        adc_value[i] = UINT16_MAX;
+    }
 
     /* Setup ADC for 12-bit mode and normal power */
     Chip_ADC_Init(LPC_ADC, 0);
@@ -119,58 +173,49 @@ void adc_init(void)
     /* Use higher voltage trim */
     Chip_ADC_SetTrim(LPC_ADC, ADC_TRIM_VRANGE_HIGHV);
 
-    /* Setup threshold 0 low and high values to about 25% and 75% of max */
-    Chip_ADC_SetThrLowValue(LPC_ADC, 0, ((1 * 0xFFF) / 4));
-    Chip_ADC_SetThrHighValue(LPC_ADC, 0, ((3 * 0xFFF) / 4));
-    
     /* Clear all pending interrupts */
     Chip_ADC_ClearFlags(LPC_ADC, Chip_ADC_GetFlags(LPC_ADC));
-    /* Enable ADC overrun and sequence A completion interrupts */
-    //Chip_ADC_EnableInt(LPC_ADC, (ADC_INTEN_SEQA_ENABLE));
-    /* Enable ADC NVIC interrupt */
-    //NVIC_EnableIRQ(ADC_A_IRQn);
-    NVIC_DisableIRQ(ADC_A_IRQn);
-    NVIC_DisableIRQ(ADC_B_IRQn);
+    /* Enable ADC sequence A completion interrupt */
+    Chip_ADC_EnableInt(LPC_ADC, (ADC_INTEN_SEQA_ENABLE));
+    /* Enable ADC NVIC interrupts, threshold compare interrupt is enabled only in standby */
+    NVIC_EnableIRQ(ADC_A_IRQn);
+    NVIC_EnableIRQ(ADC_B_IRQn);
 
-    /* Enable sequencer */
+    /* Enable sequencer, conversions are started by trigger timer */
     Chip_ADC_EnableSequencer(LPC_ADC, ADC_SEQA_IDX);
-    /* Start Burst sequencer. */
-    Chip_ADC_StartBurstSequencer(LPC_ADC, ADC_SEQA_IDX);
+
+    /* Setup trigger timer: match 0 output toggles, rising edge starts sequence */
+    Chip_TIMER_Init(LPC_TIMER32_0);
+    Chip_TIMER_Reset(LPC_TIMER32_0);
+    Chip_TIMER_PrescaleSet(LPC_TIMER32_0, 0);
+    Chip_TIMER_ResetOnMatchEnable(LPC_TIMER32_0, 0);
+    Chip_TIMER_ExtMatchControlSet(LPC_TIMER32_0, 0, TIMER_EXTMATCH_TOGGLE, 0);
+    adc_set_rate(adc_rate);
+    Chip_TIMER_Enable(LPC_TIMER32_0);
 
     return;
 }
 
 uint32_t adc_read_raw(adc_id_t id)
 {
-    uint32_t raw = 0;
-    uint32_t value = 0;
-    uint32_t i = ADC_AVG_COUNT;
-    uint32_t j = 0;
+    adc_samples_t samples;
 
-    if(adc_ch_list[id].channel == UINT8_MAX)
+    if(adc_ch_list[id].channel == UINT8_MAX || !adc_get_samples(&samples))
     {
         return UINT32_MAX;
     }
 
-    do
-    {
-        //Chip_ADC_StartSequencer(LPC_ADC, ADC_SEQA_IDX);
-        while((raw = Chip_ADC_GetDataReg(LPC_ADC, adc_ch_list[id].channel)) & ADC_SEQ_GDAT_DATAVALID);
-        value += ADC_DR_RESULT(raw);
-        j++;
-    }
-    while(i-- > 1);
-    
-    if(j > 0)
-    {
-        value = value / j;
-    }
-    else
-    {
-        value = UINT32_MAX;
-    }
+    return samples.raw[id];
+}
+
+bool adc_is_used(adc_id_t id)
+{
+    return id < ADC_ID_LAST && adc_ch_list[id].channel != UINT8_MAX;
+}
 
-    return value;
+bool adc_get_samples(adc_samples_t *samples)
+{
+    return SEQLOCK_SNAPSHOT(adc_samples, samples) != 0;
 }
 
 uint32_t adc_read_volt(adc_id_t id)
@@ -191,6 +236,284 @@ uint32_t adc_read_volt(adc_id_t id)
     return volts;
 }
 
+bool adc_set_rate(uint32_t rate)
+{
+    if(rate < ADC_RATE_MIN || rate > ADC_RATE_MAX)
+    {
+        return false;
+    }
+    adc_rate = rate;
+
+    /* Applied on standby exit */
+    if(!adc_standby)
+    {
+        adc_timer_set(rate);
+    }
+
+    return true;
+}
+
+uint32_t adc_get_rate(void)
+{
+    return adc_rate;
+}
+
+bool adc_set_decimation(adc_id_t id, uint32_t ratio)
+{
+    uint8_t shift = adc_decimation_shift(ratio);
+
+    if(id >= ADC_ID_LAST || shift == UINT8_MAX)
+    {
+        return false;
+    }
+
+    /* Restart decimator with new ratio */
+    NVIC_DisableIRQ(ADC_A_IRQn);
+    memset(&adc_cic[id], 0, sizeof(adc_cic_t));
+    adc_cic[id].shift = shift;
+    NVIC_EnableIRQ(ADC_A_IRQn);
+
+    return true;
+}
+
+uint32_t adc_get_decimation(adc_id_t id)
+{
+    return 1UL << adc_cic[id].shift;
+}
+
+uint32_t adc_get_block_period(void)
+{
+    uint8_t i = 0;
+    uint32_t ratio = ADC_DECIMATION_MAX;
+
+    for(i = 0; i < ADC_ID_LAST; i++)
+    {
+        if(adc_ch_list[i].channel != UINT8_MAX && adc_get_decimation((adc_id_t)i) < ratio)
+        {
+            ratio = adc_get_decimation((adc_id_t)i);
+        }
+    }
+
+    return (uint32_t)(((uint64_t)osKernelGetSysTimerFreq() * ratio) / adc_rate);
+}
+
+void adc_set_callback(adc_samples_cb_t cb)
+{
+    adc_samples_cb = cb;
+
+    return;
+}
+
+void adc_standby_enter(uint16_t margin)
+{
+    uint8_t i = 0;
+    uint8_t thr = 0;
+    uint32_t thr1 = 0;
+    int32_t low = 0;
+    int32_t high = 0;
+
+    if(adc_standby)
+    {
+        return;
+    }
+
+    /* Stop sequence interrupts, decimators keep their state */
+    NVIC_DisableIRQ(ADC_A_IRQn);
+    Chip_ADC_DisableInt(LPC_ADC, ADC_INTEN_SEQA_ENABLE);
+    adc_standby = true;
+    adc_timer_set(ADC_STANDBY_RATE);
+
+    /* Window around latest value, converted to 12 bit. Channels above threshold sets share the last one. */
+    for(i = 0; i < ADC_ID_LAST; i++)
+    {
+        if(adc_ch_list[i].channel == UINT8_MAX || adc_value[i] == UINT16_MAX)
+        {
+            continue;
+        }
+        low = ((int32_t)adc_value[i] - margin) >> 4;
+        high = ((int32_t)adc_value[i] + margin) >> 4;
+        Chip_ADC_SetThrLowValue(LPC_ADC, thr, (uint16_t)(low < 0 ? 0 : low));
+        Chip_ADC_SetThrHighValue(LPC_ADC, thr, (uint16_t)(high > 0xFFF ? 0xFFF : high));
+        if(thr == 1)
+        {
+            thr1 |= ADC_THRSEL_CHAN_SEL_THR1(adc_ch_list[i].channel);
+        }
+        if(thr < ADC_THRESHOLDS - 1)
+        {
+            thr++;
+        }
+    }
+    Chip_ADC_SelectTH0Channels(LPC_ADC, ~thr1 & ADC_CHANNELS_MASK);
+    Chip_ADC_SelectTH1Channels(LPC_ADC, thr1);
+
+    /* Wake up on first conversion outside of window */
+    Chip_ADC_ClearFlags(LPC_ADC, ADC_FLAGS_THCMP_INT_MASK | ADC_CHANNELS_MASK);
+    for(i = 0; i < ADC_ID_LAST; i++)
+    {
+        if(adc_ch_list[i].channel != UINT8_MAX && adc_value[i] != UINT16_MAX)
+        {
+            Chip_ADC_SetThresholdInt(LPC_ADC, adc_ch_list[i].channel, ADC_INTEN_THCMP_OUTSIDE);
+        }
+    }
+
+    return;
+}
+
+void adc_standby_exit(void)
+{
+    uint8_t i = 0;
+
+    NVIC_DisableIRQ(ADC_B_IRQn);
+    if(!adc_standby)
+    {
+        NVIC_EnableIRQ(ADC_B_IRQn);
+        return;
+    }
+
+    for(i = 0; i < ADC_ID_LAST; i++)
+    {
+        if(adc_ch_list[i].channel != UINT8_MAX)
+        {
+            Chip_ADC_SetThresholdInt(LPC_ADC, adc_ch_list[i].channel, ADC_INTEN_THCMP_DISABLE);
+        }
+    }
+    Chip_ADC_ClearFlags(LPC_ADC, ADC_FLAGS_THCMP_INT_MASK | ADC_CHANNELS_MASK);
+
+    adc_timer_set(adc_rate);
+    adc_standby = false;
+    Chip_ADC_ClearFlags(LPC_ADC, ADC_FLAGS_SEQA_INT_MASK);
+    Chip_ADC_EnableInt(LPC_ADC, ADC_INTEN_SEQA_ENABLE);
+    NVIC_EnableIRQ(ADC_A_IRQn);
+    NVIC_EnableIRQ(ADC_B_IRQn);
+
+    return;
+}
+
+bool adc_standby_state(void)
+{
+    return adc_standby;
+}
+
+void adc_set_wakeup_callback(adc_wakeup_cb_t cb)
+{
+    adc_wakeup_cb = cb;
+
+    return;
+}
+
+void ADCB_IRQHandler(void)
+{
+    if((Chip_ADC_GetFlags(LPC_ADC) & ADC_FLAGS_THCMP_INT_MASK) == 0)
+    {
+        return;
+    }
+
+    /* Movement detected, restore normal sampling before anyone is notified */
+    adc_standby_exit();
+
+    if(adc_wakeup_cb != NULL)
+    {
+        adc_wakeup_cb();
+    }
+
+    return;
+}
+
+void ADCA_IRQHandler(void)
+{
+    uint8_t i = 0;
+    uint32_t updated = 0;
+    uint32_t comb = 0;
+    uint32_t value = 0;
+    adc_cic_t *cic = NULL;
+    adc_samples_t block;
+
+    Chip_ADC_ClearFlags(LPC_ADC, ADC_FLAGS_SEQA_INT_MASK);
+
+    /* Run decimators */
+    for(i = 0; i < ADC_ID_LAST; i++)
+    {
+        if(adc_ch_list[i].channel == UINT8_MAX)
+        {
+            continue;
+        }
+        cic = &adc_cic[i];
+        cic->integrator[0] += ADC_DR_RESULT(Chip_ADC_GetDataReg(LPC_ADC, adc_ch_list[i].channel));
+        cic->integrator[1] += cic->integrator[0];
+        if(++cic->count < (1U << cic->shift))
+        {
+            continue;
+        }
+        cic->count = 0;
+
+        /* Comb stages, gain is ratio^2 */
+        comb = cic->integrator[1] - cic->comb[0];
+        cic->comb[0] = cic->integrator[1];
+        value = comb - cic->comb[1];
+        cic->comb[1] = comb;
+
+        /* Scale 12 + 2 * shift bits to 16 bit */
+        if(cic->shift >= 2)
+        {
+            value >>= (2 * cic->shift) - 4;
+        }
+        else
+        {
+            value <<= 4 - (2 * cic->shift);
+        }
+        adc_value[i] = value > 0xFFF0 ? 0xFFF0 : value;
+        updated |= 1UL << i;
+    }
+    if(updated == 0)
+    {
+        return;
+    }
+
+    /* Publish block */
+    memcpy(block.raw, adc_value, sizeof(block.raw));
+    block.updated = updated;
+    block.timestamp = osKernelGetSysTimerCount();
+    block.seq = adc_samples.lock.seq + 1;
+    SEQLOCK_PUBLISH(adc_samples, &block);
+
+    if(adc_samples_cb != NULL)
+    {
+        adc_samples_cb();
+    }
+
+    return;
+}
+
 /**********************************************************************************************************************
  * Private functions
  *********************************************************************************************************************/
+
+static uint8_t adc_decimation_shift(uint32_t ratio)
+{
+    uint8_t shift = 0;
+
+    if(ratio == 0 || ratio > ADC_DECIMATION_MAX || (ratio & (ratio - 1)) != 0)
+    {
+        return UINT8_MAX;
+    }
+    while((1UL << shift) < ratio)
+    {
+        shift++;
+    }
+
+    return shift;
+}
+
+static void adc_timer_set(uint32_t rate)
+{
+    uint32_t match = (Chip_Clock_GetSystemClockRate() / (2 * rate)) - 1;
+
+    /* Two match toggles per trigger period */
+    Chip_TIMER_SetMatch(LPC_TIMER32_0, 0, match);
+    if(Chip_TIMER_ReadCount(LPC_TIMER32_0) >= match)
+    {
+        Chip_TIMER_Reset(LPC_TIMER32_0);
+    }
+
+    return;
+}
@@ -28,16 +28,23 @@ extern "C" {
  * Includes
  *********************************************************************************************************************/
 #include <stdint.h>
+#include <stdbool.h>
 
 /**********************************************************************************************************************
  * Exported definitions and macros
  *********************************************************************************************************************/
 #define ADC_CLK                 4400000     //!< 1000000, set to 4.4Mhz
 #define ADC_VREF                3300.0F     //!< Reference voltage in mV.
-#define ADC_RESOLUTION          4096.0F     //!< ADC resolution 12 bit.
+#define ADC_RESOLUTION          65536.0F    //!< Resolution of decimated values, 16 bit.
 #define ADC_LLS_SLOPE           (-2.36)     //!< Temperature sensor LLS slope value in volts.
 #define ADC_LLS_INTERCEPT       (606.0)     //!< Temperature sensor LLS intercept value.
-#define ADC_AVG_COUNT           100         //!< Average count.
+#define ADC_DECIMATION          16          //!< Default decimation ratio of each channel.
+#define ADC_DECIMATION_MAX      64          //!< Maximal decimation ratio, power of 2.
+#define ADC_RATE                1600        //!< Default sequence trigger rate in Hz.
+#define ADC_RATE_MIN            100         //!< Minimal sequence trigger rate in Hz.
+#define ADC_RATE_MAX            2000        //!< Maximal sequence trigger rate in Hz.
+#define ADC_STANDBY_RATE        20          //!< Sequence trigger rate in standby in Hz.
+#define ADC_THRESHOLDS          2           //!< Threshold compare register sets.
 
 /**********************************************************************************************************************
  * Exported types
@@ -54,6 +61,27 @@ typedef enum
     ADC_ID_LAST,                    //!< Last should stay last!
 } adc_id_t;
 
+/**
+ * @brief   ADC sample block. Published each time any channel produces decimated value.
+ */
+typedef struct
+{
+    uint32_t seq;                   //!< Block sequence number, 0 - no samples yet.
+    uint32_t timestamp;             //!< RTOS system timer count when block was completed.
+    uint32_t updated;               //!< Bit mask of channels with new value in this block.
+    uint16_t raw[ADC_ID_LAST];      //!< Latest decimated values, 16 bit full scale. UINT16_MAX - channel not used.
+} adc_samples_t;
+
+/**
+ * @brief   Sample block completion callback. Called from interrupt.
+ */
+typedef void (*adc_samples_cb_t)(void);
+
+/**
+ * @brief   Standby wakeup callback. Called from interrupt.
+ */
+typedef void (*adc_wakeup_cb_t)(void);
+
 /**********************************************************************************************************************
  * Prototypes of exported constants
  *********************************************************************************************************************/
@@ -71,14 +99,117 @@ typedef enum
 void adc_init(void);
 
 /**
- * @brief   Read ADC value in raw.
+ * @brief   Read ADC value in raw from latest sample block.
  *
  * @param   id  ADC channel ID. See @ref adc_id_t.
  *
- * @return  ADC value in raw.
+ * @return  ADC value in raw. If channel is not used or no samples yet - 0xFFFFFFFF.
  */
 uint32_t adc_read_raw(adc_id_t id);
 
+/**
+ * @brief   Check if channel is connected to ADC input.
+ *
+ * @param   id  ADC channel ID. See @ref adc_id_t.
+ *
+ * @retval  true    Channel is sampled.
+ * @retval  false   Channel is not used on this board.
+ */
+bool adc_is_used(adc_id_t id);
+
+/**
+ * @brief   Get latest consistent sample block of all channels. ADC registers are not accessed.
+ *
+ * @param   samples     Pointer where to store sample block.
+ *
+ * @retval  true    Samples are available.
+ * @retval  false   No sequence completed yet.
+ */
+bool adc_get_samples(adc_samples_t *samples);
+
+/**
+ * @brief   Set sequence trigger rate. Sequences are triggered by CT32B0 match 0, so sampling instants do not depend
+ *          on software latency. Channel output rate is rate / decimation ratio.
+ *
+ * @param   rate    Trigger rate in Hz, @ref ADC_RATE_MIN ... @ref ADC_RATE_MAX.
+ *
+ * @retval  true    Rate set.
+ * @retval  false   Rate out of range.
+ */
+bool adc_set_rate(uint32_t rate);
+
+/**
+ * @brief   Get sequence trigger rate.
+ *
+ * @return  Trigger rate in Hz.
+ */
+uint32_t adc_get_rate(void);
+
+/**
+ * @brief   Set channel decimation ratio. Channel is filtered by 2nd order CIC decimator, each 4x oversampling adds one
+ *          bit of resolution for uncorrelated noise.
+ *
+ * @param   id      ADC channel ID. See @ref adc_id_t.
+ * @param   ratio   Decimation ratio: 1, 2, 4 ... @ref ADC_DECIMATION_MAX.
+ *
+ * @retval  true    Ratio set.
+ * @retval  false   Invalid channel or ratio.
+ */
+bool adc_set_decimation(adc_id_t id, uint32_t ratio);
+
+/**
+ * @brief   Get channel decimation ratio.
+ *
+ * @param   id  ADC channel ID. See @ref adc_id_t.
+ *
+ * @return  Decimation ratio.
+ */
+uint32_t adc_get_decimation(adc_id_t id);
+
+/**
+ * @brief   Get nominal sample block period: period of the fastest channel output.
+ *
+ * @return  Period in RTOS system timer ticks.
+ */
+uint32_t adc_get_block_period(void);
+
+/**
+ * @brief   Set sample block completion callback.
+ *
+ * @param   cb  Callback, NULL to disable.
+ */
+void adc_set_callback(adc_samples_cb_t cb);
+
+/**
+ * @brief   Enter standby. Sequences are triggered at @ref ADC_STANDBY_RATE without sequence interrupt and decimators
+ *          are paused, so CPU is not woken up by sampling. Each channel is compared by hardware against window of
+ *          +-margin around its latest value. First conversion outside of the window leaves standby and calls wakeup
+ *          callback.
+ *
+ * @param   margin  Wakeup window half width, 16 bit full scale.
+ */
+void adc_standby_enter(uint16_t margin);
+
+/**
+ * @brief   Leave standby and restore normal sampling. Does nothing if not in standby.
+ */
+void adc_standby_exit(void);
+
+/**
+ * @brief   Get standby state.
+ *
+ * @retval  true    In standby.
+ * @retval  false   Normal sampling.
+ */
+bool adc_standby_state(void);
+
+/**
+ * @brief   Set standby wakeup callback.
+ *
+ * @param   cb  Callback, NULL to disable.
+ */
+void adc_set_wakeup_callback(adc_wakeup_cb_t cb);
+
 /**
  * @brief   Read ADC value.
  *
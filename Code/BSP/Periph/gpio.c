@@ -48,21 +48,28 @@ typedef struct
  *********************************************************************************************************************/
 const gpio_item_t gpio_list[GPIO_ID_LAST] =
 {
-    {.port = 2, .pin = 19, .dir = true,   .state = false,  .modefunc = IOCON_FUNC0 | IOCON_MODE_INACT,},  // GPIO_ID_LED_STATUS
-    {.port = 0, .pin = 7,  .dir = true,   .state = true,   .modefunc = IOCON_FUNC0 | IOCON_MODE_INACT,},  // GPIO_ID_DISPLAY_SELECT
-    {.port = 1, .pin = 28, .dir = true,   .state = true,   .modefunc = IOCON_FUNC0 | IOCON_MODE_INACT,},  // GPIO_ID_DISPLAY_DC
-    {.port = 1, .pin = 24, .dir = true,   .state = true,   .modefunc = IOCON_FUNC0 | IOCON_MODE_INACT,},  // GPIO_ID_DISPLAY_RESTART
-    {.port = 2, .pin = 6,  .dir = true,   .state = false,  .modefunc = IOCON_FUNC0 | IOCON_MODE_INACT,},  // GPIO_ID_NRF24L01_CE
-    {.port = 1, .pin = 23, .dir = true,   .state = true,   .modefunc = IOCON_FUNC0 | IOCON_MODE_INACT,},  // GPIO_ID_NRF24L01_CSN
-    {.port = 1, .pin = 9,  .dir = false,  .state = false, .modefunc = IOCON_FUNC0 | IOCON_MODE_PULLUP,}, // GPIO_ID_JOYSTICK_LEFT_SW
-    {.port = UINT8_MAX, .pin = UINT8_MAX, .dir = false, .state = false, .modefunc = IOCON_FUNC0 | IOCON_MODE_PULLUP,}, // GPIO_ID_JOYSTICK_RIGHT_SW
-    {.port = 0, .pin = 13, .dir = false,  .state = false, .modefunc = IOCON_FUNC0 | IOCON_MODE_PULLUP,}, // GPIO_ID_BUTTON_LEFT
-    {.port = 0, .pin = 14, .dir = false,  .state = false, .modefunc = IOCON_FUNC0 | IOCON_MODE_PULLUP,}, // GPIO_ID_BUTTON_RIGHT
+    {.port = GPIO_ID_LED_STATUS_PORT,         .pin = GPIO_ID_LED_STATUS_PIN,         .dir = true,  .state = false, .modefunc = IOCON_FUNC0 | IOCON_MODE_INACT,},  // GPIO_ID_LED_STATUS
+    {.port = GPIO_ID_DISPLAY_SELECT_PORT,     .pin = GPIO_ID_DISPLAY_SELECT_PIN,     .dir = true,  .state = true,  .modefunc = IOCON_FUNC0 | IOCON_MODE_INACT,},  // GPIO_ID_DISPLAY_SELECT
+    {.port = GPIO_ID_DISPLAY_DC_PORT,         .pin = GPIO_ID_DISPLAY_DC_PIN,         .dir = true,  .state = true,  .modefunc = IOCON_FUNC0 | IOCON_MODE_INACT,},  // GPIO_ID_DISPLAY_DC
+    {.port = GPIO_ID_DISPLAY_RESTART_PORT,    .pin = GPIO_ID_DISPLAY_RESTART_PIN,    .dir = true,  .state = true,  .modefunc = IOCON_FUNC0 | IOCON_MODE_INACT,},  // GPIO_ID_DISPLAY_RESTART
+    {.port = GPIO_ID_NRF24L01_CE_PORT,        .pin = GPIO_ID_NRF24L01_CE_PIN,        .dir = true,  .state = false, .modefunc = IOCON_FUNC0 | IOCON_MODE_INACT,},  // GPIO_ID_NRF24L01_CE
+    {.port = GPIO_ID_NRF24L01_CSN_PORT,       .pin = GPIO_ID_NRF24L01_CSN_PIN,       .dir = true,  .state = true,  .modefunc = IOCON_FUNC0 | IOCON_MODE_INACT,},  // GPIO_ID_NRF24L01_CSN
+    {.port = GPIO_ID_JOYSTICK_LEFT_SW_PORT,   .pin = GPIO_ID_JOYSTICK_LEFT_SW_PIN,   .dir = false, .state = false, .modefunc = IOCON_FUNC0 | IOCON_MODE_PULLUP,}, // GPIO_ID_JOYSTICK_LEFT_SW
+    {.port = GPIO_ID_JOYSTICK_RIGHT_SW_PORT,  .pin = GPIO_ID_JOYSTICK_RIGHT_SW_PIN,  .dir = false, .state = false, .modefunc = IOCON_FUNC0 | IOCON_MODE_PULLUP,}, // GPIO_ID_JOYSTICK_RIGHT_SW
+    {.port = GPIO_ID_BUTTON_LEFT_PORT,        .pin = GPIO_ID_BUTTON_LEFT_PIN,        .dir = false, .state = false, .modefunc = IOCON_FUNC0 | IOCON_MODE_PULLUP,}, // GPIO_ID_BUTTON_LEFT
+    {.port = GPIO_ID_BUTTON_RIGHT_PORT,       .pin = GPIO_ID_BUTTON_RIGHT_PIN,       .dir = false, .state = false, .modefunc = IOCON_FUNC0 | IOCON_MODE_PULLUP,}, // GPIO_ID_BUTTON_RIGHT
 };
 
 /**********************************************************************************************************************
  * Private variables
  *********************************************************************************************************************/
+/** GPIO of each pin interrupt channel, GPIO_ID_LAST - channel is free. */
+static gpio_id_t gpio_irq_list[GPIO_IRQ_COUNT] =
+{
+    GPIO_ID_LAST, GPIO_ID_LAST, GPIO_ID_LAST, GPIO_ID_LAST, GPIO_ID_LAST, GPIO_ID_LAST, GPIO_ID_LAST, GPIO_ID_LAST,
+};
+/** Edge callback of each pin interrupt channel. */
+static volatile gpio_irq_cb_t gpio_irq_cb[GPIO_IRQ_COUNT] = {NULL};
 
 /**********************************************************************************************************************
  * Exported variables
@@ -82,6 +89,13 @@ const gpio_item_t gpio_list[GPIO_ID_LAST] =
  */
 static bool gpio_is_enabled(gpio_id_t id);
 
+/**
+ * @brief   Pin interrupt channel handler.
+ *
+ * @param   ch      Pin interrupt channel.
+ */
+static void gpio_irq_handler(uint8_t ch);
+
 /**********************************************************************************************************************
  * Exported functions
  *********************************************************************************************************************/
@@ -190,6 +204,154 @@ bool gpio_input_get(gpio_id_t id)
     return Chip_GPIO_ReadPortBit(LPC_GPIO, gpio_list[id].port, gpio_list[id].pin);
 }
 
+bool gpio_get_pin(gpio_id_t id, uint8_t *port, uint8_t *pin)
+{
+    if(!gpio_is_enabled(id))
+    {
+        return false;
+    }
+
+    *port = gpio_list[id].port;
+    *pin = gpio_list[id].pin;
+
+    return true;
+}
+
+uint32_t gpio_port_get(uint8_t port)
+{
+    if(port >= GPIO_PORTS)
+    {
+        return 0;
+    }
+
+    return LPC_GPIO->PIN[port];
+}
+
+bool gpio_irq_enable(gpio_id_t id, gpio_irq_cb_t cb)
+{
+    uint8_t ch = 0;
+    uint8_t free = GPIO_IRQ_COUNT;
+
+    if(!gpio_is_enabled(id) || cb == NULL)
+    {
+        return false;
+    }
+
+    // Reuse channel of this GPIO or take the first free one.
+    for(ch = 0; ch < GPIO_IRQ_COUNT; ch++)
+    {
+        if(gpio_irq_list[ch] == id)
+        {
+            break;
+        }
+        if(gpio_irq_list[ch] == GPIO_ID_LAST && free == GPIO_IRQ_COUNT)
+        {
+            free = ch;
+        }
+    }
+    if(ch == GPIO_IRQ_COUNT)
+    {
+        ch = free;
+    }
+    if(ch == GPIO_IRQ_COUNT)
+    {
+        return false;
+    }
+
+    NVIC_DisableIRQ((IRQn_Type)(PIN_INT0_IRQn + ch));
+    gpio_irq_list[ch] = id;
+    gpio_irq_cb[ch] = cb;
+
+    Chip_Clock_EnablePeriphClock(SYSCTL_CLOCK_PINT);
+    Chip_SYSCTL_SetPinInterrupt(ch, gpio_list[id].port, gpio_list[id].pin);
+    Chip_PININT_SetPinModeEdge(LPC_PININT, PININTCH(ch));
+    Chip_PININT_EnableIntHigh(LPC_PININT, PININTCH(ch));
+    Chip_PININT_EnableIntLow(LPC_PININT, PININTCH(ch));
+    Chip_PININT_ClearIntStatus(LPC_PININT, PININTCH(ch));
+
+    NVIC_ClearPendingIRQ((IRQn_Type)(PIN_INT0_IRQn + ch));
+    NVIC_EnableIRQ((IRQn_Type)(PIN_INT0_IRQn + ch));
+
+    return true;
+}
+
+void gpio_irq_disable(gpio_id_t id)
+{
+    uint8_t ch = 0;
+
+    for(ch = 0; ch < GPIO_IRQ_COUNT; ch++)
+    {
+        if(gpio_irq_list[ch] != id)
+        {
+            continue;
+        }
+        NVIC_DisableIRQ((IRQn_Type)(PIN_INT0_IRQn + ch));
+        Chip_PININT_DisableIntHigh(LPC_PININT, PININTCH(ch));
+        Chip_PININT_DisableIntLow(LPC_PININT, PININTCH(ch));
+        Chip_PININT_ClearIntStatus(LPC_PININT, PININTCH(ch));
+        gpio_irq_cb[ch] = NULL;
+        gpio_irq_list[ch] = GPIO_ID_LAST;
+    }
+
+    return;
+}
+
+void PIN_INT0_IRQHandler(void)
+{
+    gpio_irq_handler(0);
+
+    return;
+}
+
+void PIN_INT1_IRQHandler(void)
+{
+    gpio_irq_handler(1);
+
+    return;
+}
+
+void PIN_INT2_IRQHandler(void)
+{
+    gpio_irq_handler(2);
+
+    return;
+}
+
+void PIN_INT3_IRQHandler(void)
+{
+    gpio_irq_handler(3);
+
+    return;
+}
+
+void PIN_INT4_IRQHandler(void)
+{
+    gpio_irq_handler(4);
+
+    return;
+}
+
+void PIN_INT5_IRQHandler(void)
+{
+    gpio_irq_handler(5);
+
+    return;
+}
+
+void PIN_INT6_IRQHandler(void)
+{
+    gpio_irq_handler(6);
+
+    return;
+}
+
+void PIN_INT7_IRQHandler(void)
+{
+    gpio_irq_handler(7);
+
+    return;
+}
+
 /**********************************************************************************************************************
  * Private functions
  *********************************************************************************************************************/
@@ -202,3 +364,16 @@ static bool gpio_is_enabled(gpio_id_t id)
 
     return true;
 }
+
+static void gpio_irq_handler(uint8_t ch)
+{
+    gpio_irq_cb_t cb = gpio_irq_cb[ch];
+
+    Chip_PININT_ClearIntStatus(LPC_PININT, PININTCH(ch));
+    if(cb != NULL)
+    {
+        cb(gpio_irq_list[ch]);
+    }
+
+    return;
+}
@@ -27,11 +27,46 @@ extern "C" {
 /**********************************************************************************************************************
  * Includes
  *********************************************************************************************************************/
+#include <stdint.h>
 #include <stdbool.h>
 
 /**********************************************************************************************************************
  * Exported definitions and macros
  *********************************************************************************************************************/
+#define GPIO_IRQ_COUNT  8   //!< Pin interrupt channels.
+#define GPIO_PORTS      3   //!< GPIO ports.
+
+/** Port and pin of each GPIO ID. Used by GPIO table and by compile-time pin access. */
+#define GPIO_ID_LED_STATUS_PORT         2
+#define GPIO_ID_LED_STATUS_PIN          19
+#define GPIO_ID_DISPLAY_SELECT_PORT     0
+#define GPIO_ID_DISPLAY_SELECT_PIN      7
+#define GPIO_ID_DISPLAY_DC_PORT         1
+#define GPIO_ID_DISPLAY_DC_PIN          28
+#define GPIO_ID_DISPLAY_RESTART_PORT    1
+#define GPIO_ID_DISPLAY_RESTART_PIN     24
+#define GPIO_ID_NRF24L01_CE_PORT        2
+#define GPIO_ID_NRF24L01_CE_PIN         6
+#define GPIO_ID_NRF24L01_CSN_PORT       1
+#define GPIO_ID_NRF24L01_CSN_PIN        23
+#define GPIO_ID_JOYSTICK_LEFT_SW_PORT   1
+#define GPIO_ID_JOYSTICK_LEFT_SW_PIN    9
+#define GPIO_ID_JOYSTICK_RIGHT_SW_PORT  UINT8_MAX
+#define GPIO_ID_JOYSTICK_RIGHT_SW_PIN   UINT8_MAX
+#define GPIO_ID_BUTTON_LEFT_PORT        0
+#define GPIO_ID_BUTTON_LEFT_PIN         13
+#define GPIO_ID_BUTTON_RIGHT_PORT       0
+#define GPIO_ID_BUTTON_RIGHT_PIN        14
+
+/** Compile error (negative array size) if GPIO is not connected, e.g. @ref GPIO_ID_JOYSTICK_RIGHT_SW. */
+#define GPIO_PIN_CHECK(id)      ((void)sizeof(char[(id##_PORT < GPIO_PORTS && id##_PIN < 32) ? 1 : -1]))
+
+/**
+ * Set GPIO output high/low with single SET/CLR register store. For hot paths with GPIO ID known at compile time,
+ * GPIO must be enabled output. Caller includes chip.h.
+ */
+#define GPIO_OUTPUT_HIGH(id)    do { GPIO_PIN_CHECK(id); LPC_GPIO->SET[id##_PORT] = (1UL << id##_PIN); } while(0)
+#define GPIO_OUTPUT_LOW(id)     do { GPIO_PIN_CHECK(id); LPC_GPIO->CLR[id##_PORT] = (1UL << id##_PIN); } while(0)
 
 /**********************************************************************************************************************
  * Exported types
@@ -54,6 +89,13 @@ typedef enum
     GPIO_ID_LAST,             //!< Last should stay last.
 } gpio_id_t;
 
+/**
+ * @brief   GPIO edge interrupt callback. Called from interrupt.
+ *
+ * @param   id      GPIO id. See @ref gpio_id_t.
+ */
+typedef void (*gpio_irq_cb_t)(gpio_id_t id);
+
 /**********************************************************************************************************************
  * Prototypes of exported constants
  *********************************************************************************************************************/
@@ -124,6 +166,45 @@ void gpio_input(gpio_id_t id);
  */
 bool gpio_input_get(gpio_id_t id);
 
+/**
+ * @brief   Get port and pin number of GPIO.
+ *
+ * @param   id      GPIO id. See @ref gpio_id_t.
+ * @param   port    Port number.
+ * @param   pin     Pin number.
+ *
+ * @return  false if GPIO is disabled.
+ */
+bool gpio_get_pin(gpio_id_t id, uint8_t *port, uint8_t *pin);
+
+/**
+ * @brief   Read all pins of GPIO port at once.
+ *
+ * @param   port    Port number, 0 ... GPIO_PORTS - 1.
+ *
+ * @return  Pins state, bit per pin.
+ */
+uint32_t gpio_port_get(uint8_t port);
+
+/**
+ * @brief   Enable both edges interrupt of input GPIO. Uses one of @ref GPIO_IRQ_COUNT pin interrupt channels.
+ *
+ * @param   id      GPIO id. See @ref gpio_id_t.
+ * @param   cb      Edge callback.
+ *
+ * @return  State of interrupt.
+ * @retval  0   GPIO disabled or no free pin interrupt channel.
+ * @retval  1   enabled.
+ */
+bool gpio_irq_enable(gpio_id_t id, gpio_irq_cb_t cb);
+
+/**
+ * @brief   Disable edge interrupt of GPIO and free its pin interrupt channel.
+ *
+ * @param   id      GPIO id. See @ref gpio_id_t.
+ */
+void gpio_irq_disable(gpio_id_t id);
+
 #ifdef __cplusplus
 }
 #endif
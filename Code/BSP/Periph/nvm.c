@@ -0,0 +1,139 @@
+/**
+ **********************************************************************************************************************
+ * @file        nvm.c
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        2017-05-02
+ * @brief       Non-volatile (EEPROM) settings storage C source file.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "periph/nvm.h"
+
+#include "chip.h"
+#include "eeprom.h"
+#include "iap.h"
+
+/**********************************************************************************************************************
+ * Private definitions and macros
+ *********************************************************************************************************************/
+#define NVM_SLOT_SIZE   128     //!< EEPROM slot size of each record, header included.
+
+#if NVM_RECORD_SIZE_MAX + 4 > NVM_SLOT_SIZE
+#error "Non-volatile record does not fit into slot."
+#endif
+
+/**********************************************************************************************************************
+ * Private typedef
+ *********************************************************************************************************************/
+/**
+ * @brief   Record header, stored in front of record data.
+ */
+typedef struct
+{
+    uint16_t size;  //!< Record data size.
+    uint16_t crc;   //!< CRC-CCITT of record data.
+} nvm_header_t;
+
+/**********************************************************************************************************************
+ * Private constants
+ *********************************************************************************************************************/
+
+/**********************************************************************************************************************
+ * Private variables
+ *********************************************************************************************************************/
+/** Record buffer: header and data are read and written in one EEPROM access. */
+static uint8_t nvm_buffer[NVM_SLOT_SIZE];
+
+/**********************************************************************************************************************
+ * Exported variables
+ *********************************************************************************************************************/
+
+/**********************************************************************************************************************
+ * Prototypes of local functions
+ *********************************************************************************************************************/
+/**
+ * @brief   Calculate record data CRC.
+ *
+ * @param   data    Record data.
+ * @param   size    Record data size.
+ *
+ * @return  CRC-CCITT.
+ */
+static uint16_t nvm_crc(const uint8_t *data, uint16_t size);
+
+/**********************************************************************************************************************
+ * Exported functions
+ *********************************************************************************************************************/
+void nvm_init(void)
+{
+    Chip_CRC_Init();
+
+    return;
+}
+
+bool nvm_load(nvm_id_t id, void *data, uint16_t size)
+{
+    nvm_header_t header;
+    bool result = false;
+
+    if(id >= NVM_ID_LAST || data == NULL || size > NVM_RECORD_SIZE_MAX)
+    {
+        return false;
+    }
+    if(Chip_EEPROM_Read(id * NVM_SLOT_SIZE, nvm_buffer, sizeof(header) + size) == IAP_CMD_SUCCESS)
+    {
+        memcpy(&header, nvm_buffer, sizeof(header));
+        if(header.size == size && header.crc == nvm_crc(&nvm_buffer[sizeof(header)], size))
+        {
+            memcpy(data, &nvm_buffer[sizeof(header)], size);
+            result = true;
+        }
+    }
+
+    return result;
+}
+
+bool nvm_store(nvm_id_t id, const void *data, uint16_t size)
+{
+    nvm_header_t header;
+    bool result = false;
+
+    if(id >= NVM_ID_LAST || data == NULL || size > NVM_RECORD_SIZE_MAX)
+    {
+        return false;
+    }
+    header.size = size;
+    header.crc = nvm_crc(data, size);
+    memcpy(nvm_buffer, &header, sizeof(header));
+    memcpy(&nvm_buffer[sizeof(header)], data, size);
+    result = Chip_EEPROM_Write(id * NVM_SLOT_SIZE, nvm_buffer, sizeof(header) + size) == IAP_CMD_SUCCESS;
+
+    return result;
+}
+
+/**********************************************************************************************************************
+ * Private functions
+ *********************************************************************************************************************/
+static uint16_t nvm_crc(const uint8_t *data, uint16_t size)
+{
+    Chip_CRC_SetSeed(0xFFFF);
+
+    return (uint16_t)Chip_CRC_CRC8(data, size);
+}
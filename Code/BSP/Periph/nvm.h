@@ -0,0 +1,97 @@
+/**
+ **********************************************************************************************************************
+ * @file        nvm.h
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        2017-05-02
+ * @brief       Non-volatile (EEPROM) settings storage C header file.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+#ifndef NVM_H_
+#define NVM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/**********************************************************************************************************************
+ * Exported definitions and macros
+ *********************************************************************************************************************/
+#define NVM_SIZE                4032    //!< Usable EEPROM size, last 64 bytes of 4 kB are reserved.
+#define NVM_RECORD_SIZE_MAX     124     //!< Maximal record data size.
+
+/**********************************************************************************************************************
+ * Exported types
+ *********************************************************************************************************************/
+/**
+ * @brief   Non-volatile records enumerator. Each record has fixed EEPROM slot.
+ */
+typedef enum
+{
+    NVM_ID_JOYSTICK = 0,    //!< Joystick calibration.
+    NVM_ID_LAST,            //!< Last should stay last!
+} nvm_id_t;
+
+/**********************************************************************************************************************
+ * Prototypes of exported constants
+ *********************************************************************************************************************/
+
+/**********************************************************************************************************************
+ * Prototypes of exported variables
+ *********************************************************************************************************************/
+
+/**********************************************************************************************************************
+ * Prototypes of exported functions
+ *********************************************************************************************************************/
+/**
+ * @brief   Initialize non-volatile storage.
+ *
+ * @note    Record access is not reentrant, records are to be accessed from one thread.
+ */
+void nvm_init(void);
+
+/**
+ * @brief   Load record. Record is valid only if stored size matches and CRC is correct.
+ *
+ * @param   id      Record ID. See @ref nvm_id_t.
+ * @param   data    Pointer where to store record data.
+ * @param   size    Record data size, up to @ref NVM_RECORD_SIZE_MAX.
+ *
+ * @retval  true    Record loaded.
+ * @retval  false   Record not stored, corrupted or read failed. Data is not changed.
+ */
+bool nvm_load(nvm_id_t id, void *data, uint16_t size);
+
+/**
+ * @brief   Store record. Blocks for EEPROM write time (few milliseconds), not to be called from interrupt.
+ *
+ * @param   id      Record ID. See @ref nvm_id_t.
+ * @param   data    Record data.
+ * @param   size    Record data size, up to @ref NVM_RECORD_SIZE_MAX.
+ *
+ * @retval  true    Record stored.
+ * @retval  false   Invalid record or write failed.
+ */
+bool nvm_store(nvm_id_t id, const void *data, uint16_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NVM_H_ */
@@ -21,6 +21,8 @@
  * Includes
  *********************************************************************************************************************/
 #include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
 
 #include "chip.h"
 
@@ -29,9 +31,12 @@
 /**********************************************************************************************************************
  * Private definitions and macros
  *********************************************************************************************************************/
-#define UART_0_BAUDRATE         115200  //!< UART 0 baudrate.
+#ifndef UART_0_BAUDRATE
+#define UART_0_BAUDRATE         460800  //!< UART 0 baudrate, high enough for telemetry stream.
+#endif
 #define UART_0_RX_BUFFER_SIZE   128     //!< Receive buffer size in bytes.
 #define UART_0_TX_BUFFER_SIZE   512     //!< Transmit buffer size in bytes.
+#define UART_0_RX_WAKE_LEVEL    (UART_0_RX_BUFFER_SIZE / 2) //!< Receive buffer level to call receive callback without line terminator.
 
 /**********************************************************************************************************************
  * Private typedef
@@ -52,6 +57,8 @@ __IO RINGBUFF_T uart0_rx_rb;
 uint8_t uart_0_rx_buffer[UART_0_RX_BUFFER_SIZE];
 /** Transmit buffer. See @ref UART_0_TX_BUFFER_SIZE. */
 uint8_t uart_0_tx_buffer[UART_0_TX_BUFFER_SIZE];
+/** Receive callback. */
+static volatile uart_rx_cb_t uart_0_rx_cb = NULL;
 
 /**********************************************************************************************************************
  * Exported variables
@@ -72,9 +79,12 @@ void uart_0_init(void)
 
     /* Setup UART */
     Chip_UART0_Init(LPC_USART0);
-    Chip_UART0_SetBaud(LPC_USART0, UART_0_BAUDRATE);
+    /* Fractional divider keeps baudrate error low above 115200 */
+    Chip_UART0_SetBaudFDR(LPC_USART0, UART_0_BAUDRATE);
     Chip_UART0_ConfigData(LPC_USART0, (UART0_LCR_WLEN8 | UART0_LCR_SBS_1BIT));
     Chip_UART0_TXEnable(LPC_USART0);
+    /* Interrupt after 8 bytes or on character timeout, pasted input doesn't interrupt on every byte */
+    Chip_UART0_SetupFIFOS(LPC_USART0, (UART0_FCR_FIFO_EN | UART0_FCR_TRG_LEV2));
 
     /* Before using the ring buffers, initialize them using the ring buffer init function */
     RingBuffer_Init((RINGBUFF_T *)&uart0_rx_rb, uart_0_rx_buffer, 1, UART_0_RX_BUFFER_SIZE);
@@ -96,11 +106,9 @@ void uart_0_send(uint8_t *data, uint32_t size)
     return;
 }
 
-void uart_0_send_rb(uint8_t *data, uint32_t size)
+uint32_t uart_0_send_rb(uint8_t *data, uint32_t size)
 {
-    Chip_UART0_SendRB(LPC_USART0, (RINGBUFF_T *)&uart0_tx_rb, data, size);
-
-    return;
+    return Chip_UART0_SendRB(LPC_USART0, (RINGBUFF_T *)&uart0_tx_rb, data, size);
 }
 
 uint32_t uart_0_read_rb(uint8_t *data, uint32_t size)
@@ -108,9 +116,44 @@ uint32_t uart_0_read_rb(uint8_t *data, uint32_t size)
     return Chip_UART0_ReadRB(LPC_USART0, (RINGBUFF_T *)&uart0_rx_rb, data, size);
 }
 
+void uart_0_set_rx_cb(uart_rx_cb_t cb)
+{
+    uart_0_rx_cb = cb;
+
+    return;
+}
+
 void USART0_IRQHandler(void)
 {
-    Chip_UART0_IRQRBHandler(LPC_USART0, (RINGBUFF_T *)&uart0_rx_rb, (RINGBUFF_T *)&uart0_tx_rb);
+    uart_rx_cb_t cb = uart_0_rx_cb;
+    uint8_t byte = 0;
+    bool wake = false;
+
+    /* Handle transmit interrupt if enabled */
+    if(LPC_USART0->IER & UART0_IER_THREINT)
+    {
+        Chip_UART0_TXIntHandlerRB(LPC_USART0, (RINGBUFF_T *)&uart0_tx_rb);
+        if(RingBuffer_IsEmpty((RINGBUFF_T *)&uart0_tx_rb))
+        {
+            Chip_UART0_IntDisable(LPC_USART0, UART0_IER_THREINT);
+        }
+    }
+
+    /* Drain receive FIFO, new data is dropped if ring buffer is full */
+    while(Chip_UART0_ReadLineStatus(LPC_USART0) & UART0_LSR_RDR)
+    {
+        byte = Chip_UART0_ReadByte(LPC_USART0);
+        RingBuffer_Insert((RINGBUFF_T *)&uart0_rx_rb, &byte);
+        if(byte == '\r' || byte == '\n')
+        {
+            wake = true;
+        }
+    }
+
+    if(cb != NULL && (wake == true || RingBuffer_GetCount((RINGBUFF_T *)&uart0_rx_rb) >= UART_0_RX_WAKE_LEVEL))
+    {
+        cb();
+    }
 
     return;
 }
@@ -28,6 +28,7 @@ extern "C" {
  * Includes
  *********************************************************************************************************************/
 #include <stdint.h>
+#include <stdbool.h>
 
 /**********************************************************************************************************************
  * Exported definitions and macros
@@ -36,6 +37,11 @@ extern "C" {
 /**********************************************************************************************************************
  * Exported types
  *********************************************************************************************************************/
+/**
+ * @brief   UART receive callback. Called from interrupt when line terminator is received or receive ring buffer is
+ *          half full.
+ */
+typedef void (*uart_rx_cb_t)(void);
 
 /**********************************************************************************************************************
  * Prototypes of exported constants
@@ -66,8 +72,10 @@ void uart_0_send(uint8_t *data, uint32_t size);
  *
  * @param   data    Pointer to data to send.
  * @param   size    Size of data to send in bytes
+ *
+ * @return  Size of data put to transmit ring buffer, less than size if buffer is full.
  */
-void uart_0_send_rb(uint8_t *data, uint32_t size);
+uint32_t uart_0_send_rb(uint8_t *data, uint32_t size);
 
 /**
  * @brief   Read data from UART 0 using ring buffer (visa IRQ).
@@ -79,6 +87,13 @@ void uart_0_send_rb(uint8_t *data, uint32_t size);
  */
 uint32_t uart_0_read_rb(uint8_t *data, uint32_t size);
 
+/**
+ * @brief   Set UART 0 receive callback.
+ *
+ * @param   cb      Receive callback, NULL - no callback.
+ */
+void uart_0_set_rx_cb(uart_rx_cb_t cb);
+
 #ifdef __cplusplus
 }
 #endif
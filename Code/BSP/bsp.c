@@ -28,6 +28,7 @@
 
 #include "periph/adc.h"
 #include "periph/gpio.h"
+#include "periph/nvm.h"
 #include "periph/ssp.h"
 #include "periph/uart.h"
 #include "periph/wdt.h"
@@ -82,6 +83,7 @@ void bsp_init(void)
     //wdt_init();
     gpio_init();
     adc_init();
+    nvm_init();
     ssp_0_init();
     ssp_1_init();
     uart_0_init();
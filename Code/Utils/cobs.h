@@ -0,0 +1,94 @@
+/**
+ **********************************************************************************************************************
+ * @file        cobs.h
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        May 20, 2017
+ * @brief       Consistent Overhead Byte Stuffing (COBS) C header file.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+#ifndef COBS_H_
+#define COBS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+
+/**********************************************************************************************************************
+ * Exported constants
+ *********************************************************************************************************************/
+
+/**********************************************************************************************************************
+ * Exported definitions and macros
+ *********************************************************************************************************************/
+/** Encoded size in the worst case: one code byte per 254 data bytes plus the first one. */
+#define COBS_ENCODED_MAX(size)  ((size) + (size) / 254 + 1)
+
+/**********************************************************************************************************************
+ * Exported types
+ *********************************************************************************************************************/
+
+/**********************************************************************************************************************
+ * Prototypes of exported variables
+ *********************************************************************************************************************/
+
+/**********************************************************************************************************************
+ * Prototypes of exported functions
+ *********************************************************************************************************************/
+/**
+ * @brief   Encode data so it has no zero bytes, zero can then delimit frames in a byte stream. Delimiter is not
+ *          added.
+ *
+ * @param   data    Data to encode.
+ * @param   size    Size of data in bytes.
+ * @param   out     Encoded data, at least @ref COBS_ENCODED_MAX bytes. Must not overlap data.
+ *
+ * @return  Size of encoded data in bytes.
+ */
+static inline uint32_t cobs_encode(const uint8_t *data, uint32_t size, uint8_t *out)
+{
+    uint32_t code_idx = 0;
+    uint32_t idx = 1;
+    uint32_t i = 0;
+    uint8_t code = 1;
+
+    for(i = 0; i < size; i++)
+    {
+        if(data[i] != 0)
+        {
+            out[idx++] = data[i];
+            code++;
+        }
+        if(data[i] == 0 || code == 0xFF)
+        {
+            // Code byte is distance to next zero, 0xFF - block of 254 bytes without zero.
+            out[code_idx] = code;
+            code_idx = idx++;
+            code = 1;
+        }
+    }
+    out[code_idx] = code;
+
+    return idx;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COBS_H_ */
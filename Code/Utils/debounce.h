@@ -0,0 +1,116 @@
+/**
+ **********************************************************************************************************************
+ * @file        debounce.h
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        May 14, 2017
+ * @brief       Parallel vertical counter debounce C header file.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+#ifndef DEBOUNCE_H_
+#define DEBOUNCE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/**********************************************************************************************************************
+ * Exported constants
+ *********************************************************************************************************************/
+
+/**********************************************************************************************************************
+ * Exported definitions and macros
+ *********************************************************************************************************************/
+#define DEBOUNCE_SAMPLES    4   //!< Equal samples needed to accept new input state.
+
+/**********************************************************************************************************************
+ * Exported types
+ *********************************************************************************************************************/
+/**
+ * @brief   Debounce state of up to 32 inputs. Each input has 2 bit counter, bit 0 in cnt0 and bit 1 in cnt1, so
+ *          all inputs are counted with a few bitwise operations.
+ */
+typedef struct
+{
+    uint32_t state; //!< Debounced inputs state.
+    uint32_t cnt0;  //!< Counters bit 0.
+    uint32_t cnt1;  //!< Counters bit 1.
+} debounce_t;
+
+/**********************************************************************************************************************
+ * Prototypes of exported variables
+ *********************************************************************************************************************/
+
+/**********************************************************************************************************************
+ * Prototypes of exported functions
+ *********************************************************************************************************************/
+/**
+ * @brief   Set debounced state and clear counters.
+ *
+ * @param   debounce    Debounce state.
+ * @param   state       Initial inputs state.
+ */
+static inline void debounce_init(debounce_t *debounce, uint32_t state)
+{
+    debounce->state = state;
+    debounce->cnt0 = 0;
+    debounce->cnt1 = 0;
+
+    return;
+}
+
+/**
+ * @brief   Debounce new sample. Input changes state after @ref DEBOUNCE_SAMPLES samples differing from debounced
+ *          state in a row, any equal sample restarts its counter.
+ *
+ * @param   debounce    Debounce state.
+ * @param   sample      Inputs sample, e.g. masked port read.
+ *
+ * @return  Mask of inputs that changed debounced state.
+ */
+static inline uint32_t debounce_update(debounce_t *debounce, uint32_t sample)
+{
+    uint32_t delta = sample ^ debounce->state;
+    uint32_t toggle = 0;
+
+    debounce->cnt1 = (debounce->cnt1 ^ debounce->cnt0) & delta;
+    debounce->cnt0 = ~debounce->cnt0 & delta;
+    toggle = delta & ~(debounce->cnt0 | debounce->cnt1);
+    debounce->state ^= toggle;
+
+    return toggle;
+}
+
+/**
+ * @brief   Check if any input is being counted.
+ *
+ * @param   debounce    Debounce state.
+ *
+ * @return  true while sampling must continue.
+ */
+static inline bool debounce_busy(const debounce_t *debounce)
+{
+    return (debounce->cnt0 | debounce->cnt1) != 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DEBOUNCE_H_ */
@@ -0,0 +1,127 @@
+/**
+ **********************************************************************************************************************
+ * @file        seqlock.h
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        May 8, 2017
+ * @brief       Sequence counted snapshot publication C header file.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+#ifndef SEQLOCK_H_
+#define SEQLOCK_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/**********************************************************************************************************************
+ * Exported constants
+ *********************************************************************************************************************/
+
+/**********************************************************************************************************************
+ * Exported definitions and macros
+ *********************************************************************************************************************/
+/** Memory barrier between data and sequence counter accesses. Can be overridden, e.g. for host builds. */
+#ifndef SEQLOCK_BARRIER
+#include "cmsis_compiler.h"
+#define SEQLOCK_BARRIER()   __DMB()
+#endif  // SEQLOCK_BARRIER
+
+/**
+ * Declare object of type published through seqlock. Object holds two copies: writer fills the one readers are not
+ * pointed to and flips sequence counter, so readers never wait for writer and writer never waits for readers.
+ */
+#define SEQLOCK_OBJECT(type)            struct { seqlock_t lock; type copy[2]; }
+
+/** Publish new value of seqlock object. Only one writer per object. */
+#define SEQLOCK_PUBLISH(object, data)   seqlock_publish(&(object).lock, (object).copy, (data), sizeof((object).copy[0]))
+
+/** Take consistent snapshot of seqlock object. Returns sequence number of snapshot. */
+#define SEQLOCK_SNAPSHOT(object, data)  seqlock_snapshot(&(object).lock, (object).copy, (data), sizeof((object).copy[0]))
+
+/**********************************************************************************************************************
+ * Exported types
+ *********************************************************************************************************************/
+/**
+ * @brief   Sequence counter of published object.
+ */
+typedef struct
+{
+    volatile uint32_t seq;  //!< Publication counter, low bit selects published copy.
+} seqlock_t;
+
+/**********************************************************************************************************************
+ * Prototypes of exported variables
+ *********************************************************************************************************************/
+
+/**********************************************************************************************************************
+ * Prototypes of exported functions
+ *********************************************************************************************************************/
+/**
+ * @brief   Publish new value. Writes the copy readers are not pointed to, then makes it current.
+ *
+ * @param   lock    Sequence counter.
+ * @param   copies  Two copies of object.
+ * @param   data    New value.
+ * @param   size    Object size.
+ */
+static inline void seqlock_publish(seqlock_t *lock, void *copies, const void *data, size_t size)
+{
+    uint32_t seq = lock->seq + 1;
+
+    memcpy((uint8_t *)copies + (seq & 1) * size, data, size);
+    SEQLOCK_BARRIER();
+    lock->seq = seq;
+    SEQLOCK_BARRIER();
+
+    return;
+}
+
+/**
+ * @brief   Take consistent snapshot. Copy is retried if writer published while it was taken.
+ *
+ * @param   lock    Sequence counter.
+ * @param   copies  Two copies of object.
+ * @param   data    Pointer where to store snapshot.
+ * @param   size    Object size.
+ *
+ * @return  Sequence number of snapshot, 0 - nothing published yet.
+ */
+static inline uint32_t seqlock_snapshot(const seqlock_t *lock, const void *copies, void *data, size_t size)
+{
+    uint32_t seq = 0;
+
+    do
+    {
+        seq = lock->seq;
+        SEQLOCK_BARRIER();
+        memcpy(data, (const uint8_t *)copies + (seq & 1) * size, size);
+        SEQLOCK_BARRIER();
+    }
+    while(seq != lock->seq);
+
+    return seq;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SEQLOCK_H_ */
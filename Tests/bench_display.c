@@ -0,0 +1,297 @@
+/**
+ **********************************************************************************************************************
+ * @file        bench_display.c
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        2017-05-20
+ * @brief       Display drawing benchmark. Each primitive is drawn repeatedly to driver RAM and flushed once through
+ *              fake SSP, pixels drawn, bytes flushed and host time per operation are reported.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "host.h"
+#include "fake_ssd1306.h"
+
+#include "app.h"
+#include "bsp.h"
+#include "display/display.h"
+#include "display/display_menu.h"
+#include "display/ssd1306.h"
+#include "radio/radio.h"
+#include "sensors/sensors.h"
+
+/**********************************************************************************************************************
+ * Private definitions and macros
+ *********************************************************************************************************************/
+#ifndef BENCH_DISPLAY_LOOPS
+#define BENCH_DISPLAY_LOOPS     10000   //!< Repetitions of each primitive.
+#endif
+
+/**********************************************************************************************************************
+ * Private types
+ *********************************************************************************************************************/
+/**
+ * @brief   Benchmarked primitive.
+ */
+typedef struct
+{
+    const char *name;       //!< Primitive name.
+    void (*draw)(void);     //!< Draw primitive once.
+} bench_display_t;
+
+/**********************************************************************************************************************
+ * Exported variables
+ *********************************************************************************************************************/
+extern volatile display_menu_t display_menu_list[DISPLAY_MENU_ID_LAST];
+
+/**********************************************************************************************************************
+ * Prototypes of local functions
+ *********************************************************************************************************************/
+static void bench_display_pixel(void);
+static void bench_display_hline(void);
+static void bench_display_vline(void);
+static void bench_display_line(void);
+static void bench_display_rectangle(void);
+static void bench_display_filled_rectangle(void);
+static void bench_display_triangle(void);
+static void bench_display_filled_triangle(void);
+static void bench_display_circle(void);
+static void bench_display_filled_circle(void);
+static void bench_display_puts_7x10(void);
+static void bench_display_puts_11x18(void);
+static void bench_display_fill(void);
+static void bench_display_menu_main(void);
+
+/**
+ * @brief   Run one primitive and print its line of results.
+ *
+ * @param   bench   Primitive.
+ */
+static void bench_display_run(const bench_display_t *bench);
+
+/**********************************************************************************************************************
+ * Private constants
+ *********************************************************************************************************************/
+/** Primitives in order of report. */
+static const bench_display_t bench_display_list[] =
+{
+    {"pixel",               bench_display_pixel},
+    {"line horizontal",     bench_display_hline},
+    {"line vertical",       bench_display_vline},
+    {"line diagonal",       bench_display_line},
+    {"rectangle",           bench_display_rectangle},
+    {"filled rectangle",    bench_display_filled_rectangle},
+    {"triangle",            bench_display_triangle},
+    {"filled triangle",     bench_display_filled_triangle},
+    {"circle",              bench_display_circle},
+    {"filled circle",       bench_display_filled_circle},
+    {"puts 7x10",           bench_display_puts_7x10},
+    {"puts 11x18",          bench_display_puts_11x18},
+    {"fill",                bench_display_fill},
+    {"menu main+flush",     bench_display_menu_main},
+};
+
+/**********************************************************************************************************************
+ * Exported functions
+ *********************************************************************************************************************/
+uint32_t sensors_get_data(sensors_data_t *data)
+{
+    *data = (sensors_data_t){.joystick_1 = {.magnitude = 512, .direction = 90}};
+
+    return 1;
+}
+
+uint32_t radio_get_data(radio_data_t *data)
+{
+    *data = (radio_data_t){.tx_counter = 1234, .rx_counter = 1229, .quality = 93};
+
+    return 1;
+}
+
+app_rc_mode_t app_rc_mode_get(void)
+{
+    return APP_RC_MODE_IDLE;
+}
+
+uint32_t bsp_get_system_core_clock(void)
+{
+    return 48000000;
+}
+
+int main(void)
+{
+    uint32_t i = 0;
+
+    fake_ssd1306_reset();
+    ssd1306_init();
+    display_menu_init(DISPLAY_MENU_ID_MAIN, 1000, display_menu_cb_main);
+
+    // Menu callback flushes by itself, its ns/op includes the flush.
+    printf("bench_display (%s addressing), %u loops\n", SSD1306_ADDR_MODE ? "horizontal" : "page",
+           BENCH_DISPLAY_LOOPS);
+    printf("%-18s %10s %10s %10s %12s %12s\n", "primitive", "ns/op", "pixels/op", "flush B", "flush trans",
+           "flush ns");
+    for(i = 0; i < sizeof(bench_display_list) / sizeof(bench_display_list[0]); i++)
+    {
+        bench_display_run(&bench_display_list[i]);
+    }
+
+    return 0;
+}
+
+/**********************************************************************************************************************
+ * Private functions
+ *********************************************************************************************************************/
+static void bench_display_pixel(void)
+{
+    ssd1306_draw_pixel(64, 32, SSD1306_COLOR_WHITE);
+
+    return;
+}
+
+static void bench_display_hline(void)
+{
+    ssd1306_draw_line(0, 20, SSD1306_WIDTH - 1, 20, SSD1306_COLOR_WHITE);
+
+    return;
+}
+
+static void bench_display_vline(void)
+{
+    ssd1306_draw_line(20, 0, 20, SSD1306_HEIGHT - 1, SSD1306_COLOR_WHITE);
+
+    return;
+}
+
+static void bench_display_line(void)
+{
+    ssd1306_draw_line(0, 0, SSD1306_WIDTH - 1, SSD1306_HEIGHT - 1, SSD1306_COLOR_WHITE);
+
+    return;
+}
+
+static void bench_display_rectangle(void)
+{
+    ssd1306_draw_rectangle(10, 10, 60, 30, SSD1306_COLOR_WHITE);
+
+    return;
+}
+
+static void bench_display_filled_rectangle(void)
+{
+    ssd1306_draw_filled_rectangle(10, 10, 60, 30, SSD1306_COLOR_WHITE);
+
+    return;
+}
+
+static void bench_display_triangle(void)
+{
+    ssd1306_draw_triangle(10, 50, 64, 5, 118, 50, SSD1306_COLOR_WHITE);
+
+    return;
+}
+
+static void bench_display_filled_triangle(void)
+{
+    ssd1306_draw_filled_triangle(10, 50, 64, 5, 118, 50, SSD1306_COLOR_WHITE);
+
+    return;
+}
+
+static void bench_display_circle(void)
+{
+    ssd1306_draw_circle(64, 32, 20, SSD1306_COLOR_WHITE);
+
+    return;
+}
+
+static void bench_display_filled_circle(void)
+{
+    ssd1306_draw_filled_circle(64, 32, 20, SSD1306_COLOR_WHITE);
+
+    return;
+}
+
+static void bench_display_puts_7x10(void)
+{
+    ssd1306_goto_xy(0, 0);
+    ssd1306_puts((uint8_t *)"Tx: 1234", &fonts_7x10, SSD1306_COLOR_WHITE);
+
+    return;
+}
+
+static void bench_display_puts_11x18(void)
+{
+    ssd1306_goto_xy(0, 20);
+    ssd1306_puts((uint8_t *)"DS2 RC", &fonts_11x18, SSD1306_COLOR_WHITE);
+
+    return;
+}
+
+static void bench_display_fill(void)
+{
+    ssd1306_fill(SSD1306_COLOR_WHITE);
+
+    return;
+}
+
+static void bench_display_menu_main(void)
+{
+    display_menu_list[DISPLAY_MENU_ID_MAIN].init = false;
+    display_menu_list[DISPLAY_MENU_ID_MAIN].cb(DISPLAY_MENU_ID_MAIN);
+
+    return;
+}
+
+static void bench_display_run(const bench_display_t *bench)
+{
+    ssd1306_stats_t stats;
+    uint64_t start = 0;
+    uint64_t draw_ns = 0;
+    uint64_t flush_ns = 0;
+    uint32_t pixels = 0;
+    uint32_t i = 0;
+
+    // Start from blank flushed screen, so only the primitive is dirty.
+    ssd1306_fill(SSD1306_COLOR_BLACK);
+    ssd1306_update_screen();
+    ssd1306_reset_stats();
+
+    start = host_time_ns();
+    for(i = 0; i < BENCH_DISPLAY_LOOPS; i++)
+    {
+        bench->draw();
+    }
+    draw_ns = host_time_ns() - start;
+    ssd1306_get_stats(&stats);
+    pixels = stats.pixels;
+
+    fake_ssd1306.cmd_bytes = 0;
+    fake_ssd1306.data_bytes = 0;
+    fake_ssd1306.transactions = 0;
+    start = host_time_ns();
+    ssd1306_update_screen();
+    flush_ns = host_time_ns() - start;
+
+    printf("%-18s %10.1f %10u %10u %12u %12llu\n", bench->name, (double)draw_ns / BENCH_DISPLAY_LOOPS,
+           pixels / BENCH_DISPLAY_LOOPS, fake_ssd1306.cmd_bytes + fake_ssd1306.data_bytes, fake_ssd1306.transactions,
+           (unsigned long long)flush_ns);
+
+    return;
+}
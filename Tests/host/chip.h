@@ -0,0 +1,68 @@
+/**
+ **********************************************************************************************************************
+ * @file        chip.h
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        2017-05-20
+ * @brief       Host build wrapper of LPCOpen chip header. Peripherals used by host tests are moved to RAM.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+#ifndef HOST_CHIP_H_
+#define HOST_CHIP_H_
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include "../../Code/ThirdParty/lpc_core/lpc_chip/chip_11u6x/chip.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************************************************************************************************************
+ * Exported definitions and macros
+ *********************************************************************************************************************/
+#undef LPC_GPIO
+#undef LPC_ADC
+#undef LPC_TIMER32_0
+
+#define LPC_GPIO        (&host_lpc_gpio)        //!< GPIO port registers, see @ref host_gpio_latch.
+#define LPC_ADC         (&host_lpc_adc)         //!< ADC registers, tests write conversion results to DR.
+#define LPC_TIMER32_0   (&host_lpc_timer32_0)   //!< ADC trigger timer registers.
+
+/**********************************************************************************************************************
+ * Prototypes of exported variables
+ *********************************************************************************************************************/
+extern LPC_GPIO_T host_lpc_gpio;
+extern LPC_ADC_T host_lpc_adc;
+extern LPC_TIMER_T host_lpc_timer32_0;
+
+/**********************************************************************************************************************
+ * Prototypes of exported functions
+ *********************************************************************************************************************/
+/**
+ * @brief   Take pin level set by last write to GPIO SET or CLR register since previous call. Register writes are
+ *          not seen by host code, so written bits stay latched in RAM until they are taken here.
+ *
+ * @param   port    GPIO port.
+ * @param   pin     GPIO pin.
+ *
+ * @return  1 - pin was set, 0 - pin was cleared, -1 - pin was not written or was written both ways.
+ */
+int host_gpio_latch(uint8_t port, uint8_t pin);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_CHIP_H_ */
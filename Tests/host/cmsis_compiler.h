@@ -0,0 +1,102 @@
+/**
+ **********************************************************************************************************************
+ * @file        cmsis_compiler.h
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        2017-05-20
+ * @brief       Host build replacement of CMSIS compiler header.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+#ifndef CMSIS_COMPILER_H_
+#define CMSIS_COMPILER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+
+/**********************************************************************************************************************
+ * Exported definitions and macros
+ *********************************************************************************************************************/
+#define __ASM                   __asm
+#define __INLINE                inline
+#define __STATIC_INLINE         static inline
+#define __NO_RETURN             __attribute__((__noreturn__))
+#define __USED                  __attribute__((used))
+#define __WEAK                  __attribute__((weak))
+#define __PACKED                __attribute__((packed))
+#define __ALIGNED(x)            __attribute__((aligned(x)))
+
+/** Barriers are full host memory barriers, so seqlock ordering is kept between host threads. */
+#define __DMB()                 __sync_synchronize()
+#define __DSB()                 __sync_synchronize()
+#define __ISB()                 __sync_synchronize()
+#define __NOP()                 do { } while(0)
+#define __WFI()                 do { } while(0)
+
+/**********************************************************************************************************************
+ * Prototypes of exported variables
+ *********************************************************************************************************************/
+/** Interrupt mask state of host build, see @ref __disable_irq. */
+extern volatile uint32_t host_primask;
+
+/**********************************************************************************************************************
+ * Prototypes of exported functions
+ *********************************************************************************************************************/
+/**
+ * @brief   Mask interrupts. Host build has no interrupts, mask state is only recorded so tests can check critical
+ *          sections are balanced.
+ */
+static inline void __disable_irq(void)
+{
+    host_primask = 1;
+
+    return;
+}
+
+/**
+ * @brief   Unmask interrupts.
+ */
+static inline void __enable_irq(void)
+{
+    host_primask = 0;
+
+    return;
+}
+
+static inline uint32_t __get_PRIMASK(void)
+{
+    return host_primask;
+}
+
+static inline void __set_PRIMASK(uint32_t mask)
+{
+    host_primask = mask;
+
+    return;
+}
+
+static inline uint32_t __get_IPSR(void)
+{
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CMSIS_COMPILER_H_ */
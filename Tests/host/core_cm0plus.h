@@ -0,0 +1,117 @@
+/**
+ **********************************************************************************************************************
+ * @file        core_cm0plus.h
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        2017-05-20
+ * @brief       Host build replacement of Cortex-M0+ core peripherals header.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+#ifndef CORE_CM0PLUS_H_
+#define CORE_CM0PLUS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+
+#include "cmsis_compiler.h"
+
+/**********************************************************************************************************************
+ * Exported definitions and macros
+ *********************************************************************************************************************/
+#define __I     volatile const
+#define __O     volatile
+#define __IO    volatile
+#define __IM    volatile const
+#define __OM    volatile
+#define __IOM   volatile
+
+#define SysTick_CTRL_ENABLE_Msk         (1UL << 0)
+#define SCB_SCR_SLEEPONEXIT_Msk         (1UL << 1)
+#define SCB_SCR_SLEEPDEEP_Msk           (1UL << 2)
+
+/** Core peripherals are plain variables in host build. */
+#define SysTick ((SysTick_Type *)&host_systick)
+#define SCB     ((SCB_Type *)&host_scb)
+
+/**********************************************************************************************************************
+ * Exported types
+ *********************************************************************************************************************/
+typedef struct
+{
+    __IO uint32_t CTRL;
+    __IO uint32_t LOAD;
+    __IO uint32_t VAL;
+    __I  uint32_t CALIB;
+} SysTick_Type;
+
+typedef struct
+{
+    __I  uint32_t CPUID;
+    __IO uint32_t ICSR;
+    __IO uint32_t VTOR;
+    __IO uint32_t AIRCR;
+    __IO uint32_t SCR;
+    __IO uint32_t CCR;
+} SCB_Type;
+
+/**********************************************************************************************************************
+ * Prototypes of exported variables
+ *********************************************************************************************************************/
+extern SysTick_Type host_systick;
+extern SCB_Type host_scb;
+/** Enabled state of each interrupt, see @ref NVIC_EnableIRQ. */
+extern volatile uint8_t host_nvic_enabled[32];
+
+/**********************************************************************************************************************
+ * Prototypes of exported functions
+ *********************************************************************************************************************/
+static inline void NVIC_EnableIRQ(IRQn_Type irq)
+{
+    host_nvic_enabled[(uint32_t)irq & 0x1F] = 1;
+
+    return;
+}
+
+static inline void NVIC_DisableIRQ(IRQn_Type irq)
+{
+    host_nvic_enabled[(uint32_t)irq & 0x1F] = 0;
+
+    return;
+}
+
+static inline void NVIC_ClearPendingIRQ(IRQn_Type irq)
+{
+    (void)irq;
+
+    return;
+}
+
+static inline void NVIC_SetPriority(IRQn_Type irq, uint32_t priority)
+{
+    (void)irq;
+    (void)priority;
+
+    return;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CORE_CM0PLUS_H_ */
@@ -0,0 +1,301 @@
+/**
+ **********************************************************************************************************************
+ * @file        fake_ssd1306.c
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        2017-05-20
+ * @brief       SSD1306 / SH1106 controller emulator behind fake SSP 0 C source file. Each SSP 0 write is decoded as
+ *              command or data stream by the D/C pin level the driver set before the transfer. Horizontal addressing
+ *              builds drive SSD1306, page addressing builds drive SH1106 compatible 132 column controller.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "fake_ssd1306.h"
+#include "chip.h"
+
+#include "display/ssd1306.h"
+#include "periph/gpio.h"
+#include "periph/ssp.h"
+
+/**********************************************************************************************************************
+ * Private variables
+ *********************************************************************************************************************/
+/** Command waiting for arguments. */
+static uint8_t fake_ssd1306_cmd = 0;
+/** Arguments still expected by command. */
+static uint8_t fake_ssd1306_args = 0;
+/** Argument index of command. */
+static uint8_t fake_ssd1306_arg_idx = 0;
+
+/**********************************************************************************************************************
+ * Exported variables
+ *********************************************************************************************************************/
+fake_ssd1306_t fake_ssd1306;
+
+/**********************************************************************************************************************
+ * Prototypes of local functions
+ *********************************************************************************************************************/
+/**
+ * @brief   Process command byte.
+ *
+ * @param   byte    Command or argument byte.
+ */
+static void fake_ssd1306_command(uint8_t byte);
+
+/**
+ * @brief   Store data byte and advance RAM pointers.
+ *
+ * @param   byte    Data byte.
+ */
+static void fake_ssd1306_data(uint8_t byte);
+
+/**********************************************************************************************************************
+ * Exported functions
+ *********************************************************************************************************************/
+void fake_ssd1306_reset(void)
+{
+    memset(&fake_ssd1306, 0, sizeof(fake_ssd1306));
+    fake_ssd1306.mode = 2;
+    fake_ssd1306.page_end = FAKE_SSD1306_PAGES - 1;
+    fake_ssd1306.column_end = 127;
+    fake_ssd1306.contrast = 0x7F;
+    fake_ssd1306_cmd = 0;
+    fake_ssd1306_args = 0;
+    host_gpio_latch(GPIO_ID_DISPLAY_DC_PORT, GPIO_ID_DISPLAY_DC_PIN);
+
+    return;
+}
+
+bool fake_ssd1306_pixel(uint16_t x, uint16_t y)
+{
+    return (fake_ssd1306.ram[y / 8][x + SSD1306_COLUMN_OFFSET] >> (y % 8)) & 1;
+}
+
+bool fake_ssd1306_write_pbm(const char *path)
+{
+    FILE *f = fopen(path, "w");
+    uint16_t x = 0;
+    uint16_t y = 0;
+
+    if(f == NULL)
+    {
+        return false;
+    }
+
+    fprintf(f, "P1\n%d %d\n", SSD1306_WIDTH, SSD1306_HEIGHT);
+    for(y = 0; y < SSD1306_HEIGHT; y++)
+    {
+        for(x = 0; x < SSD1306_WIDTH; x++)
+        {
+            fputc(fake_ssd1306_pixel(x, y) ? '1' : '0', f);
+        }
+        fputc('\n', f);
+    }
+
+    return fclose(f) == 0;
+}
+
+int32_t fake_ssd1306_compare_pbm(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    int32_t diff = 0;
+    int w = 0;
+    int h = 0;
+    int c = 0;
+    uint32_t i = 0;
+
+    if(f == NULL)
+    {
+        return -1;
+    }
+    if(fscanf(f, "P1 %d %d", &w, &h) != 2 || w != SSD1306_WIDTH || h != SSD1306_HEIGHT)
+    {
+        fclose(f);
+        return -1;
+    }
+
+    while(i < SSD1306_WIDTH * SSD1306_HEIGHT && (c = fgetc(f)) != EOF)
+    {
+        if(c != '0' && c != '1')
+        {
+            continue;
+        }
+        diff += (c == '1') != fake_ssd1306_pixel(i % SSD1306_WIDTH, i / SSD1306_WIDTH);
+        i++;
+    }
+    fclose(f);
+
+    return i == SSD1306_WIDTH * SSD1306_HEIGHT ? diff : -1;
+}
+
+void ssp_0_write_buffer(uint8_t *buffer, uint16_t size)
+{
+    int dc = host_gpio_latch(GPIO_ID_DISPLAY_DC_PORT, GPIO_ID_DISPLAY_DC_PIN);
+    uint16_t i = 0;
+
+    fake_ssd1306.transactions++;
+    if(dc < 0)
+    {
+        fake_ssd1306.errors++;
+        return;
+    }
+
+    for(i = 0; i < size; i++)
+    {
+        if(dc)
+        {
+            fake_ssd1306_data(buffer[i]);
+        }
+        else
+        {
+            fake_ssd1306_command(buffer[i]);
+        }
+    }
+
+    return;
+}
+
+/**********************************************************************************************************************
+ * Private functions
+ *********************************************************************************************************************/
+static void fake_ssd1306_command(uint8_t byte)
+{
+    fake_ssd1306.cmd_bytes++;
+
+    if(fake_ssd1306_args != 0)
+    {
+        switch(fake_ssd1306_cmd)
+        {
+            case 0x20:
+                fake_ssd1306.mode = byte & 0x03;
+                break;
+            case 0x21:
+                if(fake_ssd1306_arg_idx == 0)
+                {
+                    fake_ssd1306.column_start = byte;
+                    fake_ssd1306.column = byte;
+                }
+                else
+                {
+                    fake_ssd1306.column_end = byte;
+                }
+                break;
+            case 0x22:
+                if(fake_ssd1306_arg_idx == 0)
+                {
+                    fake_ssd1306.page_start = byte & 0x07;
+                    fake_ssd1306.page = byte & 0x07;
+                }
+                else
+                {
+                    fake_ssd1306.page_end = byte & 0x07;
+                }
+                break;
+            case 0x81:
+                fake_ssd1306.contrast = byte;
+                break;
+            default:
+                break;
+        }
+        fake_ssd1306_arg_idx++;
+        fake_ssd1306_args--;
+        return;
+    }
+
+    fake_ssd1306_cmd = byte;
+    fake_ssd1306_arg_idx = 0;
+    if(byte <= 0x0F)
+    {
+        fake_ssd1306.column = (fake_ssd1306.column & 0xF0) | byte;
+    }
+    else if(byte <= 0x1F)
+    {
+        fake_ssd1306.column = (fake_ssd1306.column & 0x0F) | ((byte & 0x0F) << 4);
+    }
+    else if(byte >= 0xB0 && byte <= 0xB7)
+    {
+        fake_ssd1306.page = byte & 0x07;
+    }
+    else if(byte >= 0x40 && byte <= 0x7F)
+    {
+        // Display start line, not emulated.
+    }
+    else
+    {
+        switch(byte)
+        {
+#if SSD1306_ADDR_MODE
+            case 0x20:
+                fake_ssd1306_args = 1;
+                break;
+            case 0x21: case 0x22:
+                fake_ssd1306_args = 2;
+                break;
+#else
+            case 0x20:
+                // SH1106 has no addressing mode commands, byte after it is taken as column address.
+                break;
+#endif
+            case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+                fake_ssd1306_args = 1;
+                break;
+            case 0xA6: case 0xA7:
+                fake_ssd1306.inverted = byte == 0xA7;
+                break;
+            case 0xAE: case 0xAF:
+                fake_ssd1306.on = byte == 0xAF;
+                break;
+            case 0xA0: case 0xA1: case 0xA4: case 0xA5: case 0xC0: case 0xC8: case 0xE3:
+                // Segment remap, entire display on, COM scan direction and NOP are not emulated.
+                break;
+            default:
+                fake_ssd1306.errors++;
+                break;
+        }
+    }
+
+    return;
+}
+
+static void fake_ssd1306_data(uint8_t byte)
+{
+    fake_ssd1306.data_bytes++;
+    if(fake_ssd1306.column < FAKE_SSD1306_COLUMNS)
+    {
+        fake_ssd1306.ram[fake_ssd1306.page][fake_ssd1306.column] = byte;
+    }
+
+    if(fake_ssd1306.mode == 0)
+    {
+        // Horizontal addressing: wrap inside of column range, then to next page of page range.
+        if(fake_ssd1306.column++ >= fake_ssd1306.column_end)
+        {
+            fake_ssd1306.column = fake_ssd1306.column_start;
+            fake_ssd1306.page = fake_ssd1306.page >= fake_ssd1306.page_end ? fake_ssd1306.page_start :
+                                fake_ssd1306.page + 1;
+        }
+    }
+    else if(++fake_ssd1306.column >= FAKE_SSD1306_COLUMNS)
+    {
+        // Page addressing: column pointer wraps, page stays.
+        fake_ssd1306.column = 0;
+    }
+
+    return;
+}
@@ -0,0 +1,110 @@
+/**
+ **********************************************************************************************************************
+ * @file        fake_ssd1306.h
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        2017-05-20
+ * @brief       SSD1306 / SH1106 controller emulator behind fake SSP 0 C header file.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+#ifndef FAKE_SSD1306_H_
+#define FAKE_SSD1306_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/**********************************************************************************************************************
+ * Exported definitions and macros
+ *********************************************************************************************************************/
+#define FAKE_SSD1306_COLUMNS    132     //!< Display RAM columns, SH1106 size covers SSD1306 too.
+#define FAKE_SSD1306_PAGES      8       //!< Display RAM pages.
+
+/**********************************************************************************************************************
+ * Exported types
+ *********************************************************************************************************************/
+/**
+ * @brief   Controller state decoded from command stream and bus counters.
+ */
+typedef struct
+{
+    uint8_t ram[FAKE_SSD1306_PAGES][FAKE_SSD1306_COLUMNS];  //!< Display RAM.
+    uint8_t mode;           //!< Memory addressing mode: 0 - horizontal, 2 - page.
+    uint8_t page;           //!< Page pointer.
+    uint8_t column;         //!< Column pointer.
+    uint8_t page_start;     //!< Horizontal mode page range start.
+    uint8_t page_end;       //!< Horizontal mode page range end.
+    uint8_t column_start;   //!< Horizontal mode column range start.
+    uint8_t column_end;     //!< Horizontal mode column range end.
+    uint8_t contrast;       //!< Contrast.
+    bool on;                //!< Display is on.
+    bool inverted;          //!< Inverse display.
+    uint32_t cmd_bytes;     //!< Command bytes received.
+    uint32_t data_bytes;    //!< Data bytes received.
+    uint32_t transactions;  //!< SSP transfers.
+    uint32_t errors;        //!< Unknown commands and transfers with undefined D/C pin.
+} fake_ssd1306_t;
+
+/**********************************************************************************************************************
+ * Prototypes of exported variables
+ *********************************************************************************************************************/
+/** Emulated controller. */
+extern fake_ssd1306_t fake_ssd1306;
+
+/**********************************************************************************************************************
+ * Prototypes of exported functions
+ *********************************************************************************************************************/
+/**
+ * @brief   Reset controller: RAM cleared, page addressing mode, counters zeroed.
+ */
+void fake_ssd1306_reset(void);
+
+/**
+ * @brief   Get visible pixel of display RAM, column offset of driver build is applied.
+ *
+ * @param   x   X position.
+ * @param   y   Y position.
+ *
+ * @return  true if pixel is lit.
+ */
+bool fake_ssd1306_pixel(uint16_t x, uint16_t y);
+
+/**
+ * @brief   Write visible area as plain PBM (P1), lit pixel is 1. Same format as CLI "display dump".
+ *
+ * @param   path    File path.
+ *
+ * @return  false if file could not be written.
+ */
+bool fake_ssd1306_write_pbm(const char *path);
+
+/**
+ * @brief   Compare visible area with plain PBM image.
+ *
+ * @param   path    File path.
+ *
+ * @return  Count of different pixels, -1 if image could not be read or has different size.
+ */
+int32_t fake_ssd1306_compare_pbm(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FAKE_SSD1306_H_ */
@@ -0,0 +1,105 @@
+/**
+ **********************************************************************************************************************
+ * @file        host.c
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        2017-05-20
+ * @brief       Host test support C source file: peripherals in RAM, checks and timing.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "host.h"
+#include "chip.h"
+
+/**********************************************************************************************************************
+ * Private variables
+ *********************************************************************************************************************/
+/** Checks done. */
+static uint32_t host_checks = 0;
+/** Checks failed. */
+static uint32_t host_failures = 0;
+
+/**********************************************************************************************************************
+ * Exported variables
+ *********************************************************************************************************************/
+volatile uint32_t host_primask = 0;
+volatile uint8_t host_nvic_enabled[32] = {0};
+SysTick_Type host_systick;
+SCB_Type host_scb;
+LPC_GPIO_T host_lpc_gpio;
+LPC_ADC_T host_lpc_adc;
+LPC_TIMER_T host_lpc_timer32_0;
+uint32_t SystemCoreClock = HOST_SYSTIMER_FREQ;
+
+/**********************************************************************************************************************
+ * Exported functions
+ *********************************************************************************************************************/
+int host_gpio_latch(uint8_t port, uint8_t pin)
+{
+    uint32_t bit = 1UL << pin;
+    bool set = (host_lpc_gpio.SET[port] & bit) != 0;
+    bool clr = (host_lpc_gpio.CLR[port] & bit) != 0;
+
+    host_lpc_gpio.SET[port] &= ~bit;
+    host_lpc_gpio.CLR[port] &= ~bit;
+
+    if(set == clr)
+    {
+        return -1;
+    }
+
+    return set ? 1 : 0;
+}
+
+bool host_check(bool ok, const char *file, int line, const char *fmt, ...)
+{
+    va_list args;
+
+    host_checks++;
+    if(ok)
+    {
+        return true;
+    }
+
+    host_failures++;
+    printf("%s:%d: ", file, line);
+    va_start(args, fmt);
+    vprintf(fmt, args);
+    va_end(args);
+    printf("\n");
+
+    return false;
+}
+
+int host_result(const char *name)
+{
+    printf("%s: %u checks, %u failed.\n", name, host_checks, host_failures);
+
+    return host_failures == 0 ? 0 : 1;
+}
+
+uint64_t host_time_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
@@ -0,0 +1,83 @@
+/**
+ **********************************************************************************************************************
+ * @file        host.h
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        2017-05-20
+ * @brief       Host test support C header file: virtual kernel time, checks and timing.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+#ifndef HOST_H_
+#define HOST_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/**********************************************************************************************************************
+ * Exported definitions and macros
+ *********************************************************************************************************************/
+#define HOST_SYSTIMER_FREQ  48000000UL  //!< Virtual system timer frequency, same as target core clock.
+
+/** Check condition, failed check is reported with source line and counted, test continues. */
+#define HOST_CHECK(cond, ...)   host_check((cond), __FILE__, __LINE__, __VA_ARGS__)
+
+/**********************************************************************************************************************
+ * Prototypes of exported variables
+ *********************************************************************************************************************/
+/** Virtual kernel tick, milliseconds. Advanced by osDelay() and by wait timeouts. */
+extern volatile uint32_t host_tick;
+
+/**********************************************************************************************************************
+ * Prototypes of exported functions
+ *********************************************************************************************************************/
+/**
+ * @brief   Report check result.
+ *
+ * @param   ok      Check result.
+ * @param   file    Source file.
+ * @param   line    Source line.
+ * @param   fmt     Failure message format.
+ *
+ * @return  ok.
+ */
+bool host_check(bool ok, const char *file, int line, const char *fmt, ...) __attribute__((format(printf, 4, 5)));
+
+/**
+ * @brief   Print summary of checks.
+ *
+ * @param   name    Test name.
+ *
+ * @return  Process exit code: 0 - all checks passed.
+ */
+int host_result(const char *name);
+
+/**
+ * @brief   Get monotonic host time.
+ *
+ * @return  Time in nanoseconds.
+ */
+uint64_t host_time_ns(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_H_ */
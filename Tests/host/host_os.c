@@ -0,0 +1,241 @@
+/**
+ **********************************************************************************************************************
+ * @file        host_os.c
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        2017-05-20
+ * @brief       Single threaded CMSIS-RTOS2 replacement for host tests. Kernel time is virtual: it moves only when
+ *              code under test delays or waits. Functions are weak, so a test can replace any of them.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host.h"
+
+#include "cmsis_os2.h"
+
+/**********************************************************************************************************************
+ * Private definitions and macros
+ *********************************************************************************************************************/
+#define HOST_OS_WEAK    __attribute__((weak))
+
+/**********************************************************************************************************************
+ * Private typedef
+ *********************************************************************************************************************/
+/**
+ * @brief   Message queue.
+ */
+typedef struct
+{
+    uint32_t count;     //!< Maximal number of messages.
+    uint32_t size;      //!< Message size.
+    uint32_t head;      //!< Next message to get.
+    uint32_t used;      //!< Messages in queue.
+    uint8_t data[];     //!< Messages.
+} host_os_queue_t;
+
+/**********************************************************************************************************************
+ * Private variables
+ *********************************************************************************************************************/
+/** Flags of the only thread. */
+static uint32_t host_os_thread_flags = 0;
+/** Handle returned for created objects that need no state. */
+static uint8_t host_os_object;
+
+/**********************************************************************************************************************
+ * Exported variables
+ *********************************************************************************************************************/
+volatile uint32_t host_tick = 0;
+
+/**********************************************************************************************************************
+ * Exported functions
+ *********************************************************************************************************************/
+HOST_OS_WEAK uint32_t osKernelGetTickCount(void)
+{
+    return host_tick;
+}
+
+HOST_OS_WEAK uint32_t osKernelGetTickFreq(void)
+{
+    return 1000;
+}
+
+HOST_OS_WEAK uint32_t osKernelGetSysTimerCount(void)
+{
+    return (uint32_t)(host_tick * (HOST_SYSTIMER_FREQ / 1000));
+}
+
+HOST_OS_WEAK uint32_t osKernelGetSysTimerFreq(void)
+{
+    return HOST_SYSTIMER_FREQ;
+}
+
+HOST_OS_WEAK osStatus_t osDelay(uint32_t ticks)
+{
+    host_tick += ticks;
+
+    return osOK;
+}
+
+HOST_OS_WEAK osStatus_t osDelayUntil(uint32_t ticks)
+{
+    if((int32_t)(ticks - host_tick) > 0)
+    {
+        host_tick = ticks;
+    }
+
+    return osOK;
+}
+
+HOST_OS_WEAK osThreadId_t osThreadNew(osThreadFunc_t func, void *argument, const osThreadAttr_t *attr)
+{
+    // Threads are not run, tests call thread bodies or their handlers directly.
+    (void)func;
+    (void)argument;
+    (void)attr;
+
+    return (osThreadId_t)&host_os_object;
+}
+
+HOST_OS_WEAK uint32_t osThreadFlagsSet(osThreadId_t thread_id, uint32_t flags)
+{
+    (void)thread_id;
+    host_os_thread_flags |= flags;
+
+    return host_os_thread_flags;
+}
+
+HOST_OS_WEAK uint32_t osThreadFlagsClear(uint32_t flags)
+{
+    uint32_t old = host_os_thread_flags;
+
+    host_os_thread_flags &= ~flags;
+
+    return old;
+}
+
+HOST_OS_WEAK uint32_t osThreadFlagsGet(void)
+{
+    return host_os_thread_flags;
+}
+
+HOST_OS_WEAK uint32_t osThreadFlagsWait(uint32_t flags, uint32_t options, uint32_t timeout)
+{
+    uint32_t set = host_os_thread_flags & flags;
+
+    if(set == 0 || ((options & osFlagsWaitAll) && set != flags))
+    {
+        // Nobody else runs, so only time can pass.
+        if(timeout != osWaitForever)
+        {
+            host_tick += timeout;
+        }
+        return (uint32_t)osFlagsErrorTimeout;
+    }
+    if((options & osFlagsNoClear) == 0)
+    {
+        host_os_thread_flags &= ~set;
+    }
+
+    return set;
+}
+
+HOST_OS_WEAK osMutexId_t osMutexNew(const osMutexAttr_t *attr)
+{
+    (void)attr;
+
+    return (osMutexId_t)&host_os_object;
+}
+
+HOST_OS_WEAK osStatus_t osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout)
+{
+    (void)mutex_id;
+    (void)timeout;
+
+    return osOK;
+}
+
+HOST_OS_WEAK osStatus_t osMutexRelease(osMutexId_t mutex_id)
+{
+    (void)mutex_id;
+
+    return osOK;
+}
+
+HOST_OS_WEAK osMessageQueueId_t osMessageQueueNew(uint32_t msg_count, uint32_t msg_size,
+                                                  const osMessageQueueAttr_t *attr)
+{
+    host_os_queue_t *queue = calloc(1, sizeof(host_os_queue_t) + msg_count * msg_size);
+
+    (void)attr;
+    if(queue != NULL)
+    {
+        queue->count = msg_count;
+        queue->size = msg_size;
+    }
+
+    return (osMessageQueueId_t)queue;
+}
+
+HOST_OS_WEAK osStatus_t osMessageQueuePut(osMessageQueueId_t mq_id, const void *msg_ptr, uint8_t msg_prio,
+                                          uint32_t timeout)
+{
+    host_os_queue_t *queue = (host_os_queue_t *)mq_id;
+
+    (void)msg_prio;
+    (void)timeout;
+    if(queue == NULL || queue->used == queue->count)
+    {
+        return osErrorResource;
+    }
+    memcpy(&queue->data[((queue->head + queue->used) % queue->count) * queue->size], msg_ptr, queue->size);
+    queue->used++;
+
+    return osOK;
+}
+
+HOST_OS_WEAK osStatus_t osMessageQueueGet(osMessageQueueId_t mq_id, void *msg_ptr, uint8_t *msg_prio,
+                                          uint32_t timeout)
+{
+    host_os_queue_t *queue = (host_os_queue_t *)mq_id;
+
+    if(queue == NULL || queue->used == 0)
+    {
+        if(timeout != osWaitForever)
+        {
+            host_tick += timeout;
+        }
+        return timeout == 0 ? osErrorResource : osErrorTimeout;
+    }
+    memcpy(msg_ptr, &queue->data[queue->head * queue->size], queue->size);
+    queue->head = (queue->head + 1) % queue->count;
+    queue->used--;
+    if(msg_prio != NULL)
+    {
+        *msg_prio = 0;
+    }
+
+    return osOK;
+}
+
+HOST_OS_WEAK uint32_t osMessageQueueGetCount(osMessageQueueId_t mq_id)
+{
+    host_os_queue_t *queue = (host_os_queue_t *)mq_id;
+
+    return queue == NULL ? 0 : queue->used;
+}
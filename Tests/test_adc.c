@@ -0,0 +1,235 @@
+/**
+ **********************************************************************************************************************
+ * @file        test_adc.c
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        2017-05-20
+ * @brief       ADC decimation test. Synthetic 12 bit conversions (DC level between two codes plus gaussian noise) are
+ *              written to fake ADC data registers and sequence interrupt is called, published blocks are checked for
+ *              gain, bias, noise and resolution gain of each decimation ratio.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "host.h"
+#include "chip.h"
+
+#include "periph/adc.h"
+
+/**********************************************************************************************************************
+ * Private definitions and macros
+ *********************************************************************************************************************/
+#define TEST_ADC_ID         ADC_ID_JOYSTICK_LEFT_X  //!< Channel under test.
+#define TEST_ADC_CHANNEL    2                       //!< Hardware channel of @ref TEST_ADC_ID.
+#define TEST_ADC_OUTPUTS    4000                    //!< Decimated outputs measured per ratio.
+#define TEST_ADC_SETTLE     2                       //!< Outputs dropped after decimator restart, CIC order.
+#define TEST_ADC_LEVEL      2048.3                  //!< DC input level in 12 bit LSB, between two codes.
+#define TEST_ADC_NOISE      2.0                     //!< Input noise standard deviation in 12 bit LSB.
+
+/**********************************************************************************************************************
+ * Private types
+ *********************************************************************************************************************/
+/**
+ * @brief   Statistics of decimated outputs, in 12 bit LSB.
+ */
+typedef struct
+{
+    double mean;    //!< Mean value.
+    double std;     //!< Standard deviation.
+} test_adc_stats_t;
+
+/**********************************************************************************************************************
+ * Prototypes of local functions
+ *********************************************************************************************************************/
+/**
+ * @brief   Convert one sequence: store conversion of test channel and run sequence interrupt.
+ *
+ * @param   code    12 bit conversion result.
+ *
+ * @return  true if block with new value of test channel was published.
+ */
+static bool test_adc_convert(uint16_t code);
+
+/**
+ * @brief   Get next gaussian noise sample.
+ *
+ * @return  Noise with unit standard deviation.
+ */
+static double test_adc_noise(void);
+
+/**
+ * @brief   Restart decimator and measure decimated noisy DC input.
+ *
+ * @param   ratio   Decimation ratio.
+ *
+ * @return  Output statistics.
+ */
+static test_adc_stats_t test_adc_measure(uint32_t ratio);
+
+/**********************************************************************************************************************
+ * Exported functions
+ *********************************************************************************************************************/
+void ADCA_IRQHandler(void);
+
+int main(void)
+{
+    static const uint32_t ratios[] = {1, 2, 4, 8, 16, 32, 64};
+    test_adc_stats_t stats[sizeof(ratios) / sizeof(ratios[0])];
+    adc_samples_t samples;
+    double gain_bits = 0;
+    uint32_t seq = 0;
+    uint32_t errors = 0;
+    uint32_t i = 0;
+    uint32_t n = 0;
+    uint8_t id = 0;
+
+    HOST_CHECK(!adc_get_samples(&samples), "samples before first sequence");
+
+    // Noise is reduced by sqrt(2 / (3 * ratio)) by 2nd order CIC, at least half bit per octave of ratio.
+    printf("%-6s %12s %12s %10s\n", "ratio", "mean LSB", "std LSB", "gain bits");
+    for(i = 0; i < sizeof(ratios) / sizeof(ratios[0]); i++)
+    {
+        stats[i] = test_adc_measure(ratios[i]);
+        gain_bits = log2(stats[0].std / stats[i].std);
+        printf("%-6u %12.4f %12.4f %10.2f\n", ratios[i], stats[i].mean, stats[i].std, gain_bits);
+        HOST_CHECK(gain_bits >= 0.5 * log2(ratios[i]) - 0.1, "ratio %u: resolution gain %.2f bits", ratios[i],
+                   gain_bits);
+        HOST_CHECK(fabs(stats[i].mean - TEST_ADC_LEVEL) < 0.1, "ratio %u: bias %.4f LSB", ratios[i],
+                   stats[i].mean - TEST_ADC_LEVEL);
+    }
+    // Fraction of LSB must be visible in single output, not only in average of many.
+    HOST_CHECK(stats[i - 1].std < 0.3, "ratio 64: single output noise %.4f LSB", stats[i - 1].std);
+
+    // Exact unity gain and no overflow at full scale over integrator wrap around.
+    for(id = 0; id < ADC_ID_LAST; id++)
+    {
+        adc_set_decimation((adc_id_t)id, ADC_DECIMATION_MAX);
+    }
+    for(n = 0; n < 2000000; n++)
+    {
+        if(test_adc_convert(0xFFF) && n > 1000)
+        {
+            adc_get_samples(&samples);
+            errors += samples.raw[TEST_ADC_ID] != 0xFFF0;
+        }
+    }
+    HOST_CHECK(errors == 0, "full scale output differs in %u blocks", errors);
+    for(n = 0; n < 10 * ADC_DECIMATION_MAX; n++)
+    {
+        test_adc_convert(1234);
+    }
+    adc_get_samples(&samples);
+    HOST_CHECK(samples.raw[TEST_ADC_ID] == 1234 << 4, "DC output %u", samples.raw[TEST_ADC_ID]);
+    HOST_CHECK(samples.updated & (1UL << TEST_ADC_ID), "updated mask 0x%x", samples.updated);
+
+    // Each block has new sequence number.
+    seq = samples.seq;
+    for(n = 0; n < ADC_DECIMATION_MAX; n++)
+    {
+        test_adc_convert(1234);
+    }
+    adc_get_samples(&samples);
+    HOST_CHECK(samples.seq == seq + 1, "sequence %u after %u", samples.seq, seq);
+
+    HOST_CHECK(!adc_set_decimation(TEST_ADC_ID, 3) && !adc_set_decimation(TEST_ADC_ID, 2 * ADC_DECIMATION_MAX),
+               "invalid ratio accepted");
+
+    return host_result("test_adc");
+}
+
+/**********************************************************************************************************************
+ * Private functions
+ *********************************************************************************************************************/
+static bool test_adc_convert(uint16_t code)
+{
+    adc_samples_t samples;
+    uint32_t seq = 0;
+
+    adc_get_samples(&samples);
+    seq = samples.seq;
+    // Data registers are read only on target.
+    *(uint32_t *)&host_lpc_adc.DR[TEST_ADC_CHANNEL] = (uint32_t)code << 4;
+    ADCA_IRQHandler();
+    adc_get_samples(&samples);
+
+    return samples.seq != seq && (samples.updated & (1UL << TEST_ADC_ID)) != 0;
+}
+
+static double test_adc_noise(void)
+{
+    static bool spare_valid = false;
+    static double spare = 0;
+    double u = 0;
+    double v = 0;
+
+    // Box-Muller, second value is kept for next call.
+    if(spare_valid)
+    {
+        spare_valid = false;
+        return spare;
+    }
+    u = (rand() + 1.0) / (RAND_MAX + 2.0);
+    v = (rand() + 1.0) / (RAND_MAX + 2.0);
+    spare = sqrt(-2 * log(u)) * sin(2 * M_PI * v);
+    spare_valid = true;
+
+    return sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+}
+
+static test_adc_stats_t test_adc_measure(uint32_t ratio)
+{
+    test_adc_stats_t stats = {0};
+    adc_samples_t samples;
+    double value = 0;
+    double sum = 0;
+    double sum2 = 0;
+    long code = 0;
+    uint32_t count = 0;
+    uint8_t id = 0;
+
+    srand(1);
+    for(id = 0; id < ADC_ID_LAST; id++)
+    {
+        adc_set_decimation((adc_id_t)id, ratio);
+    }
+
+    while(count < TEST_ADC_OUTPUTS + TEST_ADC_SETTLE)
+    {
+        code = lround(TEST_ADC_LEVEL + TEST_ADC_NOISE * test_adc_noise());
+        code = code < 0 ? 0 : code > 0xFFF ? 0xFFF : code;
+        if(!test_adc_convert((uint16_t)code))
+        {
+            continue;
+        }
+        if(count++ < TEST_ADC_SETTLE)
+        {
+            continue;
+        }
+        adc_get_samples(&samples);
+        value = samples.raw[TEST_ADC_ID] / 16.0;
+        sum += value;
+        sum2 += value * value;
+    }
+
+    stats.mean = sum / TEST_ADC_OUTPUTS;
+    stats.std = sqrt(sum2 / TEST_ADC_OUTPUTS - stats.mean * stats.mean);
+
+    return stats;
+}
@@ -0,0 +1,344 @@
+/**
+ **********************************************************************************************************************
+ * @file        test_buttons.c
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        2017-05-20
+ * @brief       Button events replay test. Input traces (pressed buttons over virtual time, with contact bounce) are
+ *              replayed through buttons thread: its waits advance virtual time to next trace edge or timeout, pins are
+ *              read from the trace. Dispatched events are compared with expected event list of each trace.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <setjmp.h>
+
+#include "host.h"
+
+#include "app.h"
+#include "buttons.h"
+#include "periph/gpio.h"
+#include "display/display.h"
+
+#include "cmsis_os2.h"
+
+/**********************************************************************************************************************
+ * Private definitions and macros
+ *********************************************************************************************************************/
+#define TEST_BUTTONS_STEPS_MAX  16      //!< Maximal steps of trace.
+#define TEST_BUTTONS_EVENTS_MAX 16      //!< Maximal events of trace.
+#define TEST_BUTTONS_GAP        1000    //!< Idle time between traces, longer than any timed event.
+
+#define J   BUTTONS_MASK(BUTTONS_ID_JOYSTICK_1_SW)  //!< Joystick switch bit of trace mask.
+#define R   BUTTONS_MASK(BUTTONS_ID_VIEW_RIGHT)     //!< View right bit of trace mask.
+#define L   BUTTONS_MASK(BUTTONS_ID_VIEW_LEFT)      //!< View left bit of trace mask.
+
+/**********************************************************************************************************************
+ * Private types
+ *********************************************************************************************************************/
+/**
+ * @brief   Trace step: from tick on buttons of mask are pressed.
+ */
+typedef struct
+{
+    uint32_t tick;  //!< Milliseconds from trace start.
+    uint8_t mask;   //!< Pressed buttons, see @ref BUTTONS_MASK.
+} test_buttons_step_t;
+
+/**
+ * @brief   Input trace and events it must produce.
+ */
+typedef struct
+{
+    const char *name;                                       //!< Trace name.
+    uint32_t end;                                           //!< Trace length in milliseconds.
+    test_buttons_step_t steps[TEST_BUTTONS_STEPS_MAX];      //!< Steps, zero tick ends the list.
+    buttons_event_t events[TEST_BUTTONS_EVENTS_MAX];        //!< Expected events, ticks from trace start, zero tick ends the list.
+} test_buttons_trace_t;
+
+/**********************************************************************************************************************
+ * Prototypes of local functions
+ *********************************************************************************************************************/
+/**
+ * @brief   Dispatch queued events to recording subscriber.
+ */
+static void test_buttons_dispatch(void);
+
+/**
+ * @brief   Advance virtual time. Ends replay after trace end.
+ *
+ * @param   until   Tick to advance to.
+ * @param   edge    Stop at first trace step before until.
+ *
+ * @return  true if stopped at trace step.
+ */
+static bool test_buttons_advance(uint32_t until, bool edge);
+
+/**
+ * @brief   Record dispatched event.
+ *
+ * @param   event   Button event.
+ */
+static void test_buttons_record(const buttons_event_t *event);
+
+/**
+ * @brief   Replay trace and compare events.
+ *
+ * @param   trace   Trace.
+ */
+static void test_buttons_replay(const test_buttons_trace_t *trace);
+
+/**********************************************************************************************************************
+ * Private constants
+ *********************************************************************************************************************/
+/** Traces. Bounce is a few millisecond pulses around each press and release. */
+static const test_buttons_trace_t test_buttons_traces[] =
+{
+    {"click", 1000,
+     {{100, J}, {101, 0}, {103, J}, {104, 0}, {105, J}, {250, 0}, {252, J}, {253, 0}},
+     {{165, BUTTONS_ID_JOYSTICK_1_SW, BUTTONS_EVENT_PRESS,   J, 0},
+      {265, BUTTONS_ID_JOYSTICK_1_SW, BUTTONS_EVENT_RELEASE, 0, 0},
+      {265, BUTTONS_ID_JOYSTICK_1_SW, BUTTONS_EVENT_CLICK,   0, 0}}},
+    {"double click", 1000,
+     {{100, R}, {102, 0}, {103, R}, {200, 0}, {350, R}, {351, 0}, {352, R}, {450, 0}},
+     {{165, BUTTONS_ID_VIEW_RIGHT, BUTTONS_EVENT_PRESS,   R, 0},
+      {215, BUTTONS_ID_VIEW_RIGHT, BUTTONS_EVENT_RELEASE, 0, 0},
+      {215, BUTTONS_ID_VIEW_RIGHT, BUTTONS_EVENT_CLICK,   0, 0},
+      {415, BUTTONS_ID_VIEW_RIGHT, BUTTONS_EVENT_PRESS,   R, 0},
+      {465, BUTTONS_ID_VIEW_RIGHT, BUTTONS_EVENT_RELEASE, 0, 0},
+      {465, BUTTONS_ID_VIEW_RIGHT, BUTTONS_EVENT_CLICK,   0, 0},
+      {465, BUTTONS_ID_VIEW_RIGHT, BUTTONS_EVENT_DOUBLE,  0, 0}}},
+    {"long and repeat", 2000,
+     {{100, L}, {101, 0}, {102, L}, {900, 0}},
+     {{165, BUTTONS_ID_VIEW_LEFT, BUTTONS_EVENT_PRESS,   L, 0},
+      {616, BUTTONS_ID_VIEW_LEFT, BUTTONS_EVENT_LONG,    L, 0},
+      {716, BUTTONS_ID_VIEW_LEFT, BUTTONS_EVENT_REPEAT,  L, 1},
+      {816, BUTTONS_ID_VIEW_LEFT, BUTTONS_EVENT_REPEAT,  L, 2},
+      {915, BUTTONS_ID_VIEW_LEFT, BUTTONS_EVENT_RELEASE, 0, 2}}},
+    {"chord", 2000,
+     {{100, R}, {300, R | L}, {1000, L}, {1100, 0}},
+     {{165, BUTTONS_ID_VIEW_RIGHT, BUTTONS_EVENT_PRESS,   R,     0},
+      {365, BUTTONS_ID_VIEW_LEFT,  BUTTONS_EVENT_PRESS,   R | L, 0},
+      {365, BUTTONS_ID_VIEW_LEFT,  BUTTONS_EVENT_CHORD,   R | L, 0},
+      {1015, BUTTONS_ID_VIEW_RIGHT, BUTTONS_EVENT_RELEASE, L,     0},
+      {1115, BUTTONS_ID_VIEW_LEFT, BUTTONS_EVENT_RELEASE, 0,     0}}},
+    {"bounce at sample", 1000,
+     {{100, J}, {104, 0}, {107, J}, {200, 0}},
+     {{172, BUTTONS_ID_JOYSTICK_1_SW, BUTTONS_EVENT_PRESS,   J, 0},
+      {215, BUTTONS_ID_JOYSTICK_1_SW, BUTTONS_EVENT_RELEASE, 0, 0},
+      {215, BUTTONS_ID_JOYSTICK_1_SW, BUTTONS_EVENT_CLICK,   0, 0}}},
+    {"glitch and short press", 1000,
+     {{100, J}, {102, 0}, {300, J}, {330, 0}},
+     {{0}}},
+};
+
+/**********************************************************************************************************************
+ * Private variables
+ *********************************************************************************************************************/
+/** Trace being replayed. */
+static const test_buttons_trace_t *test_buttons_trace = NULL;
+/** Virtual tick of trace start. */
+static uint32_t test_buttons_start = 0;
+/** Replay end jump. */
+static jmp_buf test_buttons_end;
+/** Recorded events. */
+static buttons_event_t test_buttons_events[TEST_BUTTONS_EVENTS_MAX];
+/** Number of recorded events. */
+static uint32_t test_buttons_count = 0;
+/** Display power state returned to buttons callbacks. */
+static bool test_buttons_display = false;
+
+/**********************************************************************************************************************
+ * Exported functions
+ *********************************************************************************************************************/
+bool gpio_get_pin(gpio_id_t id, uint8_t *port, uint8_t *pin)
+{
+    // Each button GPIO is own pin of port 0.
+    *port = 0;
+    *pin = (uint8_t)id;
+
+    return true;
+}
+
+bool gpio_irq_enable(gpio_id_t id, gpio_irq_cb_t cb)
+{
+    return true;
+}
+
+uint32_t gpio_port_get(uint8_t port)
+{
+    static const gpio_id_t gpios[] = {GPIO_ID_JOYSTICK_LEFT_SW, GPIO_ID_BUTTON_LEFT, GPIO_ID_BUTTON_RIGHT};
+    uint32_t value = UINT32_MAX;
+    uint8_t mask = 0;
+    uint8_t i = 0;
+
+    for(i = 0; i < TEST_BUTTONS_STEPS_MAX && test_buttons_trace->steps[i].tick != 0; i++)
+    {
+        if(test_buttons_start + test_buttons_trace->steps[i].tick <= host_tick)
+        {
+            mask = test_buttons_trace->steps[i].mask;
+        }
+    }
+    // Inputs are active low.
+    for(i = 0; i < BUTTONS_ID_LAST; i++)
+    {
+        if(mask & BUTTONS_MASK(i))
+        {
+            value &= ~(1UL << gpios[i]);
+        }
+    }
+
+    return value;
+}
+
+bool display_power_state(void)
+{
+    return test_buttons_display;
+}
+
+display_menu_id_t display_get_menu(void)
+{
+    return DISPLAY_MENU_ID_MAIN;
+}
+
+void display_set_menu(display_menu_id_t id)
+{
+    return;
+}
+
+app_rc_mode_t app_rc_mode_get(void)
+{
+    return APP_RC_MODE_STANDBY;
+}
+
+void app_rc_mode_set(app_rc_mode_t mode)
+{
+    return;
+}
+
+osStatus_t osDelay(uint32_t ticks)
+{
+    test_buttons_dispatch();
+    test_buttons_advance(host_tick + ticks, false);
+
+    return osOK;
+}
+
+uint32_t osThreadFlagsWait(uint32_t flags, uint32_t options, uint32_t timeout)
+{
+    test_buttons_dispatch();
+    if(test_buttons_advance(timeout == osWaitForever ? UINT32_MAX : host_tick + timeout, true))
+    {
+        return flags;
+    }
+
+    return (uint32_t)osFlagsErrorTimeout;
+}
+
+int main(void)
+{
+    uint32_t i = 0;
+
+    HOST_CHECK(buttons_init(), "init");
+    HOST_CHECK(buttons_subscribe(J | R | L, 0xFF, test_buttons_record), "subscribe");
+    HOST_CHECK(!buttons_subscribe(J, 0xFF, test_buttons_record), "subscribers table overflow");
+
+    for(i = 0; i < sizeof(test_buttons_traces) / sizeof(test_buttons_traces[0]); i++)
+    {
+        test_buttons_replay(&test_buttons_traces[i]);
+    }
+
+    return host_result("test_buttons");
+}
+
+/**********************************************************************************************************************
+ * Private functions
+ *********************************************************************************************************************/
+static void test_buttons_dispatch(void)
+{
+    while(buttons_dispatch(0));
+
+    return;
+}
+
+static bool test_buttons_advance(uint32_t until, bool edge)
+{
+    uint32_t step = 0;
+    uint8_t i = 0;
+
+    for(i = 0; edge && i < TEST_BUTTONS_STEPS_MAX && test_buttons_trace->steps[i].tick != 0; i++)
+    {
+        step = test_buttons_start + test_buttons_trace->steps[i].tick;
+        if(step > host_tick && step <= until)
+        {
+            host_tick = step;
+            return true;
+        }
+    }
+    if(until > test_buttons_start + test_buttons_trace->end)
+    {
+        longjmp(test_buttons_end, 1);
+    }
+    host_tick = until;
+
+    return false;
+}
+
+static void test_buttons_record(const buttons_event_t *event)
+{
+    if(test_buttons_count < TEST_BUTTONS_EVENTS_MAX)
+    {
+        test_buttons_events[test_buttons_count] = *event;
+        test_buttons_events[test_buttons_count].tick -= test_buttons_start;
+    }
+    test_buttons_count++;
+
+    return;
+}
+
+static void test_buttons_replay(const test_buttons_trace_t *trace)
+{
+    const buttons_event_t *expected = NULL;
+    const buttons_event_t *event = NULL;
+    uint32_t count = 0;
+    uint32_t i = 0;
+
+    test_buttons_trace = trace;
+    test_buttons_start = host_tick + TEST_BUTTONS_GAP;
+    test_buttons_count = 0;
+    if(setjmp(test_buttons_end) == 0)
+    {
+        buttons_thread(NULL);
+    }
+    test_buttons_dispatch();
+    host_tick = test_buttons_start + trace->end;
+
+    for(count = 0; count < TEST_BUTTONS_EVENTS_MAX && trace->events[count].tick != 0; count++);
+    HOST_CHECK(test_buttons_count == count, "%s: %u events, expected %u", trace->name, test_buttons_count, count);
+    for(i = 0; i < count && i < test_buttons_count; i++)
+    {
+        expected = &trace->events[i];
+        event = &test_buttons_events[i];
+        HOST_CHECK(event->tick == expected->tick && event->id == expected->id && event->type == expected->type &&
+                   event->mask == expected->mask && event->count == expected->count,
+                   "%s: event %u is %u ms id %u type %u mask 0x%x count %u, expected %u ms id %u type %u mask 0x%x "
+                   "count %u", trace->name, i, event->tick, event->id, event->type, event->mask, event->count,
+                   expected->tick, expected->id, expected->type, expected->mask, expected->count);
+    }
+
+    return;
+}
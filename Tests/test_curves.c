@@ -0,0 +1,178 @@
+/**
+ **********************************************************************************************************************
+ * @file        test_curves.c
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        2017-05-20
+ * @brief       Joystick response curve test. Curve tables are built for set of expo/rate/end point/dead zone settings,
+ *              axis is swept over calibrated travel and outputs are compared with golden text file and with floating
+ *              point model of the curve.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "host.h"
+
+// Curve tables and mapping are private to joystick module.
+#include "sensors/joystick.c"
+
+/**********************************************************************************************************************
+ * Private definitions and macros
+ *********************************************************************************************************************/
+#ifndef GOLDEN_DIR
+#define GOLDEN_DIR  "golden"
+#endif
+
+#define TEST_CURVES_STEP    512     //!< Sweep step in ADC counts.
+#define TEST_CURVES_ERR_MAX 2       //!< Allowed deviation from floating point model, table interpolation and rounding.
+#define TEST_CURVES_TRAVEL  24576   //!< Calibrated travel from center, ADC counts.
+
+/**********************************************************************************************************************
+ * Private types
+ *********************************************************************************************************************/
+/**
+ * @brief   Curve under test.
+ */
+typedef struct
+{
+    const char *name;           //!< Curve name.
+    joystick_curve_t curve;     //!< Curve settings.
+} test_curve_t;
+
+/**********************************************************************************************************************
+ * Prototypes of local functions
+ *********************************************************************************************************************/
+/**
+ * @brief   Floating point model of curve.
+ *
+ * @param   curve   Curve settings.
+ * @param   in      Position, -1.0 ... 1.0 of travel.
+ *
+ * @return  Output in units of @ref JOYSTICK_RESOLUTION.
+ */
+static double test_curves_model(const joystick_curve_t *curve, double in);
+
+/**********************************************************************************************************************
+ * Private constants
+ *********************************************************************************************************************/
+/** Curves of golden file. */
+static const test_curve_t test_curves[] =
+{
+    {"default",     JOYSTICK_CURVE_DEFAULT},
+    {"linear",      {.deadzone = 0,   .expo = 0,   .rate = 100, .endpoint_pos = 100, .endpoint_neg = 100}},
+    {"expo30",      {.deadzone = 3,   .expo = 30,  .rate = 100, .endpoint_pos = 100, .endpoint_neg = 100}},
+    {"expo100",     {.deadzone = 0,   .expo = 100, .rate = 100, .endpoint_pos = 100, .endpoint_neg = 100}},
+    {"rate70",      {.deadzone = 3,   .expo = 40,  .rate = 70,  .endpoint_pos = 100, .endpoint_neg = 100}},
+    {"endpoints",   {.deadzone = 3,   .expo = 0,   .rate = 100, .endpoint_pos = 80,  .endpoint_neg = 60}},
+    {"deadzone",    {.deadzone = 100, .expo = 50,  .rate = 90,  .endpoint_pos = 100, .endpoint_neg = 95}},
+};
+
+/**********************************************************************************************************************
+ * Exported functions
+ *********************************************************************************************************************/
+int main(void)
+{
+    const joystick_cal_t cal = {.zero = JOYSTICK_ADC_RES / 2, .min = JOYSTICK_ADC_RES / 2 - TEST_CURVES_TRAVEL,
+                                .max = JOYSTICK_ADC_RES / 2 + TEST_CURVES_TRAVEL};
+    const char *path = GOLDEN_DIR "/curves.txt";
+    bool update = getenv("UPDATE_GOLDEN") != NULL;
+    joystick_map_t map;
+    FILE *f = NULL;
+    char line[128];
+    char expected[128];
+    uint32_t mismatch = 0;
+    uint32_t lines = 0;
+    uint32_t i = 0;
+    int32_t value = 0;
+    int16_t out = 0;
+    double model = 0;
+    double err = 0;
+    double err_max = 0;
+
+    f = fopen(path, update ? "w" : "r");
+    HOST_CHECK(f != NULL, "%s: cannot open", path);
+    if(f == NULL)
+    {
+        return host_result("test_curves");
+    }
+
+    for(i = 0; i < sizeof(test_curves) / sizeof(test_curves[0]); i++)
+    {
+        memset(&map, 0, sizeof(map));
+        map.curve = test_curves[i].curve;
+        joystick_map_build(&map);
+        joystick_map_scale(&map, &cal);
+
+        // Sweep a bit beyond calibrated travel, outputs must saturate at end points.
+        for(value = cal.min - 2 * TEST_CURVES_STEP; value <= cal.max + 2 * TEST_CURVES_STEP; value += TEST_CURVES_STEP)
+        {
+            out = joystick_map_apply(&map, (uint32_t)value, cal.zero);
+            snprintf(line, sizeof(line), "%-10s %6d %5d\n", test_curves[i].name, value, out);
+            if(update)
+            {
+                fputs(line, f);
+            }
+            else if(fgets(expected, sizeof(expected), f) == NULL || strcmp(line, expected) != 0)
+            {
+                if(mismatch++ < 10)
+                {
+                    printf("%s:%u: expected %sgot      %s", path, lines + 1, expected, line);
+                }
+            }
+            lines++;
+
+            model = test_curves_model(&map.curve, ((double)value - cal.zero) / TEST_CURVES_TRAVEL);
+            err = fabs(model - out);
+            err_max = err > err_max ? err : err_max;
+            HOST_CHECK(err <= TEST_CURVES_ERR_MAX, "%s: input %d output %d, model %.2f", test_curves[i].name, value,
+                       out, model);
+        }
+    }
+    if(!update)
+    {
+        HOST_CHECK(fgets(expected, sizeof(expected), f) == NULL, "%s: more lines than curve points", path);
+    }
+    fclose(f);
+    HOST_CHECK(mismatch == 0, "%s: %u of %u points differ", path, mismatch, lines);
+
+    printf("Curves, %u points, max deviation from model %.2f.\n", lines, err_max);
+
+    return host_result("test_curves");
+}
+
+/**********************************************************************************************************************
+ * Private functions
+ *********************************************************************************************************************/
+static double test_curves_model(const joystick_curve_t *curve, double in)
+{
+    double deadzone = (double)curve->deadzone / JOYSTICK_RESOLUTION;
+    double endpoint = in < 0 ? curve->endpoint_neg / 100.0 : curve->endpoint_pos / 100.0;
+    double expo = curve->expo / 100.0;
+    double v = fabs(in) > 1.0 ? 1.0 : fabs(in);
+
+    if(v <= deadzone)
+    {
+        return 0;
+    }
+    v = (v - deadzone) / (1.0 - deadzone);
+    v = (v * (1 - expo) + v * v * v * expo) * curve->rate / 100.0 * endpoint * JOYSTICK_RESOLUTION;
+
+    return in < 0 ? -v : v;
+}
@@ -0,0 +1,255 @@
+/**
+ **********************************************************************************************************************
+ * @file        test_debounce.c
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        2017-05-20
+ * @brief       Debounce test on bounce traces. Traces in logic analyzer CSV export layout (traces/, synthetic, see
+ *              their header) are sampled at buttons sampling period, all channels through one debounce state. Each
+ *              channel must change debounced state exactly once per settled contact transition, within
+ *              @ref DEBOUNCE_SAMPLES sampling periods after bounce ends, and never for glitches.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "host.h"
+
+#include "debounce.h"
+
+/**********************************************************************************************************************
+ * Private definitions and macros
+ *********************************************************************************************************************/
+#ifndef TRACES_DIR
+#define TRACES_DIR  "traces"
+#endif
+
+#define TEST_DEBOUNCE_PERIOD    0.005   //!< Sampling period in seconds, same as buttons thread.
+#define TEST_DEBOUNCE_CHANNELS  3       //!< Channels of trace.
+#define TEST_DEBOUNCE_ROWS      256     //!< Maximal level changes of trace.
+#define TEST_DEBOUNCE_SETTLES   16      //!< Maximal settled transitions of trace.
+
+/**********************************************************************************************************************
+ * Private types
+ *********************************************************************************************************************/
+/**
+ * @brief   Trace row: levels of all channels from time on.
+ */
+typedef struct
+{
+    double time;    //!< Time in seconds.
+    uint32_t low;   //!< Channels at low level (active inputs), bit per channel.
+} test_debounce_row_t;
+
+/**
+ * @brief   End of bounce, debounced input must follow.
+ */
+typedef struct
+{
+    double time;        //!< Time in seconds.
+    uint8_t channel;    //!< Channel.
+    uint8_t level;      //!< Settled level.
+    uint8_t changes;    //!< Debounced changes matched to this transition.
+} test_debounce_settle_t;
+
+/**
+ * @brief   Loaded trace.
+ */
+typedef struct
+{
+    test_debounce_row_t rows[TEST_DEBOUNCE_ROWS];           //!< Level changes.
+    test_debounce_settle_t settles[TEST_DEBOUNCE_SETTLES];  //!< Settled transitions.
+    uint32_t row_count;                                     //!< Number of rows.
+    uint32_t settle_count;                                  //!< Number of settled transitions.
+} test_debounce_trace_t;
+
+/**********************************************************************************************************************
+ * Prototypes of local functions
+ *********************************************************************************************************************/
+/**
+ * @brief   Load trace file.
+ *
+ * @param   path    File path.
+ * @param   trace   Loaded trace.
+ *
+ * @return  false if file cannot be read or is malformed.
+ */
+static bool test_debounce_load(const char *path, test_debounce_trace_t *trace);
+
+/**
+ * @brief   Sample trace, debounce and check changes against settled transitions.
+ *
+ * @param   name    Trace name.
+ */
+static void test_debounce_run(const char *name);
+
+/**********************************************************************************************************************
+ * Private variables
+ *********************************************************************************************************************/
+/** Trace under test. */
+static test_debounce_trace_t test_debounce_trace;
+
+/**********************************************************************************************************************
+ * Exported functions
+ *********************************************************************************************************************/
+int main(void)
+{
+    debounce_t debounce;
+
+    test_debounce_run("bounce_short.csv");
+    test_debounce_run("bounce_long.csv");
+    test_debounce_run("glitch.csv");
+
+    // Counter restarts on any sample equal to debounced state.
+    debounce_init(&debounce, 0);
+    debounce_update(&debounce, 1);
+    debounce_update(&debounce, 1);
+    debounce_update(&debounce, 1);
+    debounce_update(&debounce, 0);
+    HOST_CHECK(!debounce_busy(&debounce) && debounce.state == 0, "counter not restarted");
+    debounce_update(&debounce, 1);
+    debounce_update(&debounce, 1);
+    debounce_update(&debounce, 1);
+    HOST_CHECK(debounce_update(&debounce, 1) == 1 && debounce.state == 1 && !debounce_busy(&debounce),
+               "change after %u samples", DEBOUNCE_SAMPLES);
+
+    return host_result("test_debounce");
+}
+
+/**********************************************************************************************************************
+ * Private functions
+ *********************************************************************************************************************/
+static bool test_debounce_load(const char *path, test_debounce_trace_t *trace)
+{
+    test_debounce_settle_t *settle = NULL;
+    test_debounce_row_t *row = NULL;
+    FILE *f = fopen(path, "r");
+    char line[256];
+    unsigned levels[TEST_DEBOUNCE_CHANNELS];
+    unsigned channel = 0;
+    unsigned level = 0;
+    uint8_t i = 0;
+    bool ok = f != NULL;
+
+    memset(trace, 0, sizeof(*trace));
+    while(ok && fgets(line, sizeof(line), f) != NULL)
+    {
+        if(strncmp(line, "# settle", 8) == 0)
+        {
+            if(!(ok = trace->settle_count < TEST_DEBOUNCE_SETTLES))
+            {
+                break;
+            }
+            settle = &trace->settles[trace->settle_count++];
+            ok = sscanf(line, "# settle %u %lf %u", &channel, &settle->time, &level) == 3 &&
+                 channel < TEST_DEBOUNCE_CHANNELS && level <= 1;
+            settle->channel = (uint8_t)channel;
+            settle->level = (uint8_t)level;
+        }
+        else if(line[0] != '#' && strncmp(line, "Time", 4) != 0)
+        {
+            if(!(ok = trace->row_count < TEST_DEBOUNCE_ROWS))
+            {
+                break;
+            }
+            row = &trace->rows[trace->row_count++];
+            ok = sscanf(line, "%lf, %u, %u, %u", &row->time, &levels[0], &levels[1], &levels[2]) == 4;
+            for(i = 0; ok && i < TEST_DEBOUNCE_CHANNELS; i++)
+            {
+                row->low |= levels[i] == 0 ? 1UL << i : 0;
+            }
+        }
+    }
+    if(f != NULL)
+    {
+        fclose(f);
+    }
+
+    return ok && trace->row_count > 1;
+}
+
+static void test_debounce_run(const char *name)
+{
+    test_debounce_trace_t *trace = &test_debounce_trace;
+    test_debounce_settle_t *match = NULL;
+    char path[256];
+    debounce_t debounce;
+    double latency_max = 0;
+    double latency = 0;
+    double time = 0;
+    uint32_t changes = 0;
+    uint32_t sample = 0;
+    uint32_t row = 0;
+    uint32_t toggle = 0;
+    uint32_t n = 0;
+    uint32_t i = 0;
+    uint8_t ch = 0;
+
+    snprintf(path, sizeof(path), "%s/%s", TRACES_DIR, name);
+    if(!HOST_CHECK(test_debounce_load(path, trace), "%s: cannot load", path))
+    {
+        return;
+    }
+
+    // Released inputs, as at startup.
+    debounce_init(&debounce, 0);
+    for(n = 0; (time = n * TEST_DEBOUNCE_PERIOD) <= trace->rows[trace->row_count - 1].time; n++)
+    {
+        while(row + 1 < trace->row_count && trace->rows[row + 1].time <= time)
+        {
+            row++;
+        }
+        sample = trace->rows[row].low;
+        toggle = debounce_update(&debounce, sample);
+
+        for(ch = 0; toggle != 0 && ch < TEST_DEBOUNCE_CHANNELS; ch++)
+        {
+            if((toggle & (1UL << ch)) == 0)
+            {
+                continue;
+            }
+            changes++;
+            // Change belongs to first transition of channel that is not matched yet.
+            match = NULL;
+            for(i = 0; i < trace->settle_count && match == NULL; i++)
+            {
+                if(trace->settles[i].channel == ch && trace->settles[i].changes == 0)
+                {
+                    match = &trace->settles[i];
+                }
+            }
+            if(!HOST_CHECK(match != NULL, "%s: channel %u changed at %.3f s without transition", name, ch, time))
+            {
+                continue;
+            }
+            match->changes++;
+            latency = time - match->time;
+            latency_max = latency > latency_max ? latency : latency_max;
+            HOST_CHECK(((debounce.state >> ch) & 1) == (match->level == 0) &&
+                       latency <= DEBOUNCE_SAMPLES * TEST_DEBOUNCE_PERIOD,
+                       "%s: channel %u changed at %.3f s, transition to %u settled at %.6f s", name, ch, time,
+                       match->level, match->time);
+        }
+    }
+
+    HOST_CHECK(changes == trace->settle_count, "%s: %u changes, %u transitions", name, changes, trace->settle_count);
+    printf("Debounce %s, %u samples, %u changes, max latency after bounce %.1f ms.\n", name, n, changes,
+           latency_max * 1000);
+
+    return;
+}
@@ -0,0 +1,208 @@
+/**
+ **********************************************************************************************************************
+ * @file        test_debug.c
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        2017-05-20
+ * @brief       Debug log ring test. Burst of display dump sized rows (128 characters) is logged, waiting path must
+ *              deliver every row intact while debug thread drains ring to UART, dropping path must count lost rows.
+ *              CLI replies must be printed with logs turned off.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <setjmp.h>
+
+#include "host.h"
+#include "cmsis_os2.h"
+
+#include "debug.h"
+
+/**********************************************************************************************************************
+ * Private definitions and macros
+ *********************************************************************************************************************/
+#define TEST_DEBUG_ROWS     64      //!< Rows of display dump.
+#define TEST_DEBUG_WIDTH    128     //!< Characters per row.
+#define TEST_DEBUG_UART     16384   //!< Captured UART output size in bytes.
+
+/**********************************************************************************************************************
+ * Prototypes of local functions
+ *********************************************************************************************************************/
+/**
+ * @brief   Run debug thread until ring is empty, as if it was scheduled while logging thread waits.
+ */
+static void test_debug_drain(void);
+
+/**
+ * @brief   Log rows and check UART output.
+ *
+ * @param   wait    Use waiting path.
+ *
+ * @return  Rows received intact.
+ */
+static uint32_t test_debug_burst(bool wait);
+
+/**********************************************************************************************************************
+ * Private variables
+ *********************************************************************************************************************/
+/** Captured UART output. */
+static char test_debug_uart[TEST_DEBUG_UART];
+/** Bytes in @ref test_debug_uart. */
+static uint32_t test_debug_uart_size = 0;
+/** Debug thread flag waits during drain. */
+static uint32_t test_debug_waits = 0;
+/** Leaves debug thread loop. */
+static jmp_buf test_debug_idle;
+/** Logging thread delays while ring is full. */
+static uint32_t test_debug_delays = 0;
+/** Debug thread is running. */
+static bool test_debug_running = false;
+
+/**********************************************************************************************************************
+ * Exported functions
+ *********************************************************************************************************************/
+uint32_t uart_0_send_rb(uint8_t *data, uint32_t size)
+{
+    if(size > TEST_DEBUG_UART - test_debug_uart_size)
+    {
+        size = TEST_DEBUG_UART - test_debug_uart_size;
+    }
+    memcpy(&test_debug_uart[test_debug_uart_size], data, size);
+    test_debug_uart_size += size;
+
+    return size;
+}
+
+void uart_0_send(uint8_t *data, uint32_t size)
+{
+    uart_0_send_rb(data, size);
+
+    return;
+}
+
+uint32_t osThreadFlagsWait(uint32_t flags, uint32_t options, uint32_t timeout)
+{
+    // First wait returns to drain ring, second one means ring is empty.
+    if(test_debug_waits++ > 0)
+    {
+        longjmp(test_debug_idle, 1);
+    }
+
+    return flags;
+}
+
+osStatus_t osDelay(uint32_t ticks)
+{
+    // UART capture is never full, debug thread itself must not wait.
+    if(!HOST_CHECK(!test_debug_running, "debug thread waits for UART"))
+    {
+        longjmp(test_debug_idle, 1);
+    }
+    test_debug_delays++;
+    test_debug_drain();
+
+    return osOK;
+}
+
+int main(void)
+{
+    uint32_t rows = 0;
+
+    rows = test_debug_burst(true);
+    HOST_CHECK(rows == TEST_DEBUG_ROWS, "waiting path: %u of %u rows intact", rows, TEST_DEBUG_ROWS);
+    HOST_CHECK(debug_get_dropped() == 0, "waiting path: %u records dropped", debug_get_dropped());
+    HOST_CHECK(test_debug_delays > 0, "burst did not fill ring");
+    printf("Waiting path, %u rows intact, %u waits for ring space.\n", rows, test_debug_delays);
+
+    rows = test_debug_burst(false);
+    HOST_CHECK(rows > 0 && rows < TEST_DEBUG_ROWS, "dropping path: %u rows", rows);
+    HOST_CHECK(rows + debug_get_dropped() == TEST_DEBUG_ROWS, "dropping path: %u rows, %u dropped", rows,
+               debug_get_dropped());
+    printf("Dropping path, %u rows intact, %u dropped.\n", rows, debug_get_dropped());
+
+    // CLI replies ignore log levels, e.g. after "log all off".
+    test_debug_uart_size = 0;
+    debug_set_level(DEBUG_MODULE_APP, DEBUG_LEVEL_OFF);
+    DEBUG("Muted.");
+    DEBUG_CLI("Reply %d.", 1);
+    test_debug_drain();
+    HOST_CHECK(test_debug_uart_size == 9 && memcmp(test_debug_uart, "Reply 1.\r", 9) == 0, "CLI reply with log off");
+
+    return host_result("test_debug");
+}
+
+/**********************************************************************************************************************
+ * Private functions
+ *********************************************************************************************************************/
+static void test_debug_drain(void)
+{
+    test_debug_waits = 0;
+    test_debug_running = true;
+    if(setjmp(test_debug_idle) == 0)
+    {
+        debug_thread(NULL);
+    }
+    test_debug_running = false;
+
+    return;
+}
+
+static uint32_t test_debug_burst(bool wait)
+{
+    char line[TEST_DEBUG_WIDTH + 1];
+    char *p = test_debug_uart;
+    uint32_t rows = 0;
+    uint32_t y = 0;
+    uint32_t x = 0;
+
+    test_debug_uart_size = 0;
+    test_debug_delays = 0;
+    for(y = 0; y < TEST_DEBUG_ROWS; y++)
+    {
+        for(x = 0; x < TEST_DEBUG_WIDTH; x++)
+        {
+            line[x] = ((x ^ y) & 1) ? '1' : '0';
+        }
+        // Last column identifies row.
+        line[TEST_DEBUG_WIDTH - 1] = (char)('A' + y % 26);
+        line[TEST_DEBUG_WIDTH] = '\0';
+        if(wait)
+        {
+            DEBUG_LOG_WAIT(APP, INFO, "%s", line);
+        }
+        else
+        {
+            DEBUG_LOG(APP, INFO, "%s", line);
+        }
+    }
+    test_debug_drain();
+    test_debug_uart[test_debug_uart_size < TEST_DEBUG_UART ? test_debug_uart_size : TEST_DEBUG_UART - 1] = '\0';
+
+    // Every received row must be whole and terminated.
+    while(*p != '\0')
+    {
+        x = strcspn(p, "\r\n");
+        HOST_CHECK(x == TEST_DEBUG_WIDTH && strspn(p, "01") == TEST_DEBUG_WIDTH - 1,
+                   "row %u: %u characters", rows, x);
+        rows++;
+        p += x;
+        p += strspn(p, "\r\n");
+    }
+
+    return rows;
+}
@@ -0,0 +1,206 @@
+/**
+ **********************************************************************************************************************
+ * @file        test_display.c
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        2017-05-20
+ * @brief       Display golden image test. Menus and pop-up are drawn by the firmware display code, sent through
+ *              fake SSP to SSD1306 emulator and emulator RAM is compared with golden PBM images.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host.h"
+#include "fake_ssd1306.h"
+
+#include "app.h"
+#include "bsp.h"
+#include "display/display.h"
+#include "display/display_menu.h"
+#include "display/display_popup.h"
+#include "display/ssd1306.h"
+#include "radio/radio.h"
+#include "sensors/sensors.h"
+
+/**********************************************************************************************************************
+ * Private definitions and macros
+ *********************************************************************************************************************/
+#ifndef GOLDEN_DIR
+#define GOLDEN_DIR  "golden"
+#endif
+#ifndef OUT_DIR
+#define OUT_DIR     "build"
+#endif
+
+/**********************************************************************************************************************
+ * Private variables
+ *********************************************************************************************************************/
+/** Sensors data shown by main menu. */
+static sensors_data_t test_sensors = {.joystick_1 = {.magnitude = 512, .direction = 90}};
+/** Radio data shown by main and radio menus. */
+static radio_data_t test_radio = {.tx_counter = 1234, .tx_lost_counter = 5, .rx_counter = 1229, .rtr_current = 2,
+                                  .rtr = 1, .quality = 93};
+/** Golden images are written instead of compared. */
+static bool test_update = false;
+
+/**********************************************************************************************************************
+ * Exported variables
+ *********************************************************************************************************************/
+extern volatile display_menu_t display_menu_list[DISPLAY_MENU_ID_LAST];
+
+/**********************************************************************************************************************
+ * Prototypes of local functions
+ *********************************************************************************************************************/
+/**
+ * @brief   Compare emulated display with golden image, or update golden image.
+ *
+ * @param   name    Image name.
+ * @param   layer   Also compare with driver base layer RAM, false while overlay is shown.
+ */
+static void test_frame(const char *name, bool layer);
+
+/**
+ * @brief   Draw menu from scratch the same way display thread does.
+ *
+ * @param   id  Menu ID.
+ */
+static void test_menu(display_menu_id_t id);
+
+/**********************************************************************************************************************
+ * Exported functions
+ *********************************************************************************************************************/
+uint32_t sensors_get_data(sensors_data_t *data)
+{
+    *data = test_sensors;
+
+    return 1;
+}
+
+uint32_t radio_get_data(radio_data_t *data)
+{
+    *data = test_radio;
+
+    return 1;
+}
+
+app_rc_mode_t app_rc_mode_get(void)
+{
+    return APP_RC_MODE_IDLE;
+}
+
+uint32_t bsp_get_system_core_clock(void)
+{
+    return 48000000;
+}
+
+int main(void)
+{
+    display_popup_t popup = {.active = true, .text = (uint8_t *)"Calibrate", .timeout = 1000};
+
+    test_update = getenv("UPDATE_GOLDEN") != NULL;
+
+    fake_ssd1306_reset();
+    HOST_CHECK(ssd1306_init(), "ssd1306_init failed");
+    HOST_CHECK(fake_ssd1306.on, "display not turned on by init");
+    HOST_CHECK(fake_ssd1306.mode == (SSD1306_ADDR_MODE ? 0 : 2), "addressing mode %d", fake_ssd1306.mode);
+
+    display_menu_init(DISPLAY_MENU_ID_WELCOME, 0, display_menu_cb_welcome);
+    display_menu_init(DISPLAY_MENU_ID_MAIN, 1000, display_menu_cb_main);
+    display_menu_init(DISPLAY_MENU_ID_RADIO, 1000, display_menu_cb_radio);
+    display_menu_init(DISPLAY_MENU_ID_INFO, 1000, display_menu_cb_info);
+
+    test_menu(DISPLAY_MENU_ID_WELCOME);
+    test_frame("welcome", true);
+    test_menu(DISPLAY_MENU_ID_MAIN);
+    test_frame("main", true);
+
+    // Periodic refresh redraws values only, changed pixels must reach display.
+    test_sensors.joystick_1.magnitude = 1024;
+    test_sensors.joystick_1.direction = 359;
+    test_radio.quality = 7;
+    display_menu_list[DISPLAY_MENU_ID_MAIN].cb(DISPLAY_MENU_ID_MAIN);
+    test_frame("main_update", true);
+
+    test_menu(DISPLAY_MENU_ID_RADIO);
+    test_frame("radio", true);
+    test_menu(DISPLAY_MENU_ID_INFO);
+    test_frame("info", true);
+
+    // Pop-up is drawn to overlay over menu, hiding it restores menu without redraw.
+    test_menu(DISPLAY_MENU_ID_RADIO);
+    display_popup_view(&popup);
+    test_frame("popup", false);
+    display_popup_hide();
+    test_frame("radio", true);
+
+    HOST_CHECK(fake_ssd1306.errors == 0, "%u bad commands or transfers", fake_ssd1306.errors);
+
+    return host_result(SSD1306_ADDR_MODE ? "test_display (horizontal addressing)" : "test_display (page addressing)");
+}
+
+/**********************************************************************************************************************
+ * Private functions
+ *********************************************************************************************************************/
+static void test_frame(const char *name, bool layer)
+{
+    char path[256];
+    int32_t diff = 0;
+    uint32_t mismatch = 0;
+    uint16_t x = 0;
+    uint16_t y = 0;
+
+    snprintf(path, sizeof(path), GOLDEN_DIR "/%s.pbm", name);
+    if(test_update)
+    {
+        HOST_CHECK(fake_ssd1306_write_pbm(path), "%s: cannot write", path);
+        return;
+    }
+
+    diff = fake_ssd1306_compare_pbm(path);
+    HOST_CHECK(diff == 0, "%s: %d pixels differ", path, diff);
+    if(diff != 0)
+    {
+        snprintf(path, sizeof(path), OUT_DIR "/%s%s.pbm", name, SSD1306_ADDR_MODE ? "_h" : "_p");
+        fake_ssd1306_write_pbm(path);
+        printf("Actual frame written to %s.\n", path);
+    }
+
+    // Everything drawn must also be sent: emulated RAM equals driver RAM.
+    for(y = 0; layer && y < SSD1306_HEIGHT; y++)
+    {
+        for(x = 0; x < SSD1306_WIDTH; x++)
+        {
+            mismatch += fake_ssd1306_pixel(x, y) != (ssd1306_get_pixel(x, y) == SSD1306_COLOR_WHITE);
+        }
+    }
+    HOST_CHECK(mismatch == 0, "%s: %u pixels not flushed to display", name, mismatch);
+
+    return;
+}
+
+static void test_menu(display_menu_id_t id)
+{
+    ssd1306_fill(SSD1306_COLOR_BLACK);
+    display_menu_list[id].init = false;
+    display_menu_list[id].cb(id);
+    display_menu_list[id].init = true;
+
+    return;
+}
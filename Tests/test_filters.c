@@ -0,0 +1,285 @@
+/**
+ **********************************************************************************************************************
+ * @file        test_filters.c
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        2017-05-20
+ * @brief       Fixed point filters test. Q16.16 filters are compared with double precision reference filters (the
+ *              implementation firmware used before fixed point) on the same pseudo random 12 bit input. Accuracy
+ *              only, speed is measured on target, see FILTERS_BENCH.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "host.h"
+
+#include "sensors/filters.h"
+
+/**********************************************************************************************************************
+ * Private definitions and macros
+ *********************************************************************************************************************/
+#define TEST_FILTERS_SAMPLES    100000  //!< Samples processed by each filter.
+#define TEST_FILTERS_ERR_MAX    0.5     //!< Allowed deviation from reference, half of 12 bit input LSB.
+
+/**********************************************************************************************************************
+ * Private types
+ *********************************************************************************************************************/
+/**
+ * @brief   Double precision reference Kalman filter data.
+ */
+typedef struct
+{
+    double process_noise_cov;       //!< Process noise covariance.
+    double measurement_noise_cov;   //!< Measurement noise covariance.
+    double value;                   //!< Current input value.
+    double estimation_error;        //!< Estimation error covariance.
+    double gain;                    //!< Kalman gain.
+} test_kalman_t;
+
+/**
+ * @brief   Double precision reference low and high pass filter data.
+ */
+typedef struct
+{
+    double input;   //!< Input value.
+    double output;  //!< Output value.
+    double cut_off; //!< Filter cut off.
+} test_pass_t;
+
+/**
+ * @brief   Double precision reference biquad filter data (direct form I).
+ */
+typedef struct
+{
+    double b0;  //!< Feed forward coefficient 0.
+    double b1;  //!< Feed forward coefficient 1.
+    double b2;  //!< Feed forward coefficient 2.
+    double a1;  //!< Feedback coefficient 1.
+    double a2;  //!< Feedback coefficient 2.
+    double x1;  //!< Input delayed by one sample.
+    double x2;  //!< Input delayed by two samples.
+    double y1;  //!< Output delayed by one sample.
+    double y2;  //!< Output delayed by two samples.
+} test_biquad_t;
+
+/**
+ * @brief   State of both implementations of all filters.
+ */
+typedef struct
+{
+    test_pass_t lp;                     //!< Reference low pass.
+    test_pass_t hp;                     //!< Reference high pass.
+    test_kalman_t kalman;               //!< Reference Kalman.
+    test_biquad_t biquad;               //!< Reference biquad.
+    filters_low_pass_q16_t lp_q16;      //!< Fixed point low pass.
+    filters_high_pass_q16_t hp_q16;     //!< Fixed point high pass.
+    filters_kalman_q16_t kalman_q16;    //!< Fixed point Kalman.
+    filters_biquad_q16_t biquad_q16;    //!< Fixed point biquad.
+} test_filters_t;
+
+/**********************************************************************************************************************
+ * Prototypes of local functions
+ *********************************************************************************************************************/
+static double test_kalman_update(test_kalman_t *data, double input);
+static double test_low_pass(test_pass_t *data, double input, double cut_off);
+static double test_high_pass(test_pass_t *data, double input, double cut_off);
+static double test_biquad(test_biquad_t *data, double input);
+
+/**
+ * @brief   Initialize both implementations with the same coefficients: 2nd order low pass biquad, fc = fs / 10.
+ *
+ * @param   f   Filters state.
+ */
+static void test_filters_init(test_filters_t *f);
+
+/**
+ * @brief   Run one filter type of one implementation over input sequence.
+ *
+ * @param   f       Filters state.
+ * @param   type    Filter type: 0 - low pass, 1 - high pass, 2 - Kalman, 3 - biquad.
+ * @param   q16     Run fixed point implementation.
+ * @param   out     Outputs, converted to double.
+ */
+static void test_filters_run(test_filters_t *f, uint8_t type, bool q16, double *out);
+
+/**
+ * @brief   Get next pseudo random 12 bit sample.
+ *
+ * @param   seed    Pointer to generator state.
+ *
+ * @return  Sample value 0 ... 4095.
+ */
+static int32_t test_filters_sample(uint32_t *seed);
+
+/**********************************************************************************************************************
+ * Private variables
+ *********************************************************************************************************************/
+/** Reference outputs. */
+static double test_out_ref[TEST_FILTERS_SAMPLES];
+/** Fixed point outputs. */
+static double test_out_q16[TEST_FILTERS_SAMPLES];
+
+/**********************************************************************************************************************
+ * Exported functions
+ *********************************************************************************************************************/
+int main(void)
+{
+    static const char *names[] = {"low pass", "high pass", "kalman", "biquad"};
+    test_filters_t f;
+    double err = 0;
+    double err_max = 0;
+    uint32_t i = 0;
+    uint8_t type = 0;
+
+    printf("%-10s %12s\n", "filter", "max error");
+    for(type = 0; type < 4; type++)
+    {
+        test_filters_init(&f);
+        test_filters_run(&f, type, false, test_out_ref);
+        test_filters_run(&f, type, true, test_out_q16);
+
+        err_max = 0;
+        for(i = 0; i < TEST_FILTERS_SAMPLES; i++)
+        {
+            err = fabs(test_out_ref[i] - test_out_q16[i]);
+            err_max = err > err_max ? err : err_max;
+        }
+        printf("%-10s %12.6f\n", names[type], err_max);
+        HOST_CHECK(err_max <= TEST_FILTERS_ERR_MAX, "%s: q16 deviates %f from reference", names[type], err_max);
+    }
+
+    // Saturation instead of wrap around.
+    f.lp_q16 = (filters_low_pass_q16_t){0};
+    for(i = 0; i < 100; i++)
+    {
+        filters_low_pass_q16(&f.lp_q16, INT32_MAX, FILTERS_Q16(0.5));
+    }
+    HOST_CHECK(f.lp_q16.output > FILTERS_Q16(32767.0), "low pass output %d wrapped", f.lp_q16.output);
+    HOST_CHECK(FILTERS_Q16(-0.5) == -32768 && FILTERS_Q16_TO_INT(FILTERS_Q16(-0.5)) == -1, "negative conversion");
+
+    return host_result("test_filters");
+}
+
+/**********************************************************************************************************************
+ * Private functions
+ *********************************************************************************************************************/
+static double test_kalman_update(test_kalman_t *data, double input)
+{
+    // Prediction update. Omit x = x.
+    data->estimation_error = data->estimation_error + data->process_noise_cov;
+
+    // Measurement update
+    data->gain = data->estimation_error / (data->estimation_error + data->measurement_noise_cov);
+    data->value = data->value + data->gain * (input - data->value);
+    data->estimation_error = (1 - data->gain) * data->estimation_error;
+
+    return data->value;
+}
+
+static double test_low_pass(test_pass_t *data, double input, double cut_off)
+{
+    data->input = input;
+    data->cut_off = cut_off;
+    data->output = data->output + (data->cut_off * (data->input - data->output));
+
+    return data->output;
+}
+
+static double test_high_pass(test_pass_t *data, double input, double cut_off)
+{
+    data->input = input;
+    data->cut_off = cut_off;
+    data->output = data->input - (data->output + data->cut_off * (data->input - data->output));
+
+    return data->output;
+}
+
+static double test_biquad(test_biquad_t *data, double input)
+{
+    double output = data->b0 * input + data->b1 * data->x1 + data->b2 * data->x2 -
+                    data->a1 * data->y1 - data->a2 * data->y2;
+
+    data->x2 = data->x1;
+    data->x1 = input;
+    data->y2 = data->y1;
+    data->y1 = output;
+
+    return output;
+}
+
+static void test_filters_init(test_filters_t *f)
+{
+    *f = (test_filters_t){0};
+
+    f->kalman = (test_kalman_t){.process_noise_cov = 0.01, .measurement_noise_cov = 1.0, .estimation_error = 1.0};
+    f->kalman_q16 = filters_kalman_q16_init(FILTERS_Q16(0.01), FILTERS_Q16(1.0), FILTERS_Q16(1.0), 0);
+    f->biquad_q16 = (filters_biquad_q16_t){.b0 = FILTERS_Q16(0.0675), .b1 = FILTERS_Q16(0.1349),
+                                           .b2 = FILTERS_Q16(0.0675), .a1 = FILTERS_Q16(-1.1430),
+                                           .a2 = FILTERS_Q16(0.4128)};
+    // Reference uses quantized coefficients, so only arithmetic is compared.
+    f->biquad = (test_biquad_t){.b0 = (double)f->biquad_q16.b0 / FILTERS_Q16_ONE,
+                                .b1 = (double)f->biquad_q16.b1 / FILTERS_Q16_ONE,
+                                .b2 = (double)f->biquad_q16.b2 / FILTERS_Q16_ONE,
+                                .a1 = (double)f->biquad_q16.a1 / FILTERS_Q16_ONE,
+                                .a2 = (double)f->biquad_q16.a2 / FILTERS_Q16_ONE};
+
+    return;
+}
+
+static void test_filters_run(test_filters_t *f, uint8_t type, bool q16, double *out)
+{
+    uint32_t seed = 1;
+    uint32_t i = 0;
+    int32_t input = 0;
+
+    for(i = 0; i < TEST_FILTERS_SAMPLES; i++)
+    {
+        input = test_filters_sample(&seed);
+        if(q16)
+        {
+            switch(type)
+            {
+                case 0:  out[i] = filters_low_pass_q16(&f->lp_q16, FILTERS_Q16_FROM_INT(input), FILTERS_Q16(0.5));   break;
+                case 1:  out[i] = filters_high_pass_q16(&f->hp_q16, FILTERS_Q16_FROM_INT(input), FILTERS_Q16(0.25)); break;
+                case 2:  out[i] = filters_kalman_q16_update(&f->kalman_q16, FILTERS_Q16_FROM_INT(input));            break;
+                default: out[i] = filters_biquad_q16(&f->biquad_q16, FILTERS_Q16_FROM_INT(input));                   break;
+            }
+            out[i] /= FILTERS_Q16_ONE;
+        }
+        else
+        {
+            switch(type)
+            {
+                case 0:  out[i] = test_low_pass(&f->lp, input, 0.5);     break;
+                case 1:  out[i] = test_high_pass(&f->hp, input, 0.25);   break;
+                case 2:  out[i] = test_kalman_update(&f->kalman, input); break;
+                default: out[i] = test_biquad(&f->biquad, input);        break;
+            }
+        }
+    }
+
+    return;
+}
+
+static int32_t test_filters_sample(uint32_t *seed)
+{
+    *seed = (*seed * 1103515245UL) + 12345UL;
+
+    return (int32_t)((*seed >> 16) & 0x0FFF);
+}
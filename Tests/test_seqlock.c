@@ -0,0 +1,227 @@
+/**
+ **********************************************************************************************************************
+ * @file        test_seqlock.c
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        2017-05-20
+ * @brief       Seqlock stress test. One writer thread publishes self checking records as fast as it can while reader
+ *              threads take snapshots, every snapshot must be whole record of the sequence number it was returned with
+ *              and sequence numbers seen by a reader must not go back. Unprotected copy is read the same way to show
+ *              that the load really interleaves writer and readers.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#include "host.h"
+
+#include "seqlock.h"
+
+/**********************************************************************************************************************
+ * Private definitions and macros
+ *********************************************************************************************************************/
+#ifndef TEST_SEQLOCK_PUBLISHES
+#define TEST_SEQLOCK_PUBLISHES  2000000 //!< Records published by writer.
+#endif
+#define TEST_SEQLOCK_READERS    3       //!< Reader threads.
+#define TEST_SEQLOCK_WORDS      16      //!< Record size in words, about size of sensors data.
+
+/**********************************************************************************************************************
+ * Private types
+ *********************************************************************************************************************/
+/**
+ * @brief   Published record. Each word is derived from publication number, so torn copy is detected.
+ */
+typedef struct
+{
+    uint32_t words[TEST_SEQLOCK_WORDS];     //!< Word 0 - publication number, others - hash of it and word index.
+} test_seqlock_record_t;
+
+/**
+ * @brief   Reader thread results.
+ */
+typedef struct
+{
+    bool raw;               //!< Read unprotected copy instead of snapshot.
+    uint32_t reads;         //!< Records read.
+    uint32_t torn;          //!< Records mixed from two publications.
+    uint32_t mismatch;      //!< Snapshots with sequence number different from record.
+    uint32_t backwards;     //!< Snapshots older than previous one.
+} test_seqlock_reader_t;
+
+/**********************************************************************************************************************
+ * Prototypes of local functions
+ *********************************************************************************************************************/
+/**
+ * @brief   Fill record of publication.
+ *
+ * @param   record  Record.
+ * @param   n       Publication number.
+ */
+static void test_seqlock_fill(test_seqlock_record_t *record, uint32_t n);
+
+/**
+ * @brief   Check that record is whole.
+ *
+ * @param   record  Record.
+ *
+ * @return  true if all words belong to the same publication.
+ */
+static bool test_seqlock_whole(const test_seqlock_record_t *record);
+
+static void *test_seqlock_writer(void *arg);
+static void *test_seqlock_reader(void *arg);
+
+/**********************************************************************************************************************
+ * Private variables
+ *********************************************************************************************************************/
+/** Object under test. */
+static SEQLOCK_OBJECT(test_seqlock_record_t) test_seqlock;
+/** Unprotected record written the same way, for comparison. */
+static test_seqlock_record_t test_seqlock_raw;
+/** Writer has finished. */
+static volatile bool test_seqlock_done = false;
+
+/**********************************************************************************************************************
+ * Exported functions
+ *********************************************************************************************************************/
+int main(void)
+{
+    test_seqlock_reader_t readers[TEST_SEQLOCK_READERS + 1] = {{0}};
+    pthread_t threads[TEST_SEQLOCK_READERS + 1];
+    pthread_t writer;
+    test_seqlock_record_t record;
+    uint64_t start = 0;
+    uint64_t ns = 0;
+    uint32_t i = 0;
+
+    HOST_CHECK(SEQLOCK_SNAPSHOT(test_seqlock, &record) == 0, "snapshot before first publish");
+
+    // Last reader reads unprotected copy.
+    readers[TEST_SEQLOCK_READERS].raw = true;
+    start = host_time_ns();
+    for(i = 0; i <= TEST_SEQLOCK_READERS; i++)
+    {
+        pthread_create(&threads[i], NULL, test_seqlock_reader, &readers[i]);
+    }
+    pthread_create(&writer, NULL, test_seqlock_writer, NULL);
+    pthread_join(writer, NULL);
+    for(i = 0; i <= TEST_SEQLOCK_READERS; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    ns = host_time_ns() - start;
+
+    for(i = 0; i < TEST_SEQLOCK_READERS; i++)
+    {
+        printf("Reader %u: %u snapshots, %u torn, %u sequence mismatch, %u backwards.\n", i, readers[i].reads,
+               readers[i].torn, readers[i].mismatch, readers[i].backwards);
+        HOST_CHECK(readers[i].reads > 0, "reader %u did not run", i);
+        HOST_CHECK(readers[i].torn == 0 && readers[i].mismatch == 0 && readers[i].backwards == 0,
+                   "reader %u got inconsistent snapshots", i);
+    }
+    // Informative only, how often unprotected copy is torn depends on host cores and scheduling.
+    printf("Unprotected reader: %u reads, %u torn.\n", readers[i].reads, readers[i].torn);
+    printf("Seqlock, %u publishes in %.1f ms.\n", TEST_SEQLOCK_PUBLISHES, ns / 1e6);
+
+    HOST_CHECK(SEQLOCK_SNAPSHOT(test_seqlock, &record) == TEST_SEQLOCK_PUBLISHES &&
+               record.words[0] == TEST_SEQLOCK_PUBLISHES, "last publish");
+
+    return host_result("test_seqlock");
+}
+
+/**********************************************************************************************************************
+ * Private functions
+ *********************************************************************************************************************/
+static void test_seqlock_fill(test_seqlock_record_t *record, uint32_t n)
+{
+    uint32_t i = 0;
+
+    record->words[0] = n;
+    for(i = 1; i < TEST_SEQLOCK_WORDS; i++)
+    {
+        record->words[i] = (uint32_t)(n * 2654435761UL) ^ i;
+    }
+
+    return;
+}
+
+static bool test_seqlock_whole(const test_seqlock_record_t *record)
+{
+    uint32_t i = 0;
+
+    for(i = 1; i < TEST_SEQLOCK_WORDS; i++)
+    {
+        if(record->words[i] != ((uint32_t)(record->words[0] * 2654435761UL) ^ i))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void *test_seqlock_writer(void *arg)
+{
+    test_seqlock_record_t record;
+    uint32_t n = 0;
+
+    for(n = 1; n <= TEST_SEQLOCK_PUBLISHES; n++)
+    {
+        test_seqlock_fill(&record, n);
+        SEQLOCK_PUBLISH(test_seqlock, &record);
+        memcpy(&test_seqlock_raw, &record, sizeof(record));
+    }
+    __sync_synchronize();
+    test_seqlock_done = true;
+
+    return NULL;
+}
+
+static void *test_seqlock_reader(void *arg)
+{
+    test_seqlock_reader_t *reader = arg;
+    test_seqlock_record_t record;
+    uint32_t last = 0;
+    uint32_t seq = 0;
+
+    while(!test_seqlock_done)
+    {
+        if(reader->raw)
+        {
+            memcpy(&record, (const void *)&test_seqlock_raw, sizeof(record));
+            __sync_synchronize();
+            reader->reads++;
+            reader->torn += !test_seqlock_whole(&record);
+            continue;
+        }
+
+        seq = SEQLOCK_SNAPSHOT(test_seqlock, &record);
+        if(seq == 0)
+        {
+            continue;
+        }
+        reader->reads++;
+        reader->torn += !test_seqlock_whole(&record);
+        reader->mismatch += record.words[0] != seq;
+        reader->backwards += seq < last;
+        last = seq;
+    }
+
+    return NULL;
+}
@@ -0,0 +1,139 @@
+/**
+ **********************************************************************************************************************
+ * @file        test_travel.c
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        2017-05-20
+ * @brief       Joystick travel learning test. Stick with reduced travel is swept from default calibration, it must
+ *              reach full scale output at its own ends. Short spikes beyond learned travel must not widen it.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "host.h"
+
+// Private travel tracking functions are tested directly.
+#include "sensors/joystick.c"
+
+/**********************************************************************************************************************
+ * Private definitions and macros
+ *********************************************************************************************************************/
+#define TEST_TRAVEL_CENTER  (JOYSTICK_ADC_RES / 2)  //!< Stick center, ADC counts.
+#define TEST_TRAVEL_RANGE   12000   //!< Reduced stick travel from center, ADC counts.
+#define TEST_TRAVEL_STEP    256     //!< Sweep step per sample, ADC counts.
+#define TEST_TRAVEL_HOLD    20      //!< Samples held at each end.
+#define TEST_TRAVEL_SWEEPS  3       //!< Sweeps over full travel.
+#define TEST_TRAVEL_SPIKE   60000   //!< Outlier sample, ADC counts.
+
+/**********************************************************************************************************************
+ * Prototypes of local functions
+ *********************************************************************************************************************/
+/**
+ * @brief   Move stick linearly and hold it at target.
+ *
+ * @param   track   Axis calibration tracker.
+ * @param   map     Axis map.
+ * @param   from    Start position, ADC counts.
+ * @param   to      Target position, ADC counts.
+ * @param   hold    Samples held at target.
+ */
+static void test_travel_move(joystick_track_t *track, joystick_map_t *map, uint32_t from, uint32_t to, uint32_t hold);
+
+/**********************************************************************************************************************
+ * Exported functions
+ *********************************************************************************************************************/
+int main(void)
+{
+    const joystick_cal_t cal = JOYSTICK_CAL_DEFAULT;
+    const uint32_t pos = TEST_TRAVEL_CENTER + TEST_TRAVEL_RANGE;
+    const uint32_t neg = TEST_TRAVEL_CENTER - TEST_TRAVEL_RANGE;
+    joystick_track_t track = {.cal = cal, .zero_acc = (uint32_t)cal.zero << JOYSTICK_DRIFT_SHIFT};
+    joystick_map_t map = {.curve = JOYSTICK_CURVE_DEFAULT};
+    joystick_cal_t learned;
+    uint32_t i = 0;
+    int16_t out_pos = 0;
+    int16_t out_neg = 0;
+
+    joystick_map_build(&map);
+    joystick_map_scale(&map, &track.cal);
+
+    test_travel_move(&track, &map, TEST_TRAVEL_CENTER, TEST_TRAVEL_CENTER, JOYSTICK_REST_COUNT);
+    for(i = 0; i < TEST_TRAVEL_SWEEPS; i++)
+    {
+        test_travel_move(&track, &map, TEST_TRAVEL_CENTER, pos, TEST_TRAVEL_HOLD);
+        test_travel_move(&track, &map, pos, neg, TEST_TRAVEL_HOLD);
+        test_travel_move(&track, &map, neg, TEST_TRAVEL_CENTER, JOYSTICK_REST_COUNT);
+    }
+    learned = track.cal;
+    out_pos = joystick_map_apply(&map, pos, track.cal.zero);
+    out_neg = joystick_map_apply(&map, neg, track.cal.zero);
+    HOST_CHECK(learned.min == neg && learned.max == pos, "learned %u ... %u, expected %u ... %u", learned.min,
+               learned.max, neg, pos);
+    HOST_CHECK(out_pos == JOYSTICK_RESOLUTION, "positive end output %d", out_pos);
+    HOST_CHECK(out_neg == -JOYSTICK_RESOLUTION, "negative end output %d", out_neg);
+
+    // Spikes shorter than grow count, on both sides.
+    for(i = 1; i < JOYSTICK_GROW_COUNT; i++)
+    {
+        test_travel_move(&track, &map, TEST_TRAVEL_SPIKE, TEST_TRAVEL_SPIKE, i - 1);
+        test_travel_move(&track, &map, TEST_TRAVEL_CENTER, TEST_TRAVEL_CENTER, JOYSTICK_REST_COUNT);
+        test_travel_move(&track, &map, JOYSTICK_ADC_RES - TEST_TRAVEL_SPIKE, JOYSTICK_ADC_RES - TEST_TRAVEL_SPIKE,
+                         i - 1);
+        test_travel_move(&track, &map, TEST_TRAVEL_CENTER, TEST_TRAVEL_CENTER, JOYSTICK_REST_COUNT);
+    }
+    HOST_CHECK(track.cal.min == learned.min && track.cal.max == learned.max, "spikes widened travel to %u ... %u",
+               track.cal.min, track.cal.max);
+    out_pos = joystick_map_apply(&map, pos, track.cal.zero);
+    HOST_CHECK(out_pos == JOYSTICK_RESOLUTION, "positive end output %d after spikes", out_pos);
+
+    // Spike held for grow count widens travel.
+    test_travel_move(&track, &map, TEST_TRAVEL_SPIKE, TEST_TRAVEL_SPIKE, JOYSTICK_GROW_COUNT - 1);
+    HOST_CHECK(track.cal.max == TEST_TRAVEL_SPIKE, "held value not learned, max %u", track.cal.max);
+
+    printf("Travel, %u ... %u learned from %u ... %u, end outputs %d and %d, spikes ignored.\n", learned.min,
+           learned.max, cal.min, cal.max, out_neg, out_pos);
+
+    return host_result("test_travel");
+}
+
+/**********************************************************************************************************************
+ * Private functions
+ *********************************************************************************************************************/
+static void test_travel_move(joystick_track_t *track, joystick_map_t *map, uint32_t from, uint32_t to, uint32_t hold)
+{
+    uint32_t value = from;
+
+    while(value != to)
+    {
+        joystick_track(track, map, value);
+        if(value < to)
+        {
+            value = to - value > TEST_TRAVEL_STEP ? value + TEST_TRAVEL_STEP : to;
+        }
+        else
+        {
+            value = value - to > TEST_TRAVEL_STEP ? value - TEST_TRAVEL_STEP : to;
+        }
+    }
+    do
+    {
+        joystick_track(track, map, value);
+    } while(hold--);
+
+    return;
+}
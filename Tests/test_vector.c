@@ -0,0 +1,123 @@
+/**
+ **********************************************************************************************************************
+ * @file        test_vector.c
+ * @author      Diamond Sparrow
+ * @version     1.0.0.0
+ * @date        2017-05-20
+ * @brief       Joystick vector test. Integer magnitude and direction are compared with double precision sqrt and
+ *              atan2 reference (the implementation firmware used before) over every point of the axis range.
+ *              Direction is rounded to nearest degree, same 1 degree resolution as before.
+ **********************************************************************************************************************
+ * @warning     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR \n
+ *              IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND\n
+ *              FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR\n
+ *              CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL\n
+ *              DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,\n
+ *              DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n
+ *              CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF\n
+ *              THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************
+ */
+
+/**********************************************************************************************************************
+ * Includes
+ *********************************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "host.h"
+
+#include "sensors/joystick.h"
+
+/**********************************************************************************************************************
+ * Private definitions and macros
+ *********************************************************************************************************************/
+#define TEST_VECTOR_PI          3.14159265358979    //!< Pi for double precision reference.
+#define TEST_VECTOR_DIR_ERR     0.501   //!< Allowed direction error, degrees: rounding to nearest degree and table
+                                        //!< interpolation.
+
+/**********************************************************************************************************************
+ * Prototypes of local functions
+ *********************************************************************************************************************/
+/**
+ * @brief   Double precision reference magnitude, limited to full scale.
+ */
+static double test_vector_magnitude(int32_t x, int32_t y);
+
+/**
+ * @brief   Double precision reference direction, degrees from +Y toward +X, 0 ... 360.
+ */
+static double test_vector_direction(int32_t x, int32_t y);
+
+/**********************************************************************************************************************
+ * Exported functions
+ *********************************************************************************************************************/
+int main(void)
+{
+    uint32_t count = 0;
+    uint32_t magn_err = 0;
+    uint32_t dir_err = 0;
+    double dir_diff_max = 0;
+    double diff = 0;
+    double ref = 0;
+    int32_t x = 0;
+    int32_t y = 0;
+    int32_t value = 0;
+
+    for(x = -JOYSTICK_RESOLUTION; x <= JOYSTICK_RESOLUTION; x++)
+    {
+        for(y = -JOYSTICK_RESOLUTION; y <= JOYSTICK_RESOLUTION; y++)
+        {
+            // Integer results are truncated like (int32_t) cast of reference, one unit below is rounding.
+            value = joystick_magnitude(x, y);
+            ref = test_vector_magnitude(x, y);
+            magn_err += value != (int32_t)ref && value != (int32_t)ref - 1;
+
+            if(x != 0 || y != 0)
+            {
+                value = joystick_direction(x, y);
+                ref = test_vector_direction(x, y);
+                diff = fabs(value - ref);
+                diff = diff > 180 ? 360 - diff : diff;
+                dir_diff_max = diff > dir_diff_max ? diff : dir_diff_max;
+                dir_err += diff > TEST_VECTOR_DIR_ERR || value < 0 || value >= 360;
+            }
+            count++;
+        }
+    }
+    HOST_CHECK(magn_err == 0, "magnitude differs from reference in %u of %u points", magn_err, count);
+    HOST_CHECK(dir_err == 0, "direction differs more than %.3f degrees in %u of %u points, max %f",
+               TEST_VECTOR_DIR_ERR, dir_err, count, dir_diff_max);
+    HOST_CHECK(joystick_direction(0, 0) == 0 && joystick_magnitude(0, 0) == 0, "zero vector");
+    HOST_CHECK(joystick_direction(0, 100) == 0 && joystick_direction(100, 0) == 90 &&
+               joystick_direction(0, -100) == 180 && joystick_direction(-100, 0) == 270, "axis directions");
+
+    // Speed is measured on target, see JOYSTICK_BENCH.
+    printf("Vector, %u points, max direction error %.3f degrees.\n", count, dir_diff_max);
+
+    return host_result("test_vector");
+}
+
+/**********************************************************************************************************************
+ * Private functions
+ *********************************************************************************************************************/
+static double test_vector_magnitude(int32_t x, int32_t y)
+{
+    double magn = sqrt((double)x * x + (double)y * y);
+
+    return magn > JOYSTICK_RESOLUTION ? JOYSTICK_RESOLUTION : magn;
+}
+
+static double test_vector_direction(int32_t x, int32_t y)
+{
+    double dir = atan2(x, y);
+
+    if(dir < 0)
+    {
+        dir += 2 * TEST_VECTOR_PI;
+    }
+
+    return dir * 180 / TEST_VECTOR_PI;
+}
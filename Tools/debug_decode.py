@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+"""
+DS-2 Remote Controller tokenized log decoder.
+
+Firmware built with DEBUG_TOKENIZED = 1 sends binary frames instead of text:
+
+    0xFE, length, format ID (2), tick (4), arguments (length - 6), checksum
+
+Multi-byte fields are little endian, checksum makes sum of bytes after sync zero. Format ID is address of 4 bytes
+aligned format string divided by 4, ID 0 is hex dump. Arguments are captured as 4 byte integers, 8 byte long long
+and double, and zero terminated strings padded to 4 bytes. Bytes outside of frames, e.g. boot output, are passed
+through as text. Format strings are loaded to flash too, firmware parses them to capture arguments.
+
+Usage:
+    debug_decode.py ds2_rc.axf [log.bin]    (reads stdin if log file is not given)
+"""
+
+import re
+import struct
+import sys
+
+FRAME_SYNC = 0xFE
+FRAME_HEX = 0
+
+SPEC = re.compile(r'%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?(hh|h|ll|l|j|z|t|L)?([diouxXcpfFeEgGaAs%])')
+
+
+class Image:
+    """Firmware ELF image, allocated sections are used to find format strings."""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        if self.data[:4] != b'\x7fELF' or self.data[4] != 1 or self.data[5] != 1:
+            raise ValueError('%s is not ELF32 little endian image' % path)
+        shoff, = struct.unpack_from('<I', self.data, 0x20)
+        shentsize, shnum = struct.unpack_from('<HH', self.data, 0x2E)
+        self.sections = []
+        for i in range(shnum):
+            _, sh_type, sh_flags, addr, offset, size = struct.unpack_from('<IIIIII', self.data, shoff + i * shentsize)
+            # Allocated sections with data.
+            if sh_type == 1 and sh_flags & 0x2:
+                self.sections.append((addr, offset, size))
+        self.cache = {}
+
+    def string(self, address):
+        if address in self.cache:
+            return self.cache[address]
+        for addr, offset, size in self.sections:
+            if addr <= address < addr + size:
+                start = offset + address - addr
+                end = self.data.index(b'\0', start)
+                text = self.data[start:end].decode('latin-1')
+                self.cache[address] = text
+                return text
+        return None
+
+
+def render(fmt, args):
+    """Print captured arguments with format, same argument layout as debug_capture()."""
+    out = []
+    pos = 0
+    last = 0
+
+    def take(size):
+        nonlocal pos
+        if pos + size > len(args):
+            raise IndexError
+        value = args[pos:pos + size]
+        pos += size
+        return value
+
+    try:
+        for m in SPEC.finditer(fmt):
+            out.append(fmt[last:m.start()])
+            last = m.end()
+            flags, width, prec, length, conv = m.groups()
+            if conv == '%':
+                out.append('%')
+                continue
+            if width == '*':
+                width = str(struct.unpack('<i', take(4))[0])
+            if prec == '*':
+                prec = str(struct.unpack('<i', take(4))[0])
+            spec = '%' + flags + (width or '') + ('.' + prec if prec is not None else '')
+            if conv == 's':
+                end = args.index(b'\0', pos) if b'\0' in args[pos:] else len(args)
+                value = args[pos:end].decode('latin-1')
+                pos = min(len(args), (end + 1 + 3) & ~3)
+                out.append((spec + 's') % value)
+            elif conv in 'fFeEgGaA':
+                value, = struct.unpack('<d', take(8))
+                out.append((spec + (conv if conv not in 'aA' else 'e')) % value)
+            elif length in ('ll', 'j'):
+                value, = struct.unpack('<q' if conv in 'di' else '<Q', take(8))
+                out.append((spec + ('d' if conv in 'diu' else conv)) % value)
+            else:
+                value, = struct.unpack('<i' if conv in 'di' else '<I', take(4))
+                if conv == 'p':
+                    out.append((spec + 'x') % value)
+                elif conv == 'c':
+                    out.append((spec + 'c') % (value & 0xFF))
+                else:
+                    out.append((spec + ('d' if conv in 'diu' else conv)) % value)
+        out.append(fmt[last:])
+    except IndexError:
+        pass
+
+    return ''.join(out)
+
+
+def decode(image, stream, write):
+    buf = bytearray()
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            break
+        buf += chunk
+        while buf:
+            if buf[0] != FRAME_SYNC:
+                # Text outside of frames.
+                end = buf.find(bytes([FRAME_SYNC]))
+                end = len(buf) if end < 0 else end
+                write(buf[:end].decode('latin-1').replace('\r', '\n'))
+                del buf[:end]
+                continue
+            if len(buf) < 2 or len(buf) < buf[1] + 3:
+                break
+            frame = buf[1:buf[1] + 3]
+            if sum(frame) & 0xFF != 0:
+                # Not a frame, resynchronize on next sync byte.
+                write('<%02X>' % buf[0])
+                del buf[:1]
+                continue
+            del buf[:len(frame) + 1]
+            fmt_id, tick = struct.unpack_from('<HI', frame, 1)
+            args = bytes(frame[7:-1])
+            if fmt_id == FRAME_HEX:
+                text = '[' + ','.join('%02X' % b for b in args) + ']\r\n'
+            else:
+                fmt = image.string(fmt_id << 2)
+                text = render(fmt, args) if fmt is not None else '<unknown format 0x%04X>\r' % fmt_id
+            write('%10.3f %s' % (tick / 1000.0, text.replace('\r\n', '\n').replace('\r', '\n')))
+
+
+def main(argv):
+    if len(argv) < 2:
+        sys.stderr.write(__doc__)
+        return 1
+    image = Image(argv[1])
+    stream = open(argv[2], 'rb') if len(argv) > 2 else sys.stdin.buffer
+    decode(image, stream, lambda text: (sys.stdout.write(text), sys.stdout.flush()))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
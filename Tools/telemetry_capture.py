@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+"""
+DS-2 Remote Controller telemetry capture.
+
+Firmware streams binary records after CLI command "telemetry <rate Hz>". Each record is COBS encoded and delimited
+by zero bytes on both sides:
+
+    type, sequence, tick (4), payload, CRC-16/CCITT (2, initial 0xFFFF)
+
+Multi-byte fields are little endian. Records are written to one CSV file per record type, log text between frames
+is printed to stdout. Gaps in sequence numbers are counted as lost records. Load record has total CPU load of all
+threads and interrupts, time not spent in idle thread, in 0.1 %.
+
+Usage:
+    telemetry_capture.py <serial port | capture file> [output directory] [--baud 460800] [--raw capture.bin]
+
+Serial port is opened with termios, no extra packages are needed. Stop capture with Ctrl+C.
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+RECORDS = {
+    1: ('sensors', '<iiBB4h', ['magnitude', 'direction', 'state', 'sw', 'ch0', 'ch1', 'ch2', 'ch3']),
+    2: ('radio', '<IIIBBB', ['tx', 'tx_lost', 'rx', 'rtr_current', 'rtr', 'quality']),
+    3: ('load', '<HII', ['cpu_load_total_permille', 'log_dropped', 'dropped']),
+    4: ('events', '<Hi', ['id', 'value']),
+}
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(data):
+    """Decode COBS block, None if block is malformed."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def open_serial(port, baud):
+    import termios
+    import tty
+
+    fd = os.open(port, os.O_RDONLY | os.O_NOCTTY)
+    tty.setraw(fd)
+    attrs = termios.tcgetattr(fd)
+    speed = getattr(termios, 'B%d' % baud)
+    attrs[4] = attrs[5] = speed
+    termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return os.fdopen(fd, 'rb', buffering=0)
+
+
+class Capture:
+    def __init__(self, out_dir):
+        self.out_dir = out_dir
+        self.files = {}
+        self.seq = None
+        self.records = 0
+        self.lost = 0
+        self.bad = 0
+
+    def record(self, data):
+        if len(data) < 8 or crc16(data[:-2]) != struct.unpack_from('<H', data, len(data) - 2)[0]:
+            return False
+        rtype, seq, tick = struct.unpack_from('<BBI', data)
+        if rtype not in RECORDS:
+            return False
+        name, fmt, columns = RECORDS[rtype]
+        payload = data[6:-2]
+        if len(payload) != struct.calcsize(fmt):
+            return False
+        if self.seq is not None:
+            self.lost += (seq - self.seq - 1) & 0xFF
+        self.seq = seq
+        self.records += 1
+        if name not in self.files:
+            self.files[name] = open(os.path.join(self.out_dir, name + '.csv'), 'w')
+            self.files[name].write(','.join(['tick_ms'] + columns) + '\n')
+        self.files[name].write(','.join(str(v) for v in (tick,) + struct.unpack(fmt, payload)) + '\n')
+        return True
+
+    def block(self, block):
+        if not block:
+            return
+        data = cobs_decode(block)
+        if data is not None and self.record(data):
+            return
+        # Not a record: log text or corrupted frame.
+        text = block.decode('latin-1')
+        if all(c.isprintable() or c in '\r\n\t' for c in text):
+            sys.stdout.write(text.replace('\r\n', '\n').replace('\r', '\n'))
+            sys.stdout.flush()
+        else:
+            self.bad += 1
+
+    def close(self):
+        for f in self.files.values():
+            f.close()
+        sys.stderr.write('%d records, %d lost, %d bad frames.\n' % (self.records, self.lost, self.bad))
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[1])
+    parser.add_argument('source', help='serial port or captured stream file')
+    parser.add_argument('out_dir', nargs='?', default='.', help='directory for CSV files')
+    parser.add_argument('--baud', type=int, default=460800, help='serial port baudrate')
+    parser.add_argument('--raw', help='also save raw stream to file')
+    args = parser.parse_args(argv[1:])
+
+    if os.path.exists(args.source) and not os.path.isfile(args.source):
+        stream = open_serial(args.source, args.baud)
+    else:
+        stream = open(args.source, 'rb')
+    raw = open(args.raw, 'wb') if args.raw else None
+    os.makedirs(args.out_dir, exist_ok=True)
+    capture = Capture(args.out_dir)
+    buf = bytearray()
+    try:
+        while True:
+            chunk = stream.read(4096)
+            if not chunk:
+                break
+            if raw:
+                raw.write(chunk)
+            buf += chunk
+            *blocks, buf = buf.split(b'\0')
+            for block in blocks:
+                capture.block(bytes(block))
+    except KeyboardInterrupt:
+        pass
+    capture.block(bytes(buf))
+    capture.close()
+    if raw:
+        raw.close()
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))